@@ -55,6 +55,21 @@ An opaque type representing a network address.
 */
 typedef ArchNetAddressImpl* ArchNetAddress;
 
+/*!      
+\class ArchPollSetImpl
+\brief Internal poll set data.
+An architecture dependent type holding the necessary data for a
+persistent set of polled sockets.
+*/
+class ArchPollSetImpl;
+
+/*!      
+\var ArchPollSet
+\brief Opaque poll set type.
+An opaque type representing a persistent set of polled sockets.
+*/
+typedef ArchPollSetImpl* ArchPollSet;
+
 //! Interface for architecture dependent networking
 /*!
 This interface defines the networking operations required by
@@ -104,6 +119,26 @@ public:
         unsigned short    m_revents;
     };
 
+    //! A result from \c waitPollSet()
+    class PollSetEntry {
+    public:
+        //! The data passed to \c updatePollSet() for the socket
+        void*            m_data;
+
+        //! The result events
+        unsigned short    m_revents;
+    };
+
+    //! A buffer for \c readSocketVector() and \c writeSocketVector()
+    class IOVector {
+    public:
+        //! The start of the buffer
+        void*            m_data;
+
+        //! The size of the buffer in bytes
+        size_t            m_size;
+    };
+
     //! @name manipulators
     //@{
 
@@ -148,8 +183,10 @@ public:
     //! Listen for connections on socket
     /*!
     Causes the socket \c s to begin listening for incoming connections.
+    At most \c backlog connections are left waiting to be accepted;
+    zero or less uses the largest backlog the system allows.
     */
-    virtual void        listenOnSocket(ArchSocket s) = 0;
+    virtual void        listenOnSocket(ArchSocket s, int backlog) = 0;
 
     //! Accept connection on socket
     /*!
@@ -158,8 +195,9 @@ public:
     end.  \c addr may be NULL if the remote address isn't required.
     The original socket \c s is unaffected and remains in the listening
     state.  The new socket shares most of the properties of \c s except
-    it's not in the listening state and it's connected.  Returns NULL
-    if there are no pending connection requests.
+    it's not in the listening state and it's connected.  The new socket
+    is non-blocking and isn't inherited by child processes.  Returns
+    NULL if there are no pending connection requests.
     */
     virtual ArchSocket    acceptSocket(ArchSocket s, ArchNetAddress* addr) = 0;
 
@@ -199,6 +237,50 @@ public:
     */
     virtual void        unblockPollSocket(ArchThread thread) = 0;
 
+    //! Create a poll set
+    /*!
+    Returns a persistent set of sockets to poll.  Unlike \c pollSocket(),
+    sockets are registered with the set once and only changes to the
+    events of interest are passed to the system.  Returns NULL if the
+    platform has no persistent polling facility, in which case callers
+    should use \c pollSocket() instead.
+    */
+    virtual ArchPollSet    newPollSet() = 0;
+
+    //! Destroy a poll set
+    virtual void        closePollSet(ArchPollSet set) = 0;
+
+    //! Set the events to poll a socket for
+    /*!
+    Registers socket \c s with \c set if it isn't already registered
+    and sets the events to query for to \c events, which can be any
+    combination of kPOLLIN and kPOLLOUT.  \c data is reported back by
+    \c waitPollSet() when the socket has events.  Errors are always
+    reported, even when \c events is 0.
+    */
+    virtual void        updatePollSet(ArchPollSet set, ArchSocket s,
+                            unsigned short events, void* data) = 0;
+
+    //! Remove a socket from a poll set
+    /*!
+    Stops polling socket \c s in \c set.  Does nothing if \c s is not
+    registered.
+    */
+    virtual void        removeFromPollSet(ArchPollSet set, ArchSocket s) = 0;
+
+    //! Wait on a poll set
+    /*!
+    Waits up to \c timeout seconds (or indefinitely if \c timeout < 0)
+    for sockets in \c set to have events, like \c pollSocket().  Fills
+    in at most \c num entries and returns the number filled in.  Only
+    sockets with events are reported.  A poll set must only be waited
+    on by one thread, which \c unblockPollSocket() can unblock.
+
+    (Cancellation point)
+    */
+    virtual int            waitPollSet(ArchPollSet set,
+                            PollSetEntry[], int num, double timeout) = 0;
+
     //! Read data from socket
     /*!
     Read up to \c len bytes from socket \c s in \c buf and return the
@@ -218,6 +300,22 @@ public:
     virtual size_t        writeSocket(ArchSocket s,
                             const void* buf, size_t len) = 0;
 
+    //! Read data from socket into several buffers
+    /*!
+    Like \c readSocket() but fills the \c num buffers in \c vectors in
+    order, using a single system call where the platform allows.
+    */
+    virtual size_t        readSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num) = 0;
+
+    //! Write data to socket from several buffers
+    /*!
+    Like \c writeSocket() but writes the \c num buffers in \c vectors
+    in order, using a single system call where the platform allows.
+    */
+    virtual size_t        writeSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num) = 0;
+
     //! Check error on socket
     /*!
     If the socket \c s is in an error state then throws an appropriate
@@ -232,6 +330,15 @@ public:
     */
     virtual bool        setNoDelayOnSocket(ArchSocket, bool noDelay) = 0;
 
+    //! Cork or uncork socket
+    /*!
+    While a socket is corked the system holds back partial packets so
+    data written in several pieces goes out in as few packets as
+    possible.  Uncorking sends whatever is held back.  Returns false if
+    the platform can't cork sockets, in which case this does nothing.
+    */
+    virtual bool        setCorkOnSocket(ArchSocket, bool cork) = 0;
+
     //! Turn address reuse on or off on socket
     /*!
     Allows the address this socket is bound to to be reused while in the
@@ -27,13 +27,19 @@
 #endif
 #include <netdb.h>
 #include <netinet/in.h>
-#if !defined(TCP_NODELAY)
+#if !defined(TCP_NODELAY) || !defined(TCP_CORK)
 #    include <netinet/tcp.h>
 #endif
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <cstring>
+#include <vector>
+#if HAVE_SYS_EPOLL_H
+#    include <sys/epoll.h>
+#endif
 
 #if !HAVE_INET_ATON
 #    include <stdio.h>
@@ -49,6 +55,23 @@ static const int s_type[] = {
     SOCK_STREAM
 };
 
+// number of poll entries we translate on the stack.  larger queries
+// fall back to the heap.
+static const int s_pollStackSize = 32;
+
+// maximum number of buffers passed to one readv() or writev().  any
+// extra buffers are left for the next call.
+#if defined(IOV_MAX) && IOV_MAX < 64
+static const int s_maxIOVectors = IOV_MAX;
+#else
+static const int s_maxIOVectors = 64;
+#endif
+
+#if HAVE_SYS_EPOLL_H
+// maximum number of events we collect from one epoll_wait()
+static const int s_pollSetMaxEvents = 64;
+#endif
+
 #if !HAVE_INET_ATON
 // parse dotted quad addresses.  we don't bother with the weird BSD'ism
 // of handling octal and hex and partial forms.
@@ -188,12 +211,15 @@ ArchNetworkBSD::bindSocket(ArchSocket s, ArchNetAddress addr)
 }
 
 void
-ArchNetworkBSD::listenOnSocket(ArchSocket s)
+ArchNetworkBSD::listenOnSocket(ArchSocket s, int backlog)
 {
     assert(s != NULL);
 
-    // hardcoding backlog
-    if (listen(s->m_fd, 3) == -1) {
+    // the system clamps the backlog to its own limit
+    if (backlog <= 0) {
+        backlog = SOMAXCONN;
+    }
+    if (listen(s->m_fd, backlog) == -1) {
         throwError(errno);
     }
 }
@@ -213,23 +239,34 @@ ArchNetworkBSD::acceptSocket(ArchSocket s, ArchNetAddress* addr)
     auto* newSocket = new ArchSocketImpl;
     *addr                      = new ArchNetAddressImpl;
 
-    // accept on socket
-    auto len = ((*addr)->m_len);
-    int fd = accept(s->m_fd, TYPED_ADDR(struct sockaddr, (*addr)), &len);
-    (*addr)->m_len = len;
+    // accept on socket.  skip connections that were reset before we
+    // got to them.
+    int fd;
+    do {
+        socklen_t len = sizeof((*addr)->m_addr);
+#if HAVE_ACCEPT4
+        fd = accept4(s->m_fd, TYPED_ADDR(struct sockaddr, (*addr)), &len,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        fd = accept(s->m_fd, TYPED_ADDR(struct sockaddr, (*addr)), &len);
+#endif
+        (*addr)->m_len = len;
+    } while (fd == -1 && (errno == EINTR || errno == ECONNABORTED));
     if (fd == -1) {
         int err = errno;
         delete newSocket;
         delete *addr;
         *addr = nullptr;
-        if (err == EAGAIN) {
+        if (err == EAGAIN || err == EWOULDBLOCK) {
             return nullptr;
         }
         throwError(err);
     }
 
+#if !HAVE_ACCEPT4
     try {
         setBlockingOnSocket(fd, false);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
     }
     catch (...) {
         close(fd);
@@ -238,6 +275,7 @@ ArchNetworkBSD::acceptSocket(ArchSocket s, ArchNetAddress* addr)
         *addr = nullptr;
         throw;
     }
+#endif
 
     // initialize socket
     newSocket->m_fd       = fd;
@@ -284,8 +322,15 @@ ArchNetworkBSD::pollSocket(PollEntry pe[], int num, double timeout)
         return 0;
     }
 
-    // allocate space for translated query
-    auto* pfd = new struct pollfd[1 + num];
+    // allocate space for translated query.  this is called for every
+    // pass of the socket multiplexer so avoid the heap when we can.
+    struct pollfd stackPfd[s_pollStackSize];
+    std::vector<struct pollfd> heapPfd;
+    struct pollfd* pfd = stackPfd;
+    if (1 + num > s_pollStackSize) {
+        heapPfd.resize(1 + num);
+        pfd = heapPfd.data();
+    }
 
     // translate query
     for (int i = 0; i < num; ++i) {
@@ -333,10 +378,8 @@ ArchNetworkBSD::pollSocket(PollEntry pe[], int num, double timeout)
         if (errno == EINTR) {
             // interrupted system call
             ARCH->testCancelThread();
-            delete[] pfd;
             return 0;
         }
-        delete[] pfd;
         throwError(errno);
         return -1;
     }
@@ -344,7 +387,8 @@ ArchNetworkBSD::pollSocket(PollEntry pe[], int num, double timeout)
     // translate back
     for (int i = 0; i < num; ++i) {
         pe[i].m_revents = 0;
-        if ((pfd[i].revents & POLLIN) != 0) {
+        // a hung up peer reads as end of stream
+        if ((pfd[i].revents & (POLLIN | POLLHUP)) != 0) {
             pe[i].m_revents |= kPOLLIN;
         }
         if ((pfd[i].revents & POLLOUT) != 0) {
@@ -358,7 +402,6 @@ ArchNetworkBSD::pollSocket(PollEntry pe[], int num, double timeout)
         }
     }
 
-    delete[] pfd;
     return n;
 }
 
@@ -500,6 +543,184 @@ ArchNetworkBSD::unblockPollSocket(ArchThread thread)
     }
 }
 
+#if HAVE_SYS_EPOLL_H
+
+ArchPollSet
+ArchNetworkBSD::newPollSet()
+{
+    int fd = epoll_create1(EPOLL_CLOEXEC);
+    if (fd == -1) {
+        // fall back to pollSocket()
+        return nullptr;
+    }
+
+    auto* set = new ArchPollSetImpl;
+    set->m_fd        = fd;
+    set->m_unblockFd = -1;
+    return set;
+}
+
+void
+ArchNetworkBSD::closePollSet(ArchPollSet set)
+{
+    assert(set != NULL);
+
+    close(set->m_fd);
+    delete set;
+}
+
+void
+ArchNetworkBSD::updatePollSet(ArchPollSet set, ArchSocket s,
+                unsigned short events, void* data)
+{
+    assert(set != NULL);
+    assert(s   != NULL);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if ((events & kPOLLIN) != 0) {
+        ev.events |= EPOLLIN;
+    }
+    if ((events & kPOLLOUT) != 0) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.ptr = data;
+
+    // modify the registration, registering the socket if the set doesn't
+    // know about it yet.  the kernel drops closed descriptors from the
+    // set by itself so a reused descriptor may already be registered.
+    if (epoll_ctl(set->m_fd, EPOLL_CTL_MOD, s->m_fd, &ev) == -1) {
+        if (errno != ENOENT ||
+            epoll_ctl(set->m_fd, EPOLL_CTL_ADD, s->m_fd, &ev) == -1) {
+            throwError(errno);
+        }
+    }
+}
+
+void
+ArchNetworkBSD::removeFromPollSet(ArchPollSet set, ArchSocket s)
+{
+    assert(set != NULL);
+    assert(s   != NULL);
+
+    // old kernels require a non-NULL event for EPOLL_CTL_DEL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    if (epoll_ctl(set->m_fd, EPOLL_CTL_DEL, s->m_fd, &ev) == -1) {
+        if (errno != ENOENT && errno != EBADF) {
+            throwError(errno);
+        }
+    }
+}
+
+int
+ArchNetworkBSD::waitPollSet(ArchPollSet set,
+                PollSetEntry pe[], int num, double timeout)
+{
+    assert(set != NULL);
+    assert(pe  != NULL || num == 0);
+
+    // add the unblock pipe of the waiting thread.  the set itself is
+    // used as the data to tell it apart from the sockets.
+    if (set->m_unblockFd == -1) {
+        const int* unblockPipe = getUnblockPipe();
+        if (unblockPipe != nullptr) {
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events   = EPOLLIN;
+            ev.data.ptr = set;
+            if (epoll_ctl(set->m_fd, EPOLL_CTL_ADD,
+                            unblockPipe[0], &ev) != -1) {
+                set->m_unblockFd = unblockPipe[0];
+            }
+        }
+    }
+
+    // prepare timeout
+    int t = (timeout < 0.0) ? -1 : static_cast<int>(1000.0 * timeout);
+
+    // do the wait
+    struct epoll_event events[s_pollSetMaxEvents];
+    int n = epoll_wait(set->m_fd, events,
+                    (num < s_pollSetMaxEvents) ? num : s_pollSetMaxEvents, t);
+
+    // handle results
+    if (n == -1) {
+        if (errno == EINTR) {
+            // interrupted system call
+            ARCH->testCancelThread();
+            return 0;
+        }
+        throwError(errno);
+        return -1;
+    }
+
+    // translate back
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (events[i].data.ptr == set) {
+            // the unblock event was signalled.  flush the pipe.
+            char dummy[100];
+            while (read(set->m_unblockFd, dummy, sizeof(dummy)) > 0) {
+                // do nothing
+            }
+            continue;
+        }
+
+        pe[count].m_data    = events[i].data.ptr;
+        pe[count].m_revents = 0;
+        // a hung up peer reads as end of stream
+        if ((events[i].events & (EPOLLIN | EPOLLHUP)) != 0) {
+            pe[count].m_revents |= kPOLLIN;
+        }
+        if ((events[i].events & EPOLLOUT) != 0) {
+            pe[count].m_revents |= kPOLLOUT;
+        }
+        if ((events[i].events & EPOLLERR) != 0) {
+            pe[count].m_revents |= kPOLLERR;
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+#else
+
+ArchPollSet
+ArchNetworkBSD::newPollSet()
+{
+    // no persistent polling facility.  callers use pollSocket().
+    return nullptr;
+}
+
+void
+ArchNetworkBSD::closePollSet(ArchPollSet)
+{
+    assert(0 && "poll sets not supported");
+}
+
+void
+ArchNetworkBSD::updatePollSet(ArchPollSet, ArchSocket, unsigned short, void*)
+{
+    assert(0 && "poll sets not supported");
+}
+
+void
+ArchNetworkBSD::removeFromPollSet(ArchPollSet, ArchSocket)
+{
+    assert(0 && "poll sets not supported");
+}
+
+int
+ArchNetworkBSD::waitPollSet(ArchPollSet, PollSetEntry[], int, double)
+{
+    assert(0 && "poll sets not supported");
+    return 0;
+}
+
+#endif
+
 size_t
 ArchNetworkBSD::readSocket(ArchSocket s, void* buf, size_t len)
 {
@@ -530,6 +751,58 @@ ArchNetworkBSD::writeSocket(ArchSocket s, const void* buf, size_t len)
     return n;
 }
 
+size_t
+ArchNetworkBSD::readSocketVector(ArchSocket s,
+                const IOVector* vectors, int num)
+{
+    assert(s != NULL);
+    assert(vectors != NULL || num == 0);
+
+    struct iovec iov[s_maxIOVectors];
+    if (num > s_maxIOVectors) {
+        num = s_maxIOVectors;
+    }
+    for (int i = 0; i < num; ++i) {
+        iov[i].iov_base = vectors[i].m_data;
+        iov[i].iov_len  = vectors[i].m_size;
+    }
+
+    ssize_t n = readv(s->m_fd, iov, num);
+    if (n == -1) {
+        if (errno == EINTR || errno == EAGAIN) {
+            return 0;
+        }
+        throwError(errno);
+    }
+    return n;
+}
+
+size_t
+ArchNetworkBSD::writeSocketVector(ArchSocket s,
+                const IOVector* vectors, int num)
+{
+    assert(s != NULL);
+    assert(vectors != NULL || num == 0);
+
+    struct iovec iov[s_maxIOVectors];
+    if (num > s_maxIOVectors) {
+        num = s_maxIOVectors;
+    }
+    for (int i = 0; i < num; ++i) {
+        iov[i].iov_base = vectors[i].m_data;
+        iov[i].iov_len  = vectors[i].m_size;
+    }
+
+    ssize_t n = s_connectors.writev_impl(s->m_fd, iov, num);
+    if (n == -1) {
+        if (errno == EINTR || errno == EAGAIN) {
+            return 0;
+        }
+        throwError(errno);
+    }
+    return n;
+}
+
 void
 ArchNetworkBSD::throwErrorOnSocket(ArchSocket s)
 {
@@ -592,6 +865,24 @@ ArchNetworkBSD::setNoDelayOnSocket(ArchSocket s, bool noDelay)
     return (oflag != 0);
 }
 
+bool
+ArchNetworkBSD::setCorkOnSocket(ArchSocket s, bool cork)
+{
+    assert(s != NULL);
+
+    // only linux has TCP_CORK.  TCP_NOPUSH on the BSDs looks similar but
+    // turning it off doesn't send the data it held back.
+#if defined(TCP_CORK)
+    int flag = cork ? 1 : 0;
+    return (setsockopt(s->m_fd, IPPROTO_TCP, TCP_CORK,
+                            reinterpret_cast<optval_t*>(&flag),
+                            static_cast<socklen_t>(sizeof(flag))) == 0);
+#else
+    (void)cork;
+    return false;
+#endif
+}
+
 bool
 ArchNetworkBSD::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 {
@@ -690,12 +981,11 @@ ArchNetworkBSD::nameToAddr(const std::string& name)
         hints.ai_flags |= AI_NUMERICHOST;
     }
 
-    // done with static buffer
-    ARCH->lockMutex(m_mutex);
+    // getaddrinfo is reentrant so don't hold the mutex while it waits on
+    // the name server
     struct addrinfo *pResult = nullptr;
     int ret = getaddrinfo(name.c_str(), nullptr, &hints, &pResult);
     if (ret != 0) {
-        ARCH->unlockMutex(m_mutex);
         throwNameError(ret);
     }
 
@@ -713,7 +1003,6 @@ ArchNetworkBSD::nameToAddr(const std::string& name)
     }
 
     freeaddrinfo(pResult);
-    ARCH->unlockMutex(m_mutex);
 
     return addresses;
 }
@@ -40,6 +40,8 @@ struct sockaddr_storage {
 typedef int socklen_t;
 #endif
 
+#include <sys/uio.h>
+
 #if HAVE_POLL
 #    include <poll.h>
 #else
@@ -65,6 +67,12 @@ public:
     int                    m_refCount;
 };
 
+class ArchPollSetImpl {
+public:
+    int                    m_fd;
+    int                    m_unblockFd;
+};
+
 class ArchNetAddressImpl {
 public:
     ArchNetAddressImpl() : m_len(sizeof(m_addr)) { }
@@ -94,16 +102,28 @@ public:
     virtual void        closeSocketForRead(ArchSocket s);
     virtual void        closeSocketForWrite(ArchSocket s);
     virtual void        bindSocket(ArchSocket s, ArchNetAddress addr);
-    virtual void        listenOnSocket(ArchSocket s);
+    virtual void        listenOnSocket(ArchSocket s, int backlog);
     virtual ArchSocket    acceptSocket(ArchSocket s, ArchNetAddress* addr);
     virtual bool        connectSocket(ArchSocket s, ArchNetAddress name);
     virtual int            pollSocket(PollEntry[], int num, double timeout);
     virtual void        unblockPollSocket(ArchThread thread);
+    virtual ArchPollSet    newPollSet();
+    virtual void        closePollSet(ArchPollSet set);
+    virtual void        updatePollSet(ArchPollSet set, ArchSocket s,
+                            unsigned short events, void* data);
+    virtual void        removeFromPollSet(ArchPollSet set, ArchSocket s);
+    virtual int            waitPollSet(ArchPollSet set,
+                            PollSetEntry[], int num, double timeout);
     virtual size_t        readSocket(ArchSocket s, void* buf, size_t len);
     virtual size_t        writeSocket(ArchSocket s,
                             const void* buf, size_t len);
+    virtual size_t        readSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num);
+    virtual size_t        writeSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num);
     virtual void        throwErrorOnSocket(ArchSocket);
     virtual bool        setNoDelayOnSocket(ArchSocket, bool noDelay);
+    virtual bool        setCorkOnSocket(ArchSocket, bool cork);
     virtual bool        setReuseAddrOnSocket(ArchSocket, bool reuse);
     virtual std::string        getHostName();
     virtual ArchNetAddress    newAnyAddr(EAddressFamily);
@@ -123,10 +143,12 @@ public:
 #if HAVE_POLL
         int (*poll_impl)(struct pollfd *, nfds_t, int);
 #endif // HAVE_POLL
+        ssize_t (*writev_impl)(int, const struct iovec*, int);
         Connectors() {
 #if HAVE_POLL
             poll_impl = poll;
 #endif // HAVE_POLL
+            writev_impl = writev;
         }
     };
     static Connectors s_connectors;
@@ -306,12 +306,14 @@ ArchNetworkWinsock::bindSocket(ArchSocket s, ArchNetAddress addr)
 }
 
 void
-ArchNetworkWinsock::listenOnSocket(ArchSocket s)
+ArchNetworkWinsock::listenOnSocket(ArchSocket s, int backlog)
 {
     assert(s != NULL);
 
-    // hardcoding backlog
-    if (listen_winsock(s->m_socket, 3) == SOCKET_ERROR) {
+    if (backlog <= 0) {
+        backlog = SOMAXCONN;
+    }
+    if (listen_winsock(s->m_socket, backlog) == SOCKET_ERROR) {
         throwError(getsockerror_winsock());
     }
 }
@@ -550,6 +552,39 @@ ArchNetworkWinsock::unblockPollSocket(ArchThread thread)
     }
 }
 
+ArchPollSet
+ArchNetworkWinsock::newPollSet()
+{
+    // no persistent polling facility.  callers use pollSocket().
+    return NULL;
+}
+
+void
+ArchNetworkWinsock::closePollSet(ArchPollSet)
+{
+    assert(0 && "poll sets not supported");
+}
+
+void
+ArchNetworkWinsock::updatePollSet(ArchPollSet, ArchSocket,
+                unsigned short, void*)
+{
+    assert(0 && "poll sets not supported");
+}
+
+void
+ArchNetworkWinsock::removeFromPollSet(ArchPollSet, ArchSocket)
+{
+    assert(0 && "poll sets not supported");
+}
+
+int
+ArchNetworkWinsock::waitPollSet(ArchPollSet, PollSetEntry[], int, double)
+{
+    assert(0 && "poll sets not supported");
+    return 0;
+}
+
 size_t
 ArchNetworkWinsock::readSocket(ArchSocket s, void* buf, size_t len)
 {
@@ -586,6 +621,56 @@ ArchNetworkWinsock::writeSocket(ArchSocket s, const void* buf, size_t len)
     return static_cast<size_t>(n);
 }
 
+size_t
+ArchNetworkWinsock::readSocketVector(ArchSocket s,
+                const IOVector* vectors, int num)
+{
+    // read each buffer in turn, stopping when one isn't filled
+    size_t total = 0;
+    try {
+        for (int i = 0; i < num; ++i) {
+            size_t n = readSocket(s, vectors[i].m_data, vectors[i].m_size);
+            total += n;
+            if (n < vectors[i].m_size) {
+                break;
+            }
+        }
+    }
+    catch (XArchNetwork&) {
+        // report what was transferred.  the error is raised again by
+        // the next call.
+        if (total == 0) {
+            throw;
+        }
+    }
+    return total;
+}
+
+size_t
+ArchNetworkWinsock::writeSocketVector(ArchSocket s,
+                const IOVector* vectors, int num)
+{
+    // write each buffer in turn, stopping when one isn't fully written
+    size_t total = 0;
+    try {
+        for (int i = 0; i < num; ++i) {
+            size_t n = writeSocket(s, vectors[i].m_data, vectors[i].m_size);
+            total += n;
+            if (n < vectors[i].m_size) {
+                break;
+            }
+        }
+    }
+    catch (XArchNetwork&) {
+        // report what was transferred.  the error is raised again by
+        // the next call.
+        if (total == 0) {
+            throw;
+        }
+    }
+    return total;
+}
+
 void
 ArchNetworkWinsock::throwErrorOnSocket(ArchSocket s)
 {
@@ -640,6 +725,13 @@ ArchNetworkWinsock::setNoDelayOnSocket(ArchSocket s, bool noDelay)
     return (oflag != 0);
 }
 
+bool
+ArchNetworkWinsock::setCorkOnSocket(ArchSocket, bool)
+{
+    // winsock has no equivalent of TCP_CORK
+    return false;
+}
+
 bool
 ArchNetworkWinsock::setReuseAddrOnSocket(ArchSocket s, bool reuse)
 {
@@ -728,9 +820,9 @@ ArchNetworkWinsock::nameToAddr(const std::string& name)
     hints.ai_family = AF_UNSPEC;
     int ret = -1;
 
-    ARCH->lockMutex(m_mutex);
+    // getaddrinfo is thread safe so don't hold the mutex while it waits
+    // on the name server
     if ((ret = getaddrinfo(name.c_str(), NULL, &hints, &pResult)) != 0) {
-        ARCH->unlockMutex(m_mutex);
         throwNameError(ret);
     }
 
@@ -746,7 +838,6 @@ ArchNetworkWinsock::nameToAddr(const std::string& name)
     }
 
     freeaddrinfo(pResult);
-    ARCH->unlockMutex(m_mutex);
     return addresses;
 }
 
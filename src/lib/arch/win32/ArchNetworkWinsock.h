@@ -71,16 +71,28 @@ public:
     virtual void        closeSocketForRead(ArchSocket s);
     virtual void        closeSocketForWrite(ArchSocket s);
     virtual void        bindSocket(ArchSocket s, ArchNetAddress addr);
-    virtual void        listenOnSocket(ArchSocket s);
+    virtual void        listenOnSocket(ArchSocket s, int backlog);
     virtual ArchSocket    acceptSocket(ArchSocket s, ArchNetAddress* addr);
     virtual bool        connectSocket(ArchSocket s, ArchNetAddress name);
     virtual int            pollSocket(PollEntry[], int num, double timeout);
     virtual void        unblockPollSocket(ArchThread thread);
+    virtual ArchPollSet    newPollSet();
+    virtual void        closePollSet(ArchPollSet set);
+    virtual void        updatePollSet(ArchPollSet set, ArchSocket s,
+                            unsigned short events, void* data);
+    virtual void        removeFromPollSet(ArchPollSet set, ArchSocket s);
+    virtual int            waitPollSet(ArchPollSet set,
+                            PollSetEntry[], int num, double timeout);
     virtual size_t        readSocket(ArchSocket s, void* buf, size_t len);
     virtual size_t        writeSocket(ArchSocket s,
                             const void* buf, size_t len);
+    virtual size_t        readSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num);
+    virtual size_t        writeSocketVector(ArchSocket s,
+                            const IOVector* vectors, int num);
     virtual void        throwErrorOnSocket(ArchSocket);
     virtual bool        setNoDelayOnSocket(ArchSocket, bool noDelay);
+    virtual bool        setCorkOnSocket(ArchSocket, bool cork);
     virtual bool        setReuseAddrOnSocket(ArchSocket, bool reuse);
     virtual std::string        getHostName();
     virtual ArchNetAddress    newAnyAddr(EAddressFamily);
@@ -0,0 +1,83 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2012-2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventBatch.h"
+#include "common/stdvector.h"
+
+#include <algorithm>
+
+namespace {
+
+// nesting depth of batches on this thread and the members that joined
+// this thread's batch in the order they joined.  members that left
+// are set to NULL so leaving while members are notified is safe.
+thread_local int    s_depth = 0;
+thread_local std::vector<EventBatch::IMember*> s_members;
+
+} // namespace
+
+//
+// EventBatch
+//
+
+EventBatch::EventBatch()
+{
+    ++s_depth;
+}
+
+EventBatch::~EventBatch()
+{
+    if (--s_depth != 0 || s_members.empty()) {
+        return;
+    }
+
+    // notify this thread's members in the order they joined.  the list
+    // keeps its storage for the next batch.
+    for (size_t i = 0; i < s_members.size(); ++i) {
+        if (s_members[i] != NULL) {
+            s_members[i]->batchClosed();
+        }
+    }
+    s_members.clear();
+}
+
+bool
+EventBatch::join(IMember* member)
+{
+    if (s_depth == 0) {
+        return false;
+    }
+    if (std::find(s_members.begin(), s_members.end(),
+                        member) != s_members.end()) {
+        return false;
+    }
+    s_members.push_back(member);
+    return true;
+}
+
+void
+EventBatch::leave(IMember* member)
+{
+    std::replace(s_members.begin(), s_members.end(),
+                        member, static_cast<IMember*>(NULL));
+}
+
+bool
+EventBatch::isOpen()
+{
+    return (s_depth != 0);
+}
@@ -0,0 +1,80 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2012-2016 Symless Ltd.
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/IInterface.h"
+
+//! Work batched over the handling of an event
+/*!
+An event batch is open on a thread while an object of this class exists
+on that thread.  EventQueue opens one around each event it dispatches.
+Objects that can put off work until the handler is done, such as
+sockets sending a burst of messages, join the thread's batch and are
+told when the outermost batch on the thread closes.  Batches and their
+members are per thread so nothing here takes a lock.
+*/
+class EventBatch {
+public:
+    //! A member of a batch
+    class IMember : public IInterface {
+    public:
+        //! Notify member that the batch it joined has closed
+        /*!
+        Called on the thread that closed the batch.  This must not
+        call join() or leave().
+        */
+        virtual void    batchClosed() = 0;
+    };
+
+    EventBatch();
+    EventBatch(EventBatch const &) =delete;
+    EventBatch(EventBatch &&) =delete;
+    ~EventBatch();
+
+    EventBatch& operator=(EventBatch const &) =delete;
+    EventBatch& operator=(EventBatch &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Join the calling thread's batch
+    /*!
+    Adds \c member to the batch open on the calling thread.  Returns
+    true if it was added and false if no batch is open or the member
+    already joined it.  Members are notified in the order they joined.
+    */
+    static bool         join(IMember* member);
+
+    //! Leave the calling thread's batch
+    /*!
+    Removes \c member from the batch open on the calling thread, if it
+    joined it, without notifying it.  Members must call this before
+    they're destroyed.  A member in a batch is in use by the thread
+    that has the batch so it can only be destroyed on that thread.
+    */
+    static void         leave(IMember* member);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Test if the calling thread has a batch open
+    static bool         isOpen();
+
+    //@}
+};
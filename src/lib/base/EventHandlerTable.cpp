@@ -0,0 +1,267 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventHandlerTable.h"
+
+#include <cstdint>
+#include <thread>
+
+static const size_t kInitialSize = 256;
+
+//
+// EventHandlerTable::Table
+//
+
+EventHandlerTable::Table::Table(size_t size) :
+    m_mask(size - 1),
+    m_slots(new Slot[size])
+{
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].m_target.store(NULL, std::memory_order_relaxed);
+        m_slots[i].m_type.store(Event::kUnknown, std::memory_order_relaxed);
+        m_slots[i].m_job.store(NULL, std::memory_order_relaxed);
+    }
+}
+
+
+//
+// EventHandlerTable
+//
+
+EventHandlerTable::EventHandlerTable() :
+    m_sequence(0),
+    m_count(0)
+{
+    m_tables.emplace_back(new Table(kInitialSize));
+    m_table.store(m_tables.back().get(), std::memory_order_release);
+}
+
+EventHandlerTable::~EventHandlerTable()
+{
+    // do nothing
+}
+
+IEventJob*
+EventHandlerTable::add(Event::Type type, void* target, IEventJob* job)
+{
+    if (job == NULL) {
+        return remove(type, target);
+    }
+
+    beginChange();
+
+    IEventJob* old = NULL;
+    size_t index   = indexOf(type, target);
+    Table* table   = m_table.load(std::memory_order_relaxed);
+    Slot& slot     = table->m_slots[index];
+    if (slot.m_job.load(std::memory_order_relaxed) != NULL) {
+        old = slot.m_job.load(std::memory_order_relaxed);
+        slot.m_job.store(job, std::memory_order_relaxed);
+    }
+    else {
+        slot.m_target.store(target, std::memory_order_relaxed);
+        slot.m_type.store(type, std::memory_order_relaxed);
+        slot.m_job.store(job, std::memory_order_relaxed);
+
+        // keep the table at most half full so probes stay short
+        if (2 * ++m_count > table->m_mask + 1) {
+            grow();
+        }
+    }
+
+    endChange();
+    return old;
+}
+
+IEventJob*
+EventHandlerTable::remove(Event::Type type, void* target)
+{
+    size_t index = indexOf(type, target);
+    Slot& slot   = m_table.load(std::memory_order_relaxed)->m_slots[index];
+    IEventJob* job = slot.m_job.load(std::memory_order_relaxed);
+    if (job != NULL) {
+        beginChange();
+        erase(index);
+        endChange();
+    }
+    return job;
+}
+
+void
+EventHandlerTable::removeAll(void* target, std::vector<IEventJob*>& jobs)
+{
+    // find the target's types first since removing moves entries
+    std::vector<Event::Type> types;
+    const Table* table = m_table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= table->m_mask; ++i) {
+        const Slot& slot = table->m_slots[i];
+        if (slot.m_job.load(std::memory_order_relaxed) != NULL &&
+            slot.m_target.load(std::memory_order_relaxed) == target) {
+            types.push_back(slot.m_type.load(std::memory_order_relaxed));
+        }
+    }
+
+    for (Event::Type type : types) {
+        jobs.push_back(remove(type, target));
+    }
+}
+
+IEventJob*
+EventHandlerTable::find(Event::Type type, void* target) const
+{
+    for (;;) {
+        UInt32 sequence = m_sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0) {
+            // a change is under way
+            std::this_thread::yield();
+            continue;
+        }
+
+        IEventJob* job = probe(m_table.load(std::memory_order_acquire), type, target);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+            return job;
+        }
+    }
+}
+
+size_t
+EventHandlerTable::hash(Event::Type type, void* target)
+{
+    // fibonacci hashing of the pointer mixed with the type
+    size_t key = reinterpret_cast<uintptr_t>(target) ^
+                            (static_cast<size_t>(type) * 0x9e3779b9u);
+    key *= static_cast<size_t>(0x9e3779b97f4a7c15ull);
+    return key ^ (key >> (4 * sizeof(size_t)));
+}
+
+IEventJob*
+EventHandlerTable::probe(const Table* table, Event::Type type, void* target)
+{
+    // a lookup racing a change can see any mix of entries so bound
+    // the probe by the table size rather than trusting an empty slot
+    // to turn up
+    size_t index = (hash(type, target) & table->m_mask);
+    for (size_t n = 0; n <= table->m_mask; ++n) {
+        const Slot& slot = table->m_slots[index];
+        IEventJob* job   = slot.m_job.load(std::memory_order_relaxed);
+        if (job == NULL) {
+            break;
+        }
+        if (slot.m_target.load(std::memory_order_relaxed) == target &&
+            slot.m_type.load(std::memory_order_relaxed) == type) {
+            return job;
+        }
+        index = ((index + 1) & table->m_mask);
+    }
+    return NULL;
+}
+
+size_t
+EventHandlerTable::indexOf(Event::Type type, void* target) const
+{
+    // index of the entry for type and target or of the empty slot
+    // it'd go in
+    const Table* table = m_table.load(std::memory_order_relaxed);
+    size_t index = (hash(type, target) & table->m_mask);
+    for (;;) {
+        const Slot& slot = table->m_slots[index];
+        if (slot.m_job.load(std::memory_order_relaxed) == NULL ||
+            (slot.m_target.load(std::memory_order_relaxed) == target &&
+             slot.m_type.load(std::memory_order_relaxed) == type)) {
+            return index;
+        }
+        index = ((index + 1) & table->m_mask);
+    }
+}
+
+void
+EventHandlerTable::erase(size_t index)
+{
+    // shift later entries of the probe sequence back over the hole so
+    // lookups don't need tombstones
+    Table* table = m_table.load(std::memory_order_relaxed);
+    size_t mask  = table->m_mask;
+    size_t next  = index;
+    for (;;) {
+        next = ((next + 1) & mask);
+        Slot& slot = table->m_slots[next];
+        if (slot.m_job.load(std::memory_order_relaxed) == NULL) {
+            break;
+        }
+
+        // move the entry if the hole is between its home and it
+        void* target     = slot.m_target.load(std::memory_order_relaxed);
+        Event::Type type = slot.m_type.load(std::memory_order_relaxed);
+        size_t home      = (hash(type, target) & mask);
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            Slot& hole = table->m_slots[index];
+            hole.m_target.store(target, std::memory_order_relaxed);
+            hole.m_type.store(type, std::memory_order_relaxed);
+            hole.m_job.store(slot.m_job.load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+            index = next;
+        }
+    }
+
+    table->m_slots[index].m_job.store(NULL, std::memory_order_relaxed);
+    --m_count;
+}
+
+void
+EventHandlerTable::grow()
+{
+    const Table* old = m_table.load(std::memory_order_relaxed);
+    std::unique_ptr<Table> table(new Table(2 * (old->m_mask + 1)));
+    for (size_t i = 0; i <= old->m_mask; ++i) {
+        const Slot& from = old->m_slots[i];
+        IEventJob* job   = from.m_job.load(std::memory_order_relaxed);
+        if (job == NULL) {
+            continue;
+        }
+        void* target     = from.m_target.load(std::memory_order_relaxed);
+        Event::Type type = from.m_type.load(std::memory_order_relaxed);
+        size_t index     = (hash(type, target) & table->m_mask);
+        while (table->m_slots[index].m_job.load(std::memory_order_relaxed) != NULL) {
+            index = ((index + 1) & table->m_mask);
+        }
+        Slot& to = table->m_slots[index];
+        to.m_target.store(target, std::memory_order_relaxed);
+        to.m_type.store(type, std::memory_order_relaxed);
+        to.m_job.store(job, std::memory_order_relaxed);
+    }
+
+    // lookups may still be reading the old table so keep it
+    m_table.store(table.get(), std::memory_order_release);
+    m_tables.push_back(std::move(table));
+}
+
+void
+EventHandlerTable::beginChange()
+{
+    UInt32 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void
+EventHandlerTable::endChange()
+{
+    UInt32 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_release);
+}
@@ -0,0 +1,118 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/Event.h"
+#include "common/stdvector.h"
+
+#include <atomic>
+#include <memory>
+
+class IEventJob;
+
+//! Event handlers by type and target
+/*!
+Maps an event type and target to the job that handles them.  Entries
+are kept in an open addressed hash table so finding a handler costs
+the same however many targets there are.
+
+Finding a handler doesn't lock.  Changes are bracketed by a sequence
+count, a seqlock, and a lookup that overlaps a change is retried.
+Callers must make sure only one thread changes the table at a time.
+Arrays outgrown by the table are kept until it's destroyed because a
+lookup may still be reading one.  The table doesn't own the jobs.
+*/
+class EventHandlerTable {
+public:
+    EventHandlerTable();
+    EventHandlerTable(EventHandlerTable const &) =delete;
+    EventHandlerTable(EventHandlerTable &&) =delete;
+    ~EventHandlerTable();
+
+    EventHandlerTable& operator=(EventHandlerTable const &) =delete;
+    EventHandlerTable& operator=(EventHandlerTable &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Set a handler
+    /*!
+    Makes \c job handle events of \c type for \c target.  Returns the
+    job it replaced, if any, for the caller to delete.
+    */
+    IEventJob*          add(Event::Type type, void* target, IEventJob* job);
+
+    //! Remove a handler
+    /*!
+    Removes the handler for events of \c type for \c target and
+    returns it, or NULL if there wasn't one.
+    */
+    IEventJob*          remove(Event::Type type, void* target);
+
+    //! Remove all handlers for a target
+    /*!
+    Removes every handler for \c target and appends them to \c jobs.
+    */
+    void                removeAll(void* target, std::vector<IEventJob*>& jobs);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Find a handler
+    /*!
+    Returns the handler for events of \c type for \c target or NULL if
+    there isn't one.  This may be called on any thread.
+    */
+    IEventJob*          find(Event::Type type, void* target) const;
+
+    //@}
+
+private:
+    // slots are empty if m_job is NULL.  the fields are atomic only so
+    // lookups can read them while they change;  the sequence count
+    // tells the lookup to try again if they did.
+    struct Slot {
+        std::atomic<void*>          m_target;
+        std::atomic<Event::Type>    m_type;
+        std::atomic<IEventJob*>     m_job;
+    };
+
+    struct Table {
+        explicit Table(size_t size);
+
+        size_t                      m_mask;
+        std::unique_ptr<Slot[]>     m_slots;
+    };
+
+    static size_t       hash(Event::Type type, void* target);
+    static IEventJob*   probe(const Table* table, Event::Type type, void* target);
+    size_t              indexOf(Event::Type type, void* target) const;
+    void                erase(size_t index);
+    void                grow();
+    void                beginChange();
+    void                endChange();
+
+private:
+    std::atomic<UInt32> m_sequence;
+    std::atomic<Table*> m_table;
+    size_t              m_count;
+
+    // the current table, last, and the ones it outgrew
+    std::vector<std::unique_ptr<Table>> m_tables;
+};
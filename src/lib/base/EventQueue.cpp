@@ -22,6 +22,7 @@
 #include "mt/Lock.h"
 #include "arch/Arch.h"
 #include "base/SimpleEventQueueBuffer.h"
+#include "base/EventBatch.h"
 #include "base/Stopwatch.h"
 #include "base/IEventJob.h"
 #include "base/EventTypes.h"
@@ -37,6 +38,7 @@ EVENT_TYPE_ACCESSOR(IpcServerProxy)
 EVENT_TYPE_ACCESSOR(IDataSocket)
 EVENT_TYPE_ACCESSOR(IListenSocket)
 EVENT_TYPE_ACCESSOR(ISocket)
+EVENT_TYPE_ACCESSOR(HostResolver)
 EVENT_TYPE_ACCESSOR(OSXScreen)
 EVENT_TYPE_ACCESSOR(ClientListener)
 EVENT_TYPE_ACCESSOR(ClientProxy)
@@ -75,6 +77,7 @@ EventQueue::EventQueue() :
     m_typesForIDataSocket(NULL),
     m_typesForIListenSocket(NULL),
     m_typesForISocket(NULL),
+    m_typesForHostResolver(NULL),
     m_typesForOSXScreen(NULL),
     m_typesForClientListener(NULL),
     m_typesForClientProxy(NULL),
@@ -187,11 +190,7 @@ EventQueue::adoptBuffer(IEventQueueBuffer* buffer)
 
     // discard old buffer and old events
     delete m_buffer;
-    for (EventTable::iterator i = m_events.begin(); i != m_events.end(); ++i) {
-        Event::deleteData(i->second);
-    }
     m_events.clear();
-    m_oldEventIDs.clear();
 
     // use new buffer
     m_buffer = buffer;
@@ -249,7 +248,9 @@ retry:
     case IEventQueueBuffer::kUser:
         {
             ArchMutexLock lock(m_mutex);
-            event = removeEvent(dataID);
+            if (!m_events.remove(dataID, event)) {
+                event = Event();
+            }
             return true;
         }
 
@@ -268,6 +269,9 @@ EventQueue::dispatchEvent(const Event& event)
         job = getHandler(Event::kUnknown, target);
     }
     if (job != NULL) {
+        // let work started by the handler, like socket writes, be
+        // finished together when it returns
+        EventBatch batch;
         job->run(event);
         return true;
     }
@@ -306,12 +310,13 @@ EventQueue::addEventToBuffer(const Event& event)
     ArchMutexLock lock(m_mutex);
     
     // store the event's data locally
-    UInt32 eventID = saveEvent(event);
+    UInt32 eventID = m_events.add(event);
     
     // add it
-    if (!m_buffer->addEvent(eventID)) {
+    Event discarded;
+    if (eventID == EventSlots::kBadID || !m_buffer->addEvent(eventID)) {
         // failed to send event
-        removeEvent(eventID);
+        m_events.remove(eventID, discarded);
         Event::deleteData(event);
     }
 }
@@ -326,12 +331,7 @@ EventQueue::newTimer(double duration, void* target)
         target = timer;
     }
     ArchMutexLock lock(m_mutex);
-    m_timers.insert(timer);
-    // initial duration is requested duration plus whatever's on
-    // the clock currently because the latter will be subtracted
-    // the next time we check for timers.
-    m_timerQueue.push(Timer(timer, duration,
-                            duration + m_time.getTime(), target, false));
+    m_timers.add(timer, target, duration, false, ARCH->time());
     return timer;
 }
 
@@ -345,12 +345,7 @@ EventQueue::newOneShotTimer(double duration, void* target)
         target = timer;
     }
     ArchMutexLock lock(m_mutex);
-    m_timers.insert(timer);
-    // initial duration is requested duration plus whatever's on
-    // the clock currently because the latter will be subtracted
-    // the next time we check for timers.
-    m_timerQueue.push(Timer(timer, duration,
-                            duration + m_time.getTime(), target, true));
+    m_timers.add(timer, target, duration, true, ARCH->time());
     return timer;
 }
 
@@ -358,44 +353,37 @@ void
 EventQueue::deleteTimer(EventQueueTimer* timer)
 {
     ArchMutexLock lock(m_mutex);
-    for (TimerQueue::iterator index = m_timerQueue.begin();
-                            index != m_timerQueue.end(); ++index) {
-        if (index->getTimer() == timer) {
-            m_timerQueue.erase(index);
-            break;
-        }
-    }
-    Timers::iterator index = m_timers.find(timer);
-    if (index != m_timers.end()) {
-        m_timers.erase(index);
-    }
+    m_timers.remove(timer);
     m_buffer->deleteTimer(timer);
 }
 
 void
-EventQueue::adoptHandler(Event::Type type, void* target, IEventJob* handler)
+EventQueue::rearmTimer(EventQueueTimer* timer, double duration)
 {
+    assert(duration > 0.0);
+
     ArchMutexLock lock(m_mutex);
-    IEventJob*& job = m_handlers[target][type];
-    delete job;
-    job = handler;
+    m_timers.rearm(timer, duration, ARCH->time());
+}
+
+void
+EventQueue::adoptHandler(Event::Type type, void* target, IEventJob* handler)
+{
+    IEventJob* old;
+    {
+        ArchMutexLock lock(m_mutex);
+        old = m_handlers.add(type, target, handler);
+    }
+    delete old;
 }
 
 void
 EventQueue::removeHandler(Event::Type type, void* target)
 {
-    IEventJob* handler = NULL;
+    IEventJob* handler;
     {
         ArchMutexLock lock(m_mutex);
-        HandlerTable::iterator index = m_handlers.find(target);
-        if (index != m_handlers.end()) {
-            TypeHandlerTable& typeHandlers = index->second;
-            TypeHandlerTable::iterator index2 = typeHandlers.find(type);
-            if (index2 != typeHandlers.end()) {
-                handler = index2->second;
-                typeHandlers.erase(index2);
-            }
-        }
+        handler = m_handlers.remove(type, target);
     }
     delete handler;
 }
@@ -406,16 +394,7 @@ EventQueue::removeHandlers(void* target)
     std::vector<IEventJob*> handlers;
     {
         ArchMutexLock lock(m_mutex);
-        HandlerTable::iterator index = m_handlers.find(target);
-        if (index != m_handlers.end()) {
-            // copy to handlers array and clear table for target
-            TypeHandlerTable& typeHandlers = index->second;
-            for (TypeHandlerTable::iterator index2 = typeHandlers.begin();
-                            index2 != typeHandlers.end(); ++index2) {
-                handlers.push_back(index2->second);
-            }
-            typeHandlers.clear();
-        }
+        m_handlers.removeAll(target, handlers);
     }
 
     // delete handlers
@@ -434,112 +413,31 @@ EventQueue::isEmpty() const
 IEventJob*
 EventQueue::getHandler(Event::Type type, void* target) const
 {
-    ArchMutexLock lock(m_mutex);
-    HandlerTable::const_iterator index = m_handlers.find(target);
-    if (index != m_handlers.end()) {
-        const TypeHandlerTable& typeHandlers = index->second;
-        TypeHandlerTable::const_iterator index2 = typeHandlers.find(type);
-        if (index2 != typeHandlers.end()) {
-            return index2->second;
-        }
-    }
-    return NULL;
-}
-
-UInt32
-EventQueue::saveEvent(const Event& event)
-{
-    // choose id
-    UInt32 id;
-    if (!m_oldEventIDs.empty()) {
-        // reuse an id
-        id = m_oldEventIDs.back();
-        m_oldEventIDs.pop_back();
-    }
-    else {
-        // make a new id
-        id = static_cast<UInt32>(m_events.size());
-    }
-
-    // save data
-    m_events[id] = event;
-    return id;
-}
-
-Event
-EventQueue::removeEvent(UInt32 eventID)
-{
-    // look up id
-    EventTable::iterator index = m_events.find(eventID);
-    if (index == m_events.end()) {
-        return Event();
-    }
-
-    // get data
-    Event event = index->second;
-    m_events.erase(index);
-
-    // save old id for reuse
-    m_oldEventIDs.push_back(eventID);
-
-    return event;
+    return m_handlers.find(type, target);
 }
 
 bool
 EventQueue::hasTimerExpired(Event& event)
 {
-    // return true if there's a timer in the timer priority queue that
-    // has expired.  if returning true then fill in event appropriately
-    // and reset and reinsert the timer.
-    if (m_timerQueue.empty()) {
-        return false;
-    }
-
-    // get time elapsed since last check
-    const double time = m_time.getTime();
-    m_time.reset();
-
-    // countdown elapsed time
-    for (TimerQueue::iterator index = m_timerQueue.begin();
-                            index != m_timerQueue.end(); ++index) {
-        (*index) -= time;
-    }
-
-    // done if no timers are expired
-    if (m_timerQueue.top() > 0.0) {
+    // return true if a timer has expired.  if returning true then fill
+    // in event appropriately.  the timer is rescheduled or, if it's a
+    // one-shot, disarmed.
+    ArchMutexLock lock(m_mutex);
+    void* target;
+    if (!m_timers.popExpired(ARCH->time(), m_timerEvent, target)) {
         return false;
     }
-
-    // remove timer from queue
-    Timer timer = m_timerQueue.top();
-    m_timerQueue.pop();
-
-    // prepare event and reset the timer's clock
-    timer.fillEvent(m_timerEvent);
-    event = Event(Event::kTimer, timer.getTarget(), &m_timerEvent);
-    timer.reset();
-
-    // reinsert timer into queue if it's not a one-shot
-    if (!timer.isOneShot()) {
-        m_timerQueue.push(timer);
-    }
-
+    event = Event(Event::kTimer, target, &m_timerEvent);
     return true;
 }
 
 double
 EventQueue::getNextTimerTimeout() const
 {
-    // return -1 if no timers, 0 if the top timer has expired, otherwise
-    // the time until the top timer in the timer priority queue will
-    // expire.
-    if (m_timerQueue.empty()) {
-        return -1.0;
-    }
-    if (m_timerQueue.top() <= 0.0) {
-        return 0.0;
-    }
-    return m_timerQueue.top();
+    // return -1 if no timers, 0 if a timer has expired, otherwise the
+    // time until the next timer will expire.
+    ArchMutexLock lock(m_mutex);
+    return m_timers.getNextTimeout(ARCH->time());
 }
 
 Event::Type
@@ -571,75 +469,3 @@ EventQueue::waitForReady() const
         }
     }
 }
-
-//
-// EventQueue::Timer
-//
-
-EventQueue::Timer::Timer(EventQueueTimer* timer, double timeout,
-                double initialTime, void* target, bool oneShot) :
-    m_timer(timer),
-    m_timeout(timeout),
-    m_target(target),
-    m_oneShot(oneShot),
-    m_time(initialTime)
-{
-    assert(m_timeout > 0.0);
-}
-
-EventQueue::Timer::~Timer()
-{
-    // do nothing
-}
-
-void
-EventQueue::Timer::reset()
-{
-    m_time = m_timeout;
-}
-
-EventQueue::Timer&
-EventQueue::Timer::operator-=(double dt)
-{
-    m_time -= dt;
-    return *this;
-}
-
-EventQueue::Timer::operator double() const
-{
-    return m_time;
-}
-
-bool
-EventQueue::Timer::isOneShot() const
-{
-    return m_oneShot;
-}
-
-EventQueueTimer*
-EventQueue::Timer::getTimer() const
-{
-    return m_timer;
-}
-
-void*
-EventQueue::Timer::getTarget() const
-{
-    return m_target;
-}
-
-void
-EventQueue::Timer::fillEvent(TimerEvent& event) const
-{
-    event.m_timer = m_timer;
-    event.m_count = 0;
-    if (m_time <= 0.0) {
-        event.m_count = static_cast<UInt32>((m_timeout - m_time) / m_timeout);
-    }
-}
-
-bool
-EventQueue::Timer::operator<(const Timer& t) const
-{
-    return m_time < t.m_time;
-}
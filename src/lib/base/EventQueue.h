@@ -22,7 +22,10 @@
 #include "arch/IArchMultithread.h"
 #include "base/IEventQueue.h"
 #include "base/Event.h"
+#include "base/EventHandlerTable.h"
+#include "base/EventSlots.h"
 #include "base/PriorityQueue.h"
+#include "base/TimerHeap.h"
 #include "base/Stopwatch.h"
 #include "common/stdmap.h"
 #include "common/stdset.h"
@@ -56,6 +59,7 @@ public:
     virtual EventQueueTimer*
                         newOneShotTimer(double duration, void* target);
     virtual void        deleteTimer(EventQueueTimer*);
+    virtual void        rearmTimer(EventQueueTimer*, double duration);
     virtual void        adoptHandler(Event::Type type,
                             void* target, IEventJob* handler);
     virtual void        removeHandler(Event::Type type, void* target);
@@ -71,49 +75,13 @@ public:
     virtual void        waitForReady() const;
 
 private:
-    UInt32                saveEvent(const Event& event);
-    Event                removeEvent(UInt32 eventID);
     bool                hasTimerExpired(Event& event);
     double                getNextTimerTimeout() const;
     void                addEventToBuffer(const Event& event);
     
 private:
-    class Timer {
-    public:
-        Timer(EventQueueTimer*, double timeout, double initialTime,
-                            void* target, bool oneShot);
-        ~Timer();
-
-        void            reset();
-
-        Timer&            operator-=(double);
-
-                        operator double() const;
-
-        bool            isOneShot() const;
-        EventQueueTimer*
-                        getTimer() const;
-        void*            getTarget() const;
-        void            fillEvent(TimerEvent&) const;
-
-        bool            operator<(const Timer&) const;
-
-    private:
-        EventQueueTimer*    m_timer;
-        double                m_timeout;
-        void*                m_target;
-        bool                m_oneShot;
-        double                m_time;
-    };
-
-    typedef std::set<EventQueueTimer*> Timers;
-    typedef PriorityQueue<Timer> TimerQueue;
-    typedef std::map<UInt32, Event> EventTable;
-    typedef std::vector<UInt32> EventIDList;
     typedef std::map<Event::Type, const char*> TypeMap;
     typedef std::map<String, Event::Type> NameMap;
-    typedef std::map<Event::Type, IEventJob*> TypeHandlerTable;
-    typedef std::map<void*, TypeHandlerTable> HandlerTable;
 
     int                    m_systemTarget;
     ArchMutex            m_mutex;
@@ -127,17 +95,14 @@ private:
     IEventQueueBuffer*    m_buffer;
 
     // saved events
-    EventTable            m_events;
-    EventIDList        m_oldEventIDs;
+    EventSlots            m_events;
 
     // timers
-    Stopwatch            m_time;
-    Timers                m_timers;
-    TimerQueue            m_timerQueue;
+    TimerHeap            m_timers;
     TimerEvent            m_timerEvent;
 
-    // event handlers
-    HandlerTable        m_handlers;
+    // event handlers.  changed with m_mutex held, looked up without.
+    EventHandlerTable    m_handlers;
 
 public:
     //
@@ -152,6 +117,7 @@ public:
     IDataSocketEvents&            forIDataSocket();
     IListenSocketEvents&        forIListenSocket();
     ISocketEvents&                forISocket();
+    HostResolverEvents&           forHostResolver();
     OSXScreenEvents&            forOSXScreen();
     ClientListenerEvents&        forClientListener();
     ClientProxyEvents&            forClientProxy();
@@ -174,6 +140,7 @@ private:
     IDataSocketEvents*            m_typesForIDataSocket;
     IListenSocketEvents*        m_typesForIListenSocket;
     ISocketEvents*                m_typesForISocket;
+    HostResolverEvents*           m_typesForHostResolver;
     OSXScreenEvents*            m_typesForOSXScreen;
     ClientListenerEvents*        m_typesForClientListener;
     ClientProxyEvents*            m_typesForClientProxy;
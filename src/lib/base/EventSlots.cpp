@@ -0,0 +1,101 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventSlots.h"
+
+//
+// EventSlots
+//
+
+EventSlots::EventSlots() :
+    m_free(kNoSlot),
+    m_count(0)
+{
+    // enough for the usual burst of events without growing
+    m_slots.reserve(64);
+}
+
+EventSlots::~EventSlots()
+{
+    // do nothing
+}
+
+UInt32
+EventSlots::add(const Event& event)
+{
+    UInt32 index = m_free;
+    if (index != kNoSlot) {
+        m_free = m_slots[index].m_next;
+    }
+    else if (m_slots.size() < kNoSlot) {
+        index = static_cast<UInt32>(m_slots.size());
+        m_slots.push_back(Slot());
+    }
+    else {
+        return kBadID;
+    }
+
+    Slot& slot   = m_slots[index];
+    slot.m_event = event;
+    slot.m_used  = true;
+    ++m_count;
+    return index | (slot.m_generation << kIndexBits);
+}
+
+bool
+EventSlots::remove(UInt32 id, Event& event)
+{
+    UInt32 index = (id & kIndexMask);
+    if (index >= m_slots.size()) {
+        return false;
+    }
+
+    Slot& slot = m_slots[index];
+    if (!slot.m_used || (id >> kIndexBits) != slot.m_generation) {
+        return false;
+    }
+
+    event = slot.m_event;
+    freeSlot(index);
+    return true;
+}
+
+void
+EventSlots::clear()
+{
+    for (UInt32 index = 0, n = static_cast<UInt32>(m_slots.size()); index < n; ++index) {
+        if (m_slots[index].m_used) {
+            Event::deleteData(m_slots[index].m_event);
+            freeSlot(index);
+        }
+    }
+}
+
+void
+EventSlots::freeSlot(UInt32 index)
+{
+    Slot& slot   = m_slots[index];
+    slot.m_event = Event();
+    slot.m_used  = false;
+
+    // wrap within the bits the id has for it
+    slot.m_generation = (slot.m_generation + 1) & (0xffffffffu >> kIndexBits);
+
+    slot.m_next = m_free;
+    m_free      = index;
+    --m_count;
+}
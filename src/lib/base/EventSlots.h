@@ -0,0 +1,105 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/Event.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+//! Storage for events waiting in an event queue buffer
+/*!
+Event queue buffers only carry an ID for each user event.  This keeps
+the events for those IDs in a vector of slots that's reused as events
+are added and removed, so neither allocates once the vector is big
+enough for the events that are waiting.
+
+An ID is the index of the event's slot and the slot's generation,
+which changes each time the slot is freed, so an ID that was already
+removed doesn't find the event that reused its slot.  This isn't
+thread safe.
+*/
+class EventSlots {
+public:
+    //! ID that's never returned by \c add()
+    static const UInt32 kBadID = 0xffffffffu;
+
+    EventSlots();
+    EventSlots(EventSlots const &) =delete;
+    EventSlots(EventSlots &&) =delete;
+    ~EventSlots();
+
+    EventSlots& operator=(EventSlots const &) =delete;
+    EventSlots& operator=(EventSlots &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Store an event
+    /*!
+    Saves \c event and returns its ID, or \c kBadID if there's no room.
+    */
+    UInt32              add(const Event& event);
+
+    //! Take an event
+    /*!
+    Sets \c event to the event with ID \c id and frees its slot.
+    Returns false, leaving \c event alone, if there's no such event.
+    */
+    bool                remove(UInt32 id, Event& event);
+
+    //! Discard all events
+    /*!
+    Frees every slot and deletes the data of the events in them.
+    */
+    void                clear();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the number of events stored
+    size_t              size() const { return m_count; }
+
+    //@}
+
+private:
+    // ids are the slot index in the low bits and the slot's
+    // generation in the rest.  index kNoSlot is never used so no id
+    // is kBadID.
+    static const UInt32 kIndexBits = 24;
+    static const UInt32 kIndexMask = (1u << kIndexBits) - 1;
+    static const UInt32 kNoSlot    = kIndexMask;
+
+    struct Slot {
+        Slot() : m_generation(0), m_next(kNoSlot), m_used(false) { }
+
+        Event           m_event;
+        UInt32          m_generation;
+        UInt32          m_next;
+        bool            m_used;
+    };
+
+    void                freeSlot(UInt32 index);
+
+private:
+    std::vector<Slot>   m_slots;
+
+    // head of the list of free slots, linked through m_next
+    UInt32              m_free;
+    size_t              m_count;
+};
@@ -57,6 +57,8 @@ REGISTER_EVENT(IStream, outputFlushed)
 REGISTER_EVENT(IStream, outputError)
 REGISTER_EVENT(IStream, inputShutdown)
 REGISTER_EVENT(IStream, outputShutdown)
+REGISTER_EVENT(IStream, outputCongested)
+REGISTER_EVENT(IStream, outputDrained)
 
 //
 // IpcClient
@@ -99,6 +101,12 @@ REGISTER_EVENT(IListenSocket, connecting)
 REGISTER_EVENT(ISocket, disconnected)
 REGISTER_EVENT(ISocket, stopRetry)
 
+//
+// HostResolver
+//
+
+REGISTER_EVENT(HostResolver, resolved)
+
 //
 // OSXScreen
 //
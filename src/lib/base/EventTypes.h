@@ -90,7 +90,9 @@ public:
         m_outputFlushed(Event::kUnknown),
         m_outputError(Event::kUnknown),
         m_inputShutdown(Event::kUnknown),
-        m_outputShutdown(Event::kUnknown) { }
+        m_outputShutdown(Event::kUnknown),
+        m_outputCongested(Event::kUnknown),
+        m_outputDrained(Event::kUnknown) { }
 
     //! @name accessors
     //@{
@@ -136,6 +138,22 @@ public:
     */
     Event::Type        outputShutdown();
 
+    //! Get output congested event type
+    /*!
+    Returns the output congested event type.  A stream sends this
+    event when its buffered output grows past the high water mark set
+    with \c setOutputLimits(), i.e. the other end isn't keeping up.
+    */
+    Event::Type        outputCongested();
+
+    //! Get output drained event type
+    /*!
+    Returns the output drained event type.  A stream sends this event
+    when its buffered output falls back to the low water mark after
+    an output congested event.
+    */
+    Event::Type        outputDrained();
+
     //@}
         
 private:
@@ -144,6 +162,8 @@ private:
     Event::Type        m_outputError;
     Event::Type        m_inputShutdown;
     Event::Type        m_outputShutdown;
+    Event::Type        m_outputCongested;
+    Event::Type        m_outputDrained;
 };
 
 class IpcClientEvents : public EventTypes {
@@ -321,6 +341,28 @@ private:
     Event::Type        m_stopRetry;
 };
 
+class HostResolverEvents : public EventTypes {
+public:
+    HostResolverEvents() :
+        m_resolved(Event::kUnknown) { }
+
+    //! @name accessors
+    //@{
+
+    //! Get resolved event type
+    /*!
+    Returns the resolved event type.  This is sent when a lookup the
+    resolver started in the background has finished, whether or not
+    it succeeded.
+    */
+    Event::Type        resolved();
+
+    //@}
+
+private:
+    Event::Type        m_resolved;
+};
+
 class OSXScreenEvents : public EventTypes {
 public:
     OSXScreenEvents() :
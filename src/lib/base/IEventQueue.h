@@ -39,6 +39,7 @@ class IpcServerProxyEvents;
 class IDataSocketEvents;
 class IListenSocketEvents;
 class ISocketEvents;
+class HostResolverEvents;
 class OSXScreenEvents;
 class ClientListenerEvents;
 class ClientProxyEvents;
@@ -125,7 +126,8 @@ public:
     //! Create a one-shot timer
     /*!
     Creates and returns a one-shot timer.  An event is returned when
-    the timer expires and the timer is removed from further handling.
+    the timer expires and the timer is removed from further handling
+    until it's passed to \c rearmTimer().
     When a timer event is returned the data points to a \c TimerEvent.
     The c_count member of the \c TimerEvent is always 1.  The client
     must pass the returned timer to \c deleteTimer() (whether or not the
@@ -144,6 +146,16 @@ public:
     */
     virtual void        deleteTimer(EventQueueTimer*) = 0;
 
+    //! Restart a timer
+    /*!
+    Makes \p timer expire \p duration seconds from now, as if it had
+    just been created with that duration, even if it's a one-shot timer
+    that already expired.  The timer keeps its target.  This doesn't
+    allocate, and pushing the expiry back, like a keep alive deadline
+    that moves with every message, usually only updates the deadline.
+    */
+    virtual void        rearmTimer(EventQueueTimer*, double duration) = 0;
+
     //! Register an event handler for an event type
     /*!
     Registers an event handler for \p type and \p target.  The \p handler
@@ -237,6 +249,7 @@ public:
     virtual IDataSocketEvents&            forIDataSocket() = 0;
     virtual IListenSocketEvents&        forIListenSocket() = 0;
     virtual ISocketEvents&                forISocket() = 0;
+    virtual HostResolverEvents&           forHostResolver() = 0;
     virtual OSXScreenEvents&            forOSXScreen() = 0;
     virtual ClientListenerEvents&        forClientListener() = 0;
     virtual ClientProxyEvents&            forClientProxy() = 0;
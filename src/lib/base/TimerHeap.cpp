@@ -0,0 +1,227 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/TimerHeap.h"
+
+#include <cassert>
+
+static const UInt32 kNoSlot = 0xffffffffu;
+
+//
+// TimerHeap
+//
+
+TimerHeap::TimerHeap() :
+    m_free(kNoSlot)
+{
+    // do nothing
+}
+
+TimerHeap::~TimerHeap()
+{
+    // do nothing
+}
+
+void
+TimerHeap::add(EventQueueTimer* timer, void* target,
+                double timeout, bool oneShot, double now)
+{
+    assert(timeout > 0.0);
+    assert(m_index.find(timer) == m_index.end());
+
+    UInt32 index     = allocateSlot();
+    Slot& slot       = m_slots[index];
+    slot.m_timer     = timer;
+    slot.m_target    = target;
+    slot.m_timeout   = timeout;
+    slot.m_deadline  = now + timeout;
+    slot.m_oneShot   = oneShot;
+    m_index[timer]   = index;
+    push(index);
+}
+
+bool
+TimerHeap::remove(EventQueueTimer* timer)
+{
+    auto i = m_index.find(timer);
+    if (i == m_index.end()) {
+        return false;
+    }
+    UInt32 index = i->second;
+    m_index.erase(i);
+
+    // the heap entry is dropped when it reaches the top
+    bool wasNext = (!m_queue.empty() && m_queue.top().m_slot == index);
+    freeSlot(index);
+    if (wasNext) {
+        prune();
+    }
+    compact();
+    return true;
+}
+
+bool
+TimerHeap::rearm(EventQueueTimer* timer, double timeout, double now)
+{
+    assert(timeout > 0.0);
+
+    auto i = m_index.find(timer);
+    if (i == m_index.end()) {
+        return false;
+    }
+    UInt32 index = i->second;
+    Slot& slot   = m_slots[index];
+    double deadline = now + timeout;
+    slot.m_timeout  = timeout;
+
+    if (slot.m_armed && deadline >= slot.m_deadline) {
+        // the entry in the heap comes up early and is moved then
+        slot.m_deadline = deadline;
+        if (m_queue.top().m_slot == index) {
+            prune();
+        }
+    }
+    else {
+        // the old entry, if any, would come up too late
+        ++slot.m_generation;
+        slot.m_deadline = deadline;
+        push(index);
+        compact();
+    }
+    return true;
+}
+
+bool
+TimerHeap::popExpired(double now, IEventQueue::TimerEvent& event, void*& target)
+{
+    if (m_queue.empty() || m_queue.top().m_deadline > now) {
+        return false;
+    }
+
+    UInt32 index = m_queue.top().m_slot;
+    m_queue.pop();
+
+    // count the periods that have gone by, like a timer that had been
+    // counting down would
+    Slot& slot     = m_slots[index];
+    event.m_timer  = slot.m_timer;
+    event.m_count  = static_cast<UInt32>(
+                            (slot.m_timeout + (now - slot.m_deadline)) / slot.m_timeout);
+    target         = slot.m_target;
+
+    if (slot.m_oneShot) {
+        slot.m_armed = false;
+        ++slot.m_generation;
+    }
+    else {
+        slot.m_deadline = now + slot.m_timeout;
+        push(index);
+    }
+    prune();
+    return true;
+}
+
+double
+TimerHeap::getNextTimeout(double now) const
+{
+    if (m_queue.empty()) {
+        return -1.0;
+    }
+    double timeLeft = m_queue.top().m_deadline - now;
+    return (timeLeft <= 0.0) ? 0.0 : timeLeft;
+}
+
+UInt32
+TimerHeap::allocateSlot()
+{
+    UInt32 index = m_free;
+    if (index != kNoSlot) {
+        m_free = m_slots[index].m_next;
+    }
+    else {
+        index = static_cast<UInt32>(m_slots.size());
+        Slot slot = { };
+        m_slots.push_back(slot);
+    }
+    m_slots[index].m_next = kNoSlot;
+    return index;
+}
+
+void
+TimerHeap::freeSlot(UInt32 index)
+{
+    Slot& slot   = m_slots[index];
+    slot.m_timer = NULL;
+    slot.m_armed = false;
+    ++slot.m_generation;
+    slot.m_next  = m_free;
+    m_free       = index;
+}
+
+bool
+TimerHeap::isLive(const Entry& entry) const
+{
+    const Slot& slot = m_slots[entry.m_slot];
+    return (slot.m_timer != NULL && slot.m_armed &&
+                            slot.m_generation == entry.m_generation);
+}
+
+void
+TimerHeap::push(UInt32 index)
+{
+    Slot& slot   = m_slots[index];
+    slot.m_armed = true;
+    Entry entry  = { slot.m_deadline, index, slot.m_generation };
+    m_queue.push(entry);
+}
+
+void
+TimerHeap::prune()
+{
+    while (!m_queue.empty()) {
+        const Entry& top = m_queue.top();
+        if (!isLive(top)) {
+            m_queue.pop();
+        }
+        else if (top.m_deadline < m_slots[top.m_slot].m_deadline) {
+            // the deadline was pushed back since the entry was added
+            UInt32 index = top.m_slot;
+            m_queue.pop();
+            push(index);
+        }
+        else {
+            break;
+        }
+    }
+}
+
+void
+TimerHeap::compact()
+{
+    // don't let entries of removed or rearmed timers pile up
+    if (m_queue.size() > 2 * m_index.size() + 32) {
+        std::vector<Entry> entries;
+        entries.reserve(m_index.size());
+        for (const Entry& entry : m_queue) {
+            if (isLive(entry)) {
+                entries.push_back(entry);
+            }
+        }
+        m_queue.swap(entries);
+        prune();
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/IEventQueue.h"
+#include "base/PriorityQueue.h"
+#include "common/stdvector.h"
+
+#include <unordered_map>
+
+//! Event queue timers by deadline
+/*!
+Keeps each timer's absolute deadline and a min-heap of deadlines, so
+finding the next timer to expire doesn't touch the others.  Removing
+a timer only marks it removed and its heap entry is dropped when it
+reaches the top, so removing is O(1) unless it was the next timer.
+Likewise pushing a deadline back only changes the timer, unless it was
+the next timer, and its entry is moved when it reaches the top.
+
+Times are seconds on any clock that only goes forward, passed in by
+the caller.  This isn't thread safe.
+*/
+class TimerHeap {
+public:
+    TimerHeap();
+    TimerHeap(TimerHeap const &) =delete;
+    TimerHeap(TimerHeap &&) =delete;
+    ~TimerHeap();
+
+    TimerHeap& operator=(TimerHeap const &) =delete;
+    TimerHeap& operator=(TimerHeap &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Add a timer
+    /*!
+    Adds \c timer, which expires \c timeout seconds after \c now with
+    events for \c target.  A timer that isn't \c oneShot expires again
+    \c timeout seconds after each time it expires.
+    */
+    void                add(EventQueueTimer* timer, void* target,
+                            double timeout, bool oneShot, double now);
+
+    //! Remove a timer
+    /*!
+    Removes \c timer.  Returns false if it wasn't added or has already
+    been removed.
+    */
+    bool                remove(EventQueueTimer* timer);
+
+    //! Restart a timer
+    /*!
+    Makes \c timer expire \c timeout seconds after \c now, and every
+    \c timeout seconds after that if it isn't a one-shot.  A one-shot
+    that already expired is armed again.  Moving a timer's deadline
+    later doesn't touch the heap unless it was the next timer.  Returns
+    false if \c timer wasn't added.
+    */
+    bool                rearm(EventQueueTimer* timer, double timeout, double now);
+
+    //! Take an expired timer
+    /*!
+    If a timer has expired by \c now, fills in \c event and \c target
+    for it and returns true.  One-shot timers are disarmed until they're
+    rearmed or removed and others start over from \c now.
+    */
+    bool                popExpired(double now, IEventQueue::TimerEvent& event,
+                            void*& target);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get the time until the next timer expires
+    /*!
+    Returns the seconds from \c now until the next timer expires, 0 if
+    one already has, or -1 if there are no timers.
+    */
+    double              getNextTimeout(double now) const;
+
+    //! Get the number of timers, armed or not
+    size_t              size() const { return m_index.size(); }
+
+    //@}
+
+private:
+    struct Slot {
+        EventQueueTimer*    m_timer;
+        void*               m_target;
+        double              m_timeout;
+        double              m_deadline;
+        bool                m_oneShot;
+        bool                m_armed;
+
+        // changes when the slot's heap entry is no longer valid.  a
+        // live entry's deadline is never after the slot's.
+        UInt32              m_generation;
+        UInt32              m_next;
+    };
+
+    struct Entry {
+        double              m_deadline;
+        UInt32              m_slot;
+        UInt32              m_generation;
+
+        bool                operator>(const Entry& e) const { return m_deadline > e.m_deadline; }
+    };
+
+    typedef PriorityQueue<Entry> EntryQueue;
+
+    UInt32              allocateSlot();
+    void                freeSlot(UInt32 slot);
+    bool                isLive(const Entry& entry) const;
+    void                push(UInt32 slot);
+    void                prune();
+    void                compact();
+
+private:
+    std::vector<Slot>   m_slots;
+    UInt32              m_free;
+    std::unordered_map<EventQueueTimer*, UInt32> m_index;
+
+    // may hold entries that are no longer valid or are early but the
+    // top entry is always a timer's current deadline
+    EntryQueue          m_queue;
+};
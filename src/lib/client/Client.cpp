@@ -34,6 +34,8 @@
 #include "net/IDataSocket.h"
 #include "net/ISocketFactory.h"
 #include "net/SecureSocket.h"
+#include "net/HostResolver.h"
+#include "net/ParallelConnector.h"
 #include "arch/Arch.h"
 #include "base/Log.h"
 #include "base/IEventQueue.h"
@@ -83,6 +85,13 @@ Client::Client(
     assert(m_socketFactory != NULL);
     assert(m_screen        != NULL);
 
+    // look up the server in the background
+    m_resolver = new HostResolver(m_events);
+    m_events->adoptHandler(m_events->forHostResolver().resolved(),
+                            m_resolver->getEventTarget(),
+                            new TMethodEventJob<Client>(this,
+                                &Client::handleResolved));
+
     // register suspend/resume event handlers
     m_events->adoptHandler(m_events->forIScreen().suspend(),
                             getEventTarget(),
@@ -121,12 +130,16 @@ Client::~Client()
     cleanupConnecting();
     cleanupConnection();
     delete m_socketFactory;
+
+    m_events->removeHandler(m_events->forHostResolver().resolved(),
+                              m_resolver->getEventTarget());
+    delete m_resolver;
 }
 
 void
 Client::connect(size_t addressIndex)
 {
-    if (m_stream != NULL) {
+    if (m_stream != NULL || m_connector != NULL) {
         return;
     }
     if (m_suspended) {
@@ -139,8 +152,19 @@ Client::connect(size_t addressIndex)
         // in case we couldn't resolve the address earlier or the address
         // has changed (which can happen frequently if this is a laptop
         // being shuttled between various networks).  patch by Brent
-        // Priddy.
-        m_resolvedAddressesCount = m_serverAddress.resolve(addressIndex);
+        // Priddy.  the resolver answers from its cache and refreshes
+        // in the background so a slow name server can't stall us.  if
+        // it has nothing yet then try again once the lookup is done.
+        size_t count = m_resolver->resolve(m_serverAddress, addressIndex);
+        if (count == 0) {
+            LOG((CLOG_DEBUG1 "waiting for '%s' to resolve",
+                            m_serverAddress.getHostname().c_str()));
+            m_resolving             = true;
+            m_resolvingAddressIndex = addressIndex;
+            return;
+        }
+        m_resolving              = false;
+        m_resolvedAddressesCount = count;
         
         // m_serverAddress will be null if the hostname address is not reolved
         if (m_serverAddress.getAddress() != nullptr) {
@@ -151,19 +175,23 @@ Client::connect(size_t addressIndex)
           m_serverAddress.getPort()));
         }
 
-        // create the socket
-        IDataSocket* socket = m_socketFactory->create(m_useSecureNetwork, ARCH->getAddrFamily(m_serverAddress.getAddress()));
-        m_socket = dynamic_cast<TCPSocket*>(socket);
-
-        // filter socket messages, including a packetizing filter
-        m_stream = socket;
-        m_stream = new PacketStreamFilter(m_events, m_stream, true);
+        // try all of the server's addresses, starting with the one
+        // asked for, and keep whichever connects first.  an address
+        // that doesn't answer then can't hold up the others.
+        std::vector<NetworkAddress> addresses;
+        for (size_t i = 0; i < count; ++i) {
+            NetworkAddress address(m_serverAddress);
+            m_resolver->resolve(address, (addressIndex + i) % count);
+            addresses.push_back(address);
+        }
 
         // connect
         LOG((CLOG_DEBUG1 "connecting to server"));
+        m_connector = new ParallelConnector(m_events, m_socketFactory,
+                            m_useSecureNetwork);
         setupConnecting();
         setupTimer();
-        socket->connect(m_serverAddress);
+        m_connector->connect(addresses);
     }
     catch (XBase& e) {
         cleanupTimer();
@@ -472,25 +500,21 @@ Client::sendFileChunk(const void* data)
 void
 Client::setupConnecting()
 {
-    assert(m_stream != NULL);
+    assert(m_connector != NULL);
 
-    if (m_args.m_enableCrypto) {
-        m_events->adoptHandler(m_events->forIDataSocket().secureConnected(),
-                    m_stream->getEventTarget(),
-                        new TMethodEventJob<Client>(this,
-                                &Client::handleConnected));
-    }
-    else {
-        m_events->adoptHandler(m_events->forIDataSocket().connected(),
-                    m_stream->getEventTarget(),
-                        new TMethodEventJob<Client>(this,
+    // the connector waits for the handshake on secure sockets
+    m_events->adoptHandler(m_events->forIDataSocket().connected(),
+                            m_connector->getEventTarget(),
+                            new TMethodEventJob<Client>(this,
                                 &Client::handleConnected));
-    }
-
     m_events->adoptHandler(m_events->forIDataSocket().connectionFailed(),
-                            m_stream->getEventTarget(),
+                            m_connector->getEventTarget(),
                             new TMethodEventJob<Client>(this,
                                 &Client::handleConnectionFailed));
+    m_events->adoptHandler(m_events->forISocket().stopRetry(),
+                            m_connector->getEventTarget(),
+                            new TMethodEventJob<Client>(this,
+                                &Client::handleStopRetry));
 }
 
 void
@@ -556,6 +580,7 @@ void
 Client::cleanup()
 {
     m_connectOnResume = false;
+    m_resolving       = false;
     cleanupTimer();
     cleanupScreen();
     cleanupConnecting();
@@ -565,11 +590,15 @@ Client::cleanup()
 void
 Client::cleanupConnecting()
 {
-    if (m_stream != NULL) {
+    if (m_connector != NULL) {
         m_events->removeHandler(m_events->forIDataSocket().connected(),
-                            m_stream->getEventTarget());
+                            m_connector->getEventTarget());
         m_events->removeHandler(m_events->forIDataSocket().connectionFailed(),
-                            m_stream->getEventTarget());
+                            m_connector->getEventTarget());
+        m_events->removeHandler(m_events->forISocket().stopRetry(),
+                            m_connector->getEventTarget());
+        delete m_connector;
+        m_connector = NULL;
     }
 }
 
@@ -631,6 +660,13 @@ void
 Client::handleConnected(const Event&, void*)
 {
     LOG((CLOG_DEBUG1 "connected;  wait for hello"));
+
+    // filter socket messages, including a packetizing filter
+    IDataSocket* socket = m_connector->takeSocket();
+    m_socket            = dynamic_cast<TCPSocket*>(socket);
+    m_stream            = new PacketStreamFilter(m_events, socket, true);
+    m_serverAddress     = m_connector->getAddress();
+
     cleanupConnecting();
     setupConnection();
 
@@ -667,6 +703,17 @@ Client::handleConnectTimeout(const Event&, void*)
     sendConnectionFailedEvent("Timed out");
 }
 
+void
+Client::handleResolved(const Event&, void*)
+{
+    // the lookup may have been for an earlier attempt that was since
+    // abandoned
+    if (m_resolving) {
+        m_resolving = false;
+        connect(m_resolvingAddressIndex);
+    }
+}
+
 void
 Client::handleOutputError(const Event&, void*)
 {
@@ -723,8 +770,9 @@ bool
 Client::isCompatible(int major, int minor) const
 {
     const std::map< int, std::set<int> > compatibleTable {
-        {6, {7, 8}}, //1.6 is compatible with 1.7 and 1.8
-        {7, {8}} //1.7 is compatible with 1.8
+        {6, {7, 8, 9}}, //1.6 is compatible with 1.7, 1.8 and 1.9
+        {7, {8, 9}}, //1.7 is compatible with 1.8 and 1.9
+        {8, {9}} //1.8 is compatible with 1.9
     };
 
     bool isCompatible = false;
@@ -771,7 +819,7 @@ Client::handleHello(const Event&, void*)
 
     // say hello back
     LOG((CLOG_DEBUG1 "say hello version %d.%d", helloBackMajor, helloBackMinor));
-    ProtocolUtil::writef(m_stream, kMsgHelloBack, helloBackMajor, helloBackMinor, &m_name);
+    ProtocolUtil::writeMessage<synergy::protocol::HelloBack>(m_stream, helloBackMajor, helloBackMinor, m_name);
 
     // now connected but waiting to complete handshake
     setupScreen();
@@ -815,6 +863,7 @@ void
 Client::handleFileChunkSending(const Event& event, void*)
 {
     sendFileChunk(event.getDataObject());
+    StreamChunker::fileChunkSent();
 }
 
 void
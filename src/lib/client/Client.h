@@ -38,6 +38,8 @@ namespace synergy { class IStream; }
 class IEventQueue;
 class Thread;
 class TCPSocket;
+class HostResolver;
+class ParallelConnector;
 
 //! Synergy client
 /*!
@@ -74,7 +76,9 @@ public:
     //! Connect to server
     /*!
     Starts an attempt to connect to the server.  This is ignored if
-    the client is trying to connect or is already connected.
+    the client is trying to connect or is already connected.  All of
+    the server's addresses are tried at once, with the one at
+    \c addressIndex given a head start.
     */
     void                connect(size_t addressIndex = 0);
 
@@ -197,6 +201,7 @@ private:
     void                handleConnected(const Event&, void*);
     void                handleConnectionFailed(const Event&, void*);
     void                handleConnectTimeout(const Event&, void*);
+    void                handleResolved(const Event&, void*);
     void                handleOutputError(const Event&, void*);
     void                handleDisconnected(const Event&, void*);
     void                handleShapeChanged(const Event&, void*);
@@ -244,4 +249,8 @@ private:
     size_t              m_maximumClipboardSize;
     lib::synergy::ClientArgs          m_args;
     size_t              m_resolvedAddressesCount = 0;
+    HostResolver*       m_resolver = nullptr;
+    ParallelConnector*  m_connector = nullptr;
+    bool                m_resolving = false;
+    size_t              m_resolvingAddressIndex = 0;
 };
@@ -37,6 +37,12 @@
 #include <algorithm>
 #include <cstring>
 
+// output limits for the server link.  the clipboard and file senders
+// hold back while it's congested.  there's no hard limit since dropping
+// the server is worse than buffering.
+static const UInt32 s_outputLowWater  = 256 * 1024;
+static const UInt32 s_outputHighWater = 1024 * 1024;
+
 //
 // ServerProxy
 //
@@ -51,15 +57,22 @@ ServerProxy::ServerProxy(Client* client, synergy::IStream* stream, IEventQueue*
     m_yMouse(0),
     m_dxMouse(0),
     m_dyMouse(0),
+    m_xMouseBase(0),
+    m_yMouseBase(0),
     m_ignoreMouse(false),
     m_keepAliveAlarm(0.0),
     m_keepAliveAlarmTimer(NULL),
     m_parser(&ServerProxy::parseHandshakeMessage),
-    m_events(events)
+    m_events(events),
+    m_filePaused(false)
 {
     assert(m_client != NULL);
     assert(m_stream != NULL);
 
+    m_stream->setOutputLimits(s_outputLowWater, s_outputHighWater, 0);
+
+    addMessageHandlers();
+
     // initialize modifier translation table
     for (KeyModifierID id = 0; id < kKeyModifierIDLast; ++id)
         m_modifierTranslationTable[id] = id;
@@ -70,10 +83,10 @@ ServerProxy::ServerProxy(Client* client, synergy::IStream* stream, IEventQueue*
                             new TMethodEventJob<ServerProxy>(this,
                                 &ServerProxy::handleData));
 
-    m_events->adoptHandler(m_events->forClipboard().clipboardSending(),
-                            this,
+    m_events->adoptHandler(m_events->forIStream().outputDrained(),
+                            m_stream->getEventTarget(),
                             new TMethodEventJob<ServerProxy>(this,
-                                &ServerProxy::handleClipboardSendingEvent));
+                                &ServerProxy::handleOutputDrained));
 
     // send heartbeat
     setKeepAliveRate(kKeepAliveRate);
@@ -84,11 +97,23 @@ ServerProxy::~ServerProxy()
     setKeepAliveRate(-1.0);
     m_events->removeHandler(m_events->forIStream().inputReady(),
                             m_stream->getEventTarget());
+    m_events->removeHandler(m_events->forIStream().outputDrained(),
+                            m_stream->getEventTarget());
+    if (m_filePaused) {
+        StreamChunker::resumeFile();
+    }
 }
 
 void
 ServerProxy::resetKeepAliveAlarm()
 {
+    // this happens for every keep alive so restart the timer rather
+    // than replacing it
+    if (m_keepAliveAlarmTimer != NULL && m_keepAliveAlarm > 0.0) {
+        m_events->rearmTimer(m_keepAliveAlarmTimer, m_keepAliveAlarm);
+        return;
+    }
+
     if (m_keepAliveAlarmTimer != NULL) {
         m_events->removeHandler(Event::kTimer, m_keepAliveAlarmTimer);
         m_events->deleteTimer(m_keepAliveAlarmTimer);
@@ -148,207 +173,141 @@ ServerProxy::handleData(const Event&, void*)
     flushCompressedMouse();
 }
 
-ServerProxy::EResult
-ServerProxy::parseHandshakeMessage(const UInt8* code)
+void
+ServerProxy::addMessageHandlers()
 {
-    if (memcmp(code, kMsgQInfo, 4) == 0) {
-        queryInfo();
-    }
-
-    else if (memcmp(code, kMsgCInfoAck, 4) == 0) {
-        infoAcknowledgment();
-    }
-
-    else if (memcmp(code, kMsgDSetOptions, 4) == 0) {
-        setOptions();
-
-        // handshake is complete
-        m_parser = &ServerProxy::parseMessage;
-        checkMissedLanguages();
-        m_client->handshakeComplete();
-    }
-
-    else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
-        resetOptions();
-    }
-
-    else if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
+    auto keepAlive = [this] {
         // echo keep alives and reset alarm
-        ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
+        ProtocolUtil::writeMessage<synergy::protocol::CKeepAlive>(m_stream);
         resetKeepAliveAlarm();
-    }
-
-    else if (memcmp(code, kMsgCNoop, 4) == 0) {
+        return kOkay;
+    };
+    auto noop = [] {
         // accept and discard no-op
-    }
-
-    else if (memcmp(code, kMsgCClose, 4) == 0) {
+        return kOkay;
+    };
+    auto close = [this] {
         // server wants us to hangup
         LOG((CLOG_DEBUG1 "recv close"));
         m_client->disconnect(NULL);
         return kDisconnect;
-    }
+    };
 
-    else if (memcmp(code, kMsgEIncompatible, 4) == 0) {
+    // messages before the server has sent the options
+    m_handshakeMessages.add(kMsgQInfo, [this] { queryInfo(); return kOkay; });
+    m_handshakeMessages.add(kMsgCInfoAck, [this] { infoAcknowledgment(); return kOkay; });
+    m_handshakeMessages.add(kMsgDSetOptions, [this] {
+        setOptions();
+
+        // handshake is complete
+        m_parser = &ServerProxy::parseMessage;
+        checkMissedLanguages();
+        m_client->handshakeComplete();
+        return kOkay;
+    });
+    m_handshakeMessages.add(kMsgCResetOptions, [this] { resetOptions(); return kOkay; });
+    m_handshakeMessages.add(kMsgCKeepAlive, keepAlive);
+    m_handshakeMessages.add(kMsgCNoop, noop);
+    m_handshakeMessages.add(kMsgCClose, close);
+    m_handshakeMessages.add(kMsgEIncompatible, [this] {
         SInt32 major, minor;
-        ProtocolUtil::readf(m_stream,
-                        kMsgEIncompatible + 4, &major, &minor);
+        ProtocolUtil::readMessage<synergy::protocol::EIncompatible>(m_stream, major, minor);
         LOG((CLOG_ERR "server has incompatible version %d.%d", major, minor));
         m_client->refuseConnection("server has incompatible version");
         return kDisconnect;
-    }
-
-    else if (memcmp(code, kMsgEBusy, 4) == 0) {
+    });
+    m_handshakeMessages.add(kMsgEBusy, [this] {
         LOG((CLOG_ERR "server already has a connected client with name \"%s\"", m_client->getName().c_str()));
         m_client->refuseConnection("server already has a connected client with our name");
         return kDisconnect;
-    }
-
-    else if (memcmp(code, kMsgEUnknown, 4) == 0) {
+    });
+    m_handshakeMessages.add(kMsgEUnknown, [this] {
         LOG((CLOG_ERR "server refused client with name \"%s\"", m_client->getName().c_str()));
         m_client->refuseConnection("server refused client with our name");
         return kDisconnect;
-    }
-
-    else if (memcmp(code, kMsgEBad, 4) == 0) {
+    });
+    m_handshakeMessages.add(kMsgEBad, [this] {
         LOG((CLOG_ERR "server disconnected due to a protocol error"));
         m_client->refuseConnection("server reported a protocol error");
         return kDisconnect;
-    }
-    else if (memcmp(code, kMsgDLanguageSynchronisation, 4) == 0) {
-        setServerLanguages();
-    }
-    else {
-        return kUnknown;
-    }
-
-    return kOkay;
-}
-
-ServerProxy::EResult
-ServerProxy::parseMessage(const UInt8* code)
-{
-    if (memcmp(code, kMsgDMouseMove, 4) == 0) {
-        mouseMove();
-    }
-
-    else if (memcmp(code, kMsgDMouseRelMove, 4) == 0) {
-        mouseRelativeMove();
-    }
-
-    else if (memcmp(code, kMsgDMouseWheel, 4) == 0) {
-        mouseWheel();
-    }
-
-    else if (memcmp(code, kMsgDKeyDown, 4) == 0) {
+    });
+    m_handshakeMessages.add(kMsgDLanguageSynchronisation, [this] { setServerLanguages(); return kOkay; });
+
+    // messages after the handshake
+    m_messages.add(kMsgDMouseMove, [this] { mouseMove(); return kOkay; });
+    m_messages.add(kMsgDMouseDelta, [this] { mouseDelta(); return kOkay; });
+    m_messages.add(kMsgDMouseRelMove, [this] { mouseRelativeMove(); return kOkay; });
+    m_messages.add(kMsgDMouseWheel, [this] { mouseWheel(); return kOkay; });
+    m_messages.add(kMsgDKeyDown, [this] {
         UInt16 id = 0;
         UInt16 mask = 0;
         UInt16 button = 0;
-        ProtocolUtil::readf(m_stream, kMsgDKeyDown + 4, &id, &mask, &button);
+        ProtocolUtil::readMessage<synergy::protocol::DKeyDown>(m_stream, id, mask, button);
         LOG((CLOG_DEBUG1 "recv key down id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button));
 
         keyDown(id, mask, button, "");
-    }
-
-    else if (memcmp(code, kMsgDKeyDownLang, 4) == 0) {
+        return kOkay;
+    });
+    m_messages.add(kMsgDKeyDownLang, [this] {
         String lang;
         UInt16 id = 0;
         UInt16 mask = 0;
         UInt16 button = 0;
 
-        ProtocolUtil::readf(m_stream, kMsgDKeyDownLang + 4, &id, &mask, &button, &lang);
+        ProtocolUtil::readMessage<synergy::protocol::DKeyDownLang>(m_stream, id, mask, button, lang);
         LOG((CLOG_DEBUG1 "recv key down id=0x%08x, mask=0x%04x, button=0x%04x, lang=\"%s\"", id, mask, button, lang.c_str()));
 
         keyDown(id, mask, button, lang);
-    }
-
-    else if (memcmp(code, kMsgDKeyUp, 4) == 0) {
-        keyUp();
-    }
-
-    else if (memcmp(code, kMsgDMouseDown, 4) == 0) {
-        mouseDown();
-    }
-
-    else if (memcmp(code, kMsgDMouseUp, 4) == 0) {
-        mouseUp();
-    }
-
-    else if (memcmp(code, kMsgDKeyRepeat, 4) == 0) {
-        keyRepeat();
-    }
-
-    else if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-        // echo keep alives and reset alarm
-        ProtocolUtil::writef(m_stream, kMsgCKeepAlive);
-        resetKeepAliveAlarm();
-    }
-
-    else if (memcmp(code, kMsgCNoop, 4) == 0) {
-        // accept and discard no-op
-    }
-
-    else if (memcmp(code, kMsgCEnter, 4) == 0) {
-        enter();
-    }
-
-    else if (memcmp(code, kMsgCLeave, 4) == 0) {
-        leave();
-    }
-
-    else if (memcmp(code, kMsgCClipboard, 4) == 0) {
-        grabClipboard();
-    }
-
-    else if (memcmp(code, kMsgCScreenSaver, 4) == 0) {
-        screensaver();
-    }
-
-    else if (memcmp(code, kMsgQInfo, 4) == 0) {
-        queryInfo();
-    }
-
-    else if (memcmp(code, kMsgCInfoAck, 4) == 0) {
-        infoAcknowledgment();
-    }
-
-    else if (memcmp(code, kMsgDClipboard, 4) == 0) {
-        setClipboard();
-    }
-
-    else if (memcmp(code, kMsgCResetOptions, 4) == 0) {
-        resetOptions();
-    }
-
-    else if (memcmp(code, kMsgDSetOptions, 4) == 0) {
-        setOptions();
-    }
-
-    else if (memcmp(code, kMsgDFileTransfer, 4) == 0) {
-        fileChunkReceived();
-    }
-    else if (memcmp(code, kMsgDDragInfo, 4) == 0) {
-        dragInfoReceived();
-    }
-    else if (memcmp(code, kMsgDSecureInputNotification, 4) == 0) {
-        secureInputNotification();
-    }
-
-    else if (memcmp(code, kMsgCClose, 4) == 0) {
-        // server wants us to hangup
-        LOG((CLOG_DEBUG1 "recv close"));
-        m_client->disconnect(NULL);
-        return kDisconnect;
-    }
-    else if (memcmp(code, kMsgEBad, 4) == 0) {
+        return kOkay;
+    });
+    m_messages.add(kMsgDKeyUp, [this] { keyUp(); return kOkay; });
+    m_messages.add(kMsgDMouseDown, [this] { mouseDown(); return kOkay; });
+    m_messages.add(kMsgDMouseUp, [this] { mouseUp(); return kOkay; });
+    m_messages.add(kMsgDKeyRepeat, [this] { keyRepeat(); return kOkay; });
+    m_messages.add(kMsgCKeepAlive, keepAlive);
+    m_messages.add(kMsgCNoop, noop);
+    m_messages.add(kMsgCEnter, [this] { enter(); return kOkay; });
+    m_messages.add(kMsgCLeave, [this] { leave(); return kOkay; });
+    m_messages.add(kMsgCClipboard, [this] { grabClipboard(); return kOkay; });
+    m_messages.add(kMsgCScreenSaver, [this] { screensaver(); return kOkay; });
+    m_messages.add(kMsgQInfo, [this] { queryInfo(); return kOkay; });
+    m_messages.add(kMsgCInfoAck, [this] { infoAcknowledgment(); return kOkay; });
+    m_messages.add(kMsgDClipboard, [this] { setClipboard(); return kOkay; });
+    m_messages.add(kMsgCResetOptions, [this] { resetOptions(); return kOkay; });
+    m_messages.add(kMsgDSetOptions, [this] { setOptions(); return kOkay; });
+    m_messages.add(kMsgDFileTransfer, [this] { fileChunkReceived(); return kOkay; });
+    m_messages.add(kMsgDDragInfo, [this] { dragInfoReceived(); return kOkay; });
+    m_messages.add(kMsgDSecureInputNotification, [this] { secureInputNotification(); return kOkay; });
+    m_messages.add(kMsgCClose, close);
+    m_messages.add(kMsgEBad, [this] {
         LOG((CLOG_ERR "server disconnected due to a protocol error"));
         m_client->disconnect("server reported a protocol error");
         return kDisconnect;
+    });
+}
+
+ServerProxy::EResult
+ServerProxy::parseHandshakeMessage(const UInt8* code)
+{
+    const MessageHandler* handler = m_handshakeMessages.find(code);
+    if (handler == NULL) {
+        return kUnknown;
     }
-    else {
+    return (*handler)();
+}
+
+ServerProxy::EResult
+ServerProxy::parseMessage(const UInt8* code)
+{
+    const MessageHandler* handler = m_messages.find(code);
+    if (handler == NULL) {
         return kUnknown;
     }
 
+    EResult result = (*handler)();
+    if (result != kOkay) {
+        return result;
+    }
     // send a reply.  this is intended to work around a delay when
     // running a linux server and an OS X (any BSD?) client.  the
     // client waits to send an ACK (if the system control flag
@@ -356,7 +315,7 @@ ServerProxy::parseMessage(const UInt8* code)
     // on a data packet.  we provide that packet here.  i don't
     // know why a delayed ACK should cause the server to wait since
     // TCP_NODELAY is enabled.
-    ProtocolUtil::writef(m_stream, kMsgCNoop);
+    ProtocolUtil::writeMessage<synergy::protocol::CNoop>(m_stream);
 
     return kOkay;
 }
@@ -383,7 +342,7 @@ bool
 ServerProxy::onGrabClipboard(ClipboardID id)
 {
     LOG((CLOG_DEBUG1 "sending clipboard %d changed", id));
-    ProtocolUtil::writef(m_stream, kMsgCClipboard, id, m_seqNum);
+    ProtocolUtil::writeMessage<synergy::protocol::CClipboard>(m_stream, id, m_seqNum);
     return true;
 }
 
@@ -393,7 +352,66 @@ ServerProxy::onClipboardChanged(ClipboardID id, const IClipboard* clipboard)
     String data = IClipboard::marshall(clipboard);
     LOG((CLOG_DEBUG "sending clipboard %d seqnum=%d", id, m_seqNum));
 
-    StreamChunker::sendClipboard(data, data.size(), id, m_seqNum, m_events, this);
+    // a send of this clipboard that hasn't started yet is stale
+    bool queued = false;
+    for (ClipboardSend& send : m_clipboardSends) {
+        if (send.m_id == id && !send.m_started) {
+            send.m_sequence = m_seqNum;
+            send.m_data     = data;
+            queued          = true;
+        }
+    }
+    if (!queued) {
+        m_clipboardSends.push_back(ClipboardSend(id, m_seqNum, data));
+    }
+
+    sendClipboardChunks();
+}
+
+void
+ServerProxy::sendClipboardChunks()
+{
+    // send chunks until the server stops keeping up.  the rest are sent
+    // when the output drains.
+    while (!m_clipboardSends.empty() && !m_stream->isCongested()) {
+        ClipboardSend& send = m_clipboardSends.front();
+        size_t size = send.m_data.size();
+
+        ClipboardChunk* chunk;
+        if (!send.m_started) {
+            // first message is the data size
+            send.m_started = true;
+            String dataSize = synergy::string::sizeTypeToString(size);
+            chunk = ClipboardChunk::start(send.m_id, send.m_sequence, dataSize);
+        }
+        else if (send.m_sent < size) {
+            size_t chunkSize = StreamChunker::getChunkSize();
+            if (chunkSize > size - send.m_sent) {
+                chunkSize = size - send.m_sent;
+            }
+            chunk = ClipboardChunk::data(send.m_id, send.m_sequence,
+                            send.m_data.substr(send.m_sent, chunkSize));
+            send.m_sent += chunkSize;
+        }
+        else {
+            chunk = ClipboardChunk::end(send.m_id, send.m_sequence);
+            LOG((CLOG_DEBUG "sent clipboard size=%d", static_cast<int>(send.m_sent)));
+            m_clipboardSends.pop_front();
+        }
+
+        ClipboardChunk::send(m_stream, chunk);
+        delete chunk;
+    }
+}
+
+void
+ServerProxy::handleOutputDrained(const Event&, void*)
+{
+    if (m_filePaused) {
+        m_filePaused = false;
+        StreamChunker::resumeFile();
+    }
+    sendClipboardChunks();
 }
 
 void
@@ -415,7 +433,7 @@ void
 ServerProxy::sendInfo(const ClientInfo& info)
 {
     LOG((CLOG_DEBUG1 "sending info shape=%d,%d %dx%d", info.m_x, info.m_y, info.m_w, info.m_h));
-    ProtocolUtil::writef(m_stream, kMsgDInfo,
+    ProtocolUtil::writeMessage<synergy::protocol::DInfo>(m_stream,
                                 info.m_x, info.m_y,
                                 info.m_w, info.m_h, 0,
                                 info.m_mx, info.m_my);
@@ -548,7 +566,7 @@ ServerProxy::enter()
     SInt16 x, y;
     UInt16 mask;
     UInt32 seqNum;
-    ProtocolUtil::readf(m_stream, kMsgCEnter + 4, &x, &y, &seqNum, &mask);
+    ProtocolUtil::readMessage<synergy::protocol::CEnter>(m_stream, x, y, seqNum, mask);
     LOG((CLOG_DEBUG1 "recv enter, %d,%d %d %04x", x, y, seqNum, mask));
 
     // discard old compressed mouse motion, if any
@@ -556,6 +574,8 @@ ServerProxy::enter()
     m_compressMouseRelative                = false;
     m_dxMouse                              = 0;
     m_dyMouse                              = 0;
+    m_xMouseBase                           = x;
+    m_yMouseBase                           = y;
     m_seqNum                               = seqNum;
     m_serverLanguage                       = "";
     m_isUserNotifiedAboutLanguageSyncError = false;
@@ -609,7 +629,7 @@ ServerProxy::grabClipboard()
     // parse
     ClipboardID id;
     UInt32 seqNum;
-    ProtocolUtil::readf(m_stream, kMsgCClipboard + 4, &id, &seqNum);
+    ProtocolUtil::readMessage<synergy::protocol::CClipboard>(m_stream, id, seqNum);
     LOG((CLOG_DEBUG "recv grab clipboard %d", id));
 
     // validate
@@ -649,8 +669,8 @@ ServerProxy::keyRepeat()
     // parse
     UInt16 id, mask, count, button;
     String lang;
-    ProtocolUtil::readf(m_stream, kMsgDKeyRepeat + 4,
-                                &id, &mask, &count, &button, &lang);
+    ProtocolUtil::readMessage<synergy::protocol::DKeyRepeat>(m_stream,
+                                id, mask, count, button, lang);
     LOG((CLOG_DEBUG1 "recv key repeat id=0x%08x, mask=0x%04x, count=%d, button=0x%04x, lang=\"%s\"", id, mask, count, button, lang.c_str()));
 
     // translate
@@ -673,7 +693,7 @@ ServerProxy::keyUp()
 
     // parse
     UInt16 id, mask, button;
-    ProtocolUtil::readf(m_stream, kMsgDKeyUp + 4, &id, &mask, &button);
+    ProtocolUtil::readMessage<synergy::protocol::DKeyUp>(m_stream, id, mask, button);
     LOG((CLOG_DEBUG1 "recv key up id=0x%08x, mask=0x%04x, button=0x%04x", id, mask, button));
 
     // translate
@@ -696,7 +716,7 @@ ServerProxy::mouseDown()
 
     // parse
     SInt8 id;
-    ProtocolUtil::readf(m_stream, kMsgDMouseDown + 4, &id);
+    ProtocolUtil::readMessage<synergy::protocol::DMouseDown>(m_stream, id);
     LOG((CLOG_DEBUG1 "recv mouse down id=%d", id));
 
     // forward
@@ -711,7 +731,7 @@ ServerProxy::mouseUp()
 
     // parse
     SInt8 id;
-    ProtocolUtil::readf(m_stream, kMsgDMouseUp + 4, &id);
+    ProtocolUtil::readMessage<synergy::protocol::DMouseUp>(m_stream, id);
     LOG((CLOG_DEBUG1 "recv mouse up id=%d", id));
 
     // forward
@@ -722,12 +742,35 @@ void
 ServerProxy::mouseMove()
 {
     // parse
-    bool ignore;
     SInt16 x, y;
-    ProtocolUtil::readf(m_stream, kMsgDMouseMove + 4, &x, &y);
+    ProtocolUtil::readMessage<synergy::protocol::DMouseMove>(m_stream, x, y);
+    LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
+
+    moveMouse(x, y);
+}
+
+void
+ServerProxy::mouseDelta()
+{
+    // parse
+    SInt32 dx, dy;
+    ProtocolUtil::readMessage<synergy::protocol::DMouseDelta>(m_stream, dx, dy);
+    LOG((CLOG_DEBUG2 "recv mouse delta %+d,%+d", dx, dy));
+
+    // positions are 16 bits on the wire so wrap like the server does
+    moveMouse(static_cast<SInt16>(m_xMouseBase + dx),
+                            static_cast<SInt16>(m_yMouseBase + dy));
+}
+
+void
+ServerProxy::moveMouse(SInt16 x, SInt16 y)
+{
+    // later deltas are from here whether or not the move is ignored
+    m_xMouseBase = x;
+    m_yMouseBase = y;
 
     // note if we should ignore the move
-    ignore = m_ignoreMouse;
+    bool ignore = m_ignoreMouse;
 
     // compress mouse motion events if more input follows
     if (!ignore && !m_compressMouse && m_stream->isReady()) {
@@ -743,7 +786,6 @@ ServerProxy::mouseMove()
         m_dxMouse = 0;
         m_dyMouse = 0;
     }
-    LOG((CLOG_DEBUG2 "recv mouse move %d,%d", x, y));
 
     // forward
     if (!ignore) {
@@ -757,7 +799,7 @@ ServerProxy::mouseRelativeMove()
     // parse
     bool ignore;
     SInt16 dx, dy;
-    ProtocolUtil::readf(m_stream, kMsgDMouseRelMove + 4, &dx, &dy);
+    ProtocolUtil::readMessage<synergy::protocol::DMouseRelMove>(m_stream, dx, dy);
 
     // note if we should ignore the move
     ignore = m_ignoreMouse;
@@ -789,7 +831,7 @@ ServerProxy::mouseWheel()
 
     // parse
     SInt16 xDelta, yDelta;
-    ProtocolUtil::readf(m_stream, kMsgDMouseWheel + 4, &xDelta, &yDelta);
+    ProtocolUtil::readMessage<synergy::protocol::DMouseWheel>(m_stream, xDelta, yDelta);
     LOG((CLOG_DEBUG2 "recv mouse wheel %+d,%+d", xDelta, yDelta));
 
     // forward
@@ -801,7 +843,7 @@ ServerProxy::screensaver()
 {
     // parse
     SInt8 on;
-    ProtocolUtil::readf(m_stream, kMsgCScreenSaver + 4, &on);
+    ProtocolUtil::readMessage<synergy::protocol::CScreenSaver>(m_stream, on);
     LOG((CLOG_DEBUG1 "recv screen saver on=%d", on));
 
     // forward
@@ -831,7 +873,7 @@ ServerProxy::setOptions()
 {
     // parse
     OptionsList options;
-    ProtocolUtil::readf(m_stream, kMsgDSetOptions + 4, &options);
+    ProtocolUtil::readMessage<synergy::protocol::DSetOptions>(m_stream, options);
     LOG((CLOG_DEBUG1 "recv set options size=%d", options.size()));
 
     // forward
@@ -912,35 +954,35 @@ ServerProxy::dragInfoReceived()
     // parse
     UInt32 fileNum = 0;
     String content;
-    ProtocolUtil::readf(m_stream, kMsgDDragInfo + 4, &fileNum, &content);
+    ProtocolUtil::readMessage<synergy::protocol::DDragInfo>(m_stream, fileNum, content);
 
     m_client->dragInfoReceived(fileNum, content);
 }
 
-void
-ServerProxy::handleClipboardSendingEvent(const Event& event, void*)
-{
-    ClipboardChunk::send(m_stream, event.getDataObject());
-}
-
 void
 ServerProxy::fileChunkSending(UInt8 mark, char* data, size_t dataSize)
 {
     FileChunk::send(m_stream, mark, data, dataSize);
+
+    // hold the file thread back until the server catches up
+    if (!m_filePaused && m_stream->isCongested()) {
+        m_filePaused = true;
+        StreamChunker::pauseFile();
+    }
 }
 
 void
 ServerProxy::sendDragInfo(UInt32 fileCount, const char* info, size_t size)
 {
     String data(info, size);
-    ProtocolUtil::writef(m_stream, kMsgDDragInfo, fileCount, &data);
+    ProtocolUtil::writeMessage<synergy::protocol::DDragInfo>(m_stream, fileCount, data);
 }
 
 void
 ServerProxy::secureInputNotification()
 {
     String app;
-    ProtocolUtil::readf(m_stream, kMsgDSecureInputNotification + 4, &app);
+    ProtocolUtil::readMessage<synergy::protocol::DSecureInputNotification>(m_stream, app);
 
     // display this notification on the client
     if (app != "unknown") {
@@ -961,7 +1003,7 @@ void
 ServerProxy::setServerLanguages()
 {
     String serverLanguages;
-    ProtocolUtil::readf(m_stream, kMsgDLanguageSynchronisation + 4, &serverLanguages);
+    ProtocolUtil::readMessage<synergy::protocol::DLanguageSynchronisation>(m_stream, serverLanguages);
     m_languageManager.setRemoteLanguages(serverLanguages);
 }
 
@@ -21,10 +21,14 @@
 #include "synergy/languages/LanguageManager.h"
 #include "synergy/clipboard_types.h"
 #include "synergy/key_types.h"
+#include "synergy/MessageTable.h"
 #include "base/Event.h"
 #include "base/Stopwatch.h"
 #include "base/String.h"
 
+#include <deque>
+#include <functional>
+
 class Client;
 class ClientInfo;
 class EventQueueTimer;
@@ -76,6 +80,9 @@ protected:
     EResult                parseMessage(const UInt8* code);
 
 private:
+    // fill in the message tables
+    void                addMessageHandlers();
+
     // if compressing mouse motion then send the last motion now
     void                flushCompressedMouse();
 
@@ -103,6 +110,7 @@ private:
     void                mouseDown();
     void                mouseUp();
     void                mouseMove();
+    void                mouseDelta();
     void                mouseRelativeMove();
     void                mouseWheel();
     void                screensaver();
@@ -112,14 +120,35 @@ private:
     void                infoAcknowledgment();
     void                fileChunkReceived();
     void                dragInfoReceived();
-    void                handleClipboardSendingEvent(const Event&, void*);
+    void                handleOutputDrained(const Event&, void*);
     void                secureInputNotification();
     void                setServerLanguages();
     void                setActiveServerLanguage(const String& language);
     void                checkMissedLanguages() const;
 
+    void                moveMouse(SInt16 x, SInt16 y);
+
+private:
+    // a clipboard being sent in chunks
+    class ClipboardSend {
+    public:
+        ClipboardSend(ClipboardID id, UInt32 sequence, const String& data) :
+            m_id(id), m_sequence(sequence), m_data(data), m_sent(0),
+            m_started(false) { }
+
+    public:
+        ClipboardID        m_id;
+        UInt32            m_sequence;
+        String            m_data;
+        size_t            m_sent;
+        bool            m_started;
+    };
+
+    void                sendClipboardChunks();
+
 private:
     typedef EResult (ServerProxy::*MessageParser)(const UInt8*);
+    typedef std::function<EResult()> MessageHandler;
 
     Client*            m_client;
     synergy::IStream*    m_stream;
@@ -131,6 +160,9 @@ private:
     SInt32                m_xMouse, m_yMouse;
     SInt32                m_dxMouse, m_dyMouse;
 
+    // position kMsgDMouseDelta is relative to
+    SInt16                m_xMouseBase, m_yMouseBase;
+
     bool                m_ignoreMouse;
 
     KeyModifierID        m_modifierTranslationTable[kKeyModifierIDLast];
@@ -139,8 +171,17 @@ private:
     EventQueueTimer*    m_keepAliveAlarmTimer;
 
     MessageParser        m_parser;
+    MessageTable<MessageHandler> m_handshakeMessages;
+    MessageTable<MessageHandler> m_messages;
     IEventQueue*        m_events;
     String              m_serverLanguage = "";
     bool                m_isUserNotifiedAboutLanguageSyncError = false;
     synergy::languages::LanguageManager m_languageManager;
+
+    // clipboards waiting to be sent, oldest first.  only the front one
+    // is partly sent.
+    std::deque<ClipboardSend>    m_clipboardSends;
+
+    // true while the file send is paused for a congested stream
+    bool                m_filePaused;
 };
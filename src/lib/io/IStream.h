@@ -22,6 +22,7 @@
 #include "base/Event.h"
 #include "base/IEventQueue.h"
 #include "base/EventTypes.h"
+#include "common/stdvector.h"
 
 class IEventQueue;
 
@@ -65,6 +66,45 @@ public:
     */
     virtual void        write(const void* buffer, UInt32 n) = 0;
 
+    //! Write several buffers to stream
+    /*!
+    Write the \c count buffers in \c buffers, of the lengths in
+    \c sizes, as if their concatenation was passed to one \c write().
+    Streams that buffer output should store them in one step.  The
+    default concatenates the buffers and calls \c write().
+    */
+    virtual void        writeVector(const void* const* buffers,
+                            const UInt32* sizes, int count)
+    {
+        if (count == 1) {
+            write(buffers[0], sizes[0]);
+            return;
+        }
+
+        std::vector<UInt8> buffer;
+        for (int i = 0; i < count; ++i) {
+            const UInt8* data = static_cast<const UInt8*>(buffers[i]);
+            buffer.insert(buffer.end(), data, data + sizes[i]);
+        }
+        write(buffer.data(), static_cast<UInt32>(buffer.size()));
+    }
+
+    //! Begin a batch of writes
+    /*!
+    Holds back writes until the matching \c endBatch() so a burst of
+    small writes can be sent together.  Batches nest; only the
+    outermost \c endBatch() sends the data.  \c flush() sends held
+    back data immediately.  The default does nothing.
+    */
+    virtual void        beginBatch() { }
+
+    //! End a batch of writes
+    /*!
+    Ends a batch begun with \c beginBatch(), sending the held back
+    writes if this ends the outermost batch.  The default does nothing.
+    */
+    virtual void        endBatch() { }
+
     //! Flush the stream
     /*!
     Waits until all buffered data has been written to the stream.
@@ -86,6 +126,18 @@ public:
     */
     virtual void        shutdownOutput() = 0;
 
+    //! Set output buffer limits
+    /*!
+    Bounds the output buffered for a consumer that isn't keeping up.
+    An output congested event is sent when the buffered output grows
+    past \p highWater and an output drained event when it falls back
+    to \p lowWater.  If it grows past \p hardLimit the output is
+    discarded and handled as a write error.  Zero disables a limit and
+    streams start with no limits.  The default does nothing.
+    */
+    virtual void        setOutputLimits(UInt32 /*lowWater*/,
+                            UInt32 /*highWater*/, UInt32 /*hardLimit*/) { }
+
     //@}
     //! @name accessors
     //@{
@@ -114,6 +166,25 @@ public:
     */
     virtual UInt32        getSize() const = 0;
 
+    //! Test if output is congested
+    /*!
+    Returns true iff the buffered output has grown past the high water
+    mark and hasn't yet fallen back to the low water mark.  Writers of
+    data that can be dropped or deferred should hold it back while
+    this is true.  The default returns false.
+    */
+    virtual bool        isCongested() const { return false; }
+
+    //! Test for unsent output
+    /*!
+    Returns true if written data is still waiting to be sent.  An
+    output flushed event is sent once it has been.  Writers of data
+    that only the latest value of matters, like the pointer position,
+    can keep just the latest value while this is true.  The default
+    returns false.
+    */
+    virtual bool        hasPendingOutput() const { return false; }
+
     //@}
 };
 
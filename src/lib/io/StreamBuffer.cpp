@@ -19,22 +19,26 @@
 #include "io/StreamBuffer.h"
 #include "common/common.h"
 
+#include <cstring>
+
 //
 // StreamBuffer
 //
 
-const UInt32            StreamBuffer::kChunkSize = 4096;
+const UInt32            StreamBuffer::kChunkSize = 16384;
 
 StreamBuffer::StreamBuffer() :
-    m_size(0),
-    m_headUsed(0)
+    m_tail(0),
+    m_size(0)
 {
     // do nothing
 }
 
 StreamBuffer::~StreamBuffer()
 {
-    // do nothing
+    for (ChunkList::iterator i = m_chunks.begin(); i != m_chunks.end(); ++i) {
+        deleteChunk(*i);
+    }
 }
 
 const void*
@@ -48,48 +52,85 @@ StreamBuffer::peek(UInt32 n)
         return NULL;
     }
 
-    // reserve space in first chunk
-    ChunkList::iterator head = m_chunks.begin();
-    head->reserve(n + m_headUsed);
-
-    // consolidate chunks into the first chunk until it has n bytes
-    ChunkList::iterator scan = head;
-    ++scan;
-    while (head->size() - m_headUsed < n && scan != m_chunks.end()) {
-        head->insert(head->end(), scan->begin(), scan->end());
-        scan = m_chunks.erase(scan);
+    // use the data in place if the head chunk has all of it
+    Chunk& head = m_chunks.front();
+    if (head.m_end - head.m_begin >= n) {
+        return head.m_data + head.m_begin;
     }
 
-    return static_cast<const void*>(&(head->begin()[m_headUsed]));
+    // otherwise copy the bytes into a chunk of their own, drop them from
+    // the chunks they were in, and put the new chunk in front.  the new
+    // chunk is full so it goes before m_tail.
+    Chunk chunk = newChunk(n);
+    UInt32 size = m_size;
+    read(chunk.m_data, n);
+    chunk.m_end = n;
+    m_chunks.push_front(chunk);
+    ++m_tail;
+    m_size = size;
+
+    return chunk.m_data;
+}
+
+void
+StreamBuffer::read(void* vdata, UInt32 n)
+{
+    assert(n <= m_size);
+
+    // copy from each chunk in turn
+    if (vdata != NULL) {
+        UInt8* data = static_cast<UInt8*>(vdata);
+        UInt32 copied = 0;
+        for (ChunkList::iterator i = m_chunks.begin(); copied < n; ++i) {
+            UInt32 count = i->m_end - i->m_begin;
+            if (count > n - copied) {
+                count = n - copied;
+            }
+            memcpy(data + copied, i->m_data + i->m_begin, count);
+            copied += count;
+        }
+    }
+    pop(n);
 }
 
 void
 StreamBuffer::pop(UInt32 n)
 {
-    // discard all chunks if n is greater than or equal to m_size
+    // discard all chunks if n is greater than or equal to m_size.  keep
+    // one ordinary chunk to avoid reallocating when the buffer is used
+    // again.
     if (n >= m_size) {
-        m_size     = 0;
-        m_headUsed = 0;
-        m_chunks.clear();
+        m_size = 0;
+        m_tail = 0;
+        while (!m_chunks.empty() &&
+                (m_chunks.size() > 1 || m_chunks.front().m_capacity != kChunkSize)) {
+            deleteChunk(m_chunks.back());
+            m_chunks.pop_back();
+        }
+        if (!m_chunks.empty()) {
+            m_chunks.front().m_begin = 0;
+            m_chunks.front().m_end   = 0;
+        }
         return;
     }
 
     // update size
     m_size -= n;
 
-    // discard chunks until more than n bytes would've been discarded
-    ChunkList::iterator scan = m_chunks.begin();
-    assert(scan != m_chunks.end());
-    while (scan->size() - m_headUsed <= n) {
-        n         -= (UInt32)scan->size() - m_headUsed;
-        m_headUsed = 0;
-        scan       = m_chunks.erase(scan);
-        assert(scan != m_chunks.end());
-    }
-
-    // remove left over bytes from the head chunk
-    if (n > 0) {
-        m_headUsed += n;
+    // discard chunks until more than n bytes would've been discarded.
+    // there's data left so the tail chunk is never discarded.
+    while (n > 0) {
+        Chunk& head = m_chunks.front();
+        UInt32 count = head.m_end - head.m_begin;
+        if (count > n) {
+            head.m_begin += n;
+            break;
+        }
+        n -= count;
+        assert(m_tail > 0);
+        deleteChunk(head);
+        m_chunks.pop_front();
+        --m_tail;
     }
 }
 
@@ -98,46 +139,44 @@ StreamBuffer::write(const void* vdata, UInt32 n)
 {
     assert(vdata != NULL);
 
-    // ignore if no data, otherwise update size
+    // ignore if no data
     if (n == 0) {
         return;
     }
-    m_size += n;
 
-    // cast data to bytes
-    const UInt8* data = static_cast<const UInt8*>(vdata);
+    append(static_cast<const UInt8*>(vdata), n);
+}
 
-    // point to last chunk if it has space, otherwise append an empty chunk
-    ChunkList::iterator scan = m_chunks.end();
-    if (scan != m_chunks.begin()) {
-        --scan;
-        if (scan->size() >= kChunkSize) {
-            ++scan;
-        }
+int
+StreamBuffer::reserve(UInt32 n, Segment* segments, int count)
+{
+    // add chunks until there's enough free space
+    UInt32 space = 0;
+    for (size_t i = m_tail; i < m_chunks.size(); ++i) {
+        space += m_chunks[i].m_capacity - m_chunks[i].m_end;
     }
-    if (scan == m_chunks.end()) {
-        scan = m_chunks.insert(scan, Chunk());
+    while (space < n) {
+        m_chunks.push_back(newChunk(kChunkSize));
+        space += kChunkSize;
     }
 
-    // append data in chunks
-    while (n > 0) {
-        // choose number of bytes for next chunk
-        assert(scan->size() <= kChunkSize);
-        UInt32 count = kChunkSize - (UInt32)scan->size();
-        if (count > n)
-            count = n;
-
-        // transfer data
-        scan->insert(scan->end(), data, data + count);
-        n    -= count;
-        data += count;
-
-        // append another empty chunk if we're not done yet
-        if (n > 0) {
-            ++scan;
-            scan = m_chunks.insert(scan, Chunk());
+    // describe the free space
+    int filled = 0;
+    for (size_t i = m_tail; i < m_chunks.size() && filled < count; ++i) {
+        Chunk& chunk = m_chunks[i];
+        if (chunk.m_end < chunk.m_capacity) {
+            segments[filled].m_data = chunk.m_data + chunk.m_end;
+            segments[filled].m_size = chunk.m_capacity - chunk.m_end;
+            ++filled;
         }
     }
+    return filled;
+}
+
+void
+StreamBuffer::commit(UInt32 n)
+{
+    append(NULL, n);
 }
 
 UInt32
@@ -145,3 +184,68 @@ StreamBuffer::getSize() const
 {
     return m_size;
 }
+
+int
+StreamBuffer::getSegments(Segment* segments, int count) const
+{
+    int filled = 0;
+    for (size_t i = 0; i <= m_tail && i < m_chunks.size() && filled < count; ++i) {
+        const Chunk& chunk = m_chunks[i];
+        if (chunk.m_end > chunk.m_begin) {
+            segments[filled].m_data = chunk.m_data + chunk.m_begin;
+            segments[filled].m_size = chunk.m_end - chunk.m_begin;
+            ++filled;
+        }
+    }
+    return filled;
+}
+
+StreamBuffer::Chunk
+StreamBuffer::newChunk(UInt32 capacity)
+{
+    Chunk chunk;
+    chunk.m_data     = new UInt8[capacity];
+    chunk.m_capacity = capacity;
+    chunk.m_begin    = 0;
+    chunk.m_end      = 0;
+    return chunk;
+}
+
+void
+StreamBuffer::deleteChunk(Chunk& chunk)
+{
+    delete[] chunk.m_data;
+    chunk.m_data = NULL;
+}
+
+void
+StreamBuffer::append(const UInt8* data, UInt32 n)
+{
+    m_size += n;
+
+    // fill the tail chunk then move on to the next, adding chunks as
+    // needed
+    while (n > 0) {
+        if (m_tail == m_chunks.size()) {
+            m_chunks.push_back(newChunk(kChunkSize));
+        }
+
+        Chunk& chunk = m_chunks[m_tail];
+        UInt32 count = chunk.m_capacity - chunk.m_end;
+        if (count > n) {
+            count = n;
+        }
+
+        // transfer data
+        if (data != NULL) {
+            memcpy(chunk.m_data + chunk.m_end, data, count);
+            data += count;
+        }
+        chunk.m_end += count;
+        n           -= count;
+
+        if (chunk.m_end == chunk.m_capacity) {
+            ++m_tail;
+        }
+    }
+}
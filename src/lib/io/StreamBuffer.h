@@ -19,18 +19,34 @@
 #pragma once
 
 #include "base/EventTypes.h"
-#include "common/stdlist.h"
-#include "common/stdvector.h"
+#include "common/stddeque.h"
 
 //! FIFO of bytes
 /*!
-This class maintains a FIFO (first-in, last-out) buffer of bytes.
+This class maintains a FIFO (first-in, first-out) buffer of bytes.
+
+The bytes are kept in a list of fixed size chunks so appending never
+moves existing data.  The buffered data and the free space at the end
+of the buffer can both be exposed as segments for scatter/gather I/O,
+which lets sockets read into and write from the buffer without copying.
 */
 class StreamBuffer {
 public:
+    //! A contiguous run of bytes in the buffer
+    class Segment {
+    public:
+        UInt8*            m_data;
+        UInt32            m_size;
+    };
+
     StreamBuffer();
+    StreamBuffer(StreamBuffer const &) =delete;
+    StreamBuffer(StreamBuffer &&) =delete;
     ~StreamBuffer();
 
+    StreamBuffer& operator=(StreamBuffer const &) =delete;
+    StreamBuffer& operator=(StreamBuffer &&) =delete;
+
     //! @name manipulators
     //@{
 
@@ -38,10 +54,19 @@ public:
     /*!
     Return a pointer to memory with the next \c n bytes in the buffer
     (which must be <= getSize()).  The caller must not modify the returned
-    memory nor delete it.
+    memory nor delete it.  This only copies if the bytes span more than
+    one chunk.
     */
     const void*            peek(UInt32 n);
 
+    //! Read data from buffer
+    /*!
+    Copies the next \c n bytes (which must be <= getSize()) to \c data
+    and discards them.  Unlike peek() this never consolidates chunks.
+    If \c data is NULL the bytes are just discarded.
+    */
+    void                read(void* data, UInt32 n);
+
     //! Discard data
     /*!
     Discards the next \c n bytes.  If \c n >= getSize() then the buffer
@@ -55,6 +80,23 @@ public:
     */
     void                write(const void* data, UInt32 n);
 
+    //! Reserve space at the end of the buffer
+    /*!
+    Makes at least \c n bytes of free space available at the end of the
+    buffer and fills in up to \c count \c segments describing it, in
+    order.  Returns the number of segments filled in.  Bytes stored in
+    the segments aren't part of the buffer until they're committed with
+    commit().  Any other manipulator may reuse the reserved space.
+    */
+    int                    reserve(UInt32 n, Segment* segments, int count);
+
+    //! Append reserved data
+    /*!
+    Appends the first \c n bytes of the space described by the last
+    call to reserve() to the buffer.
+    */
+    void                commit(UInt32 n);
+
     //@}
     //! @name accessors
     //@{
@@ -65,15 +107,42 @@ public:
     */
     UInt32                getSize() const;
 
+    //! Get buffered data
+    /*!
+    Fills in up to \c count \c segments describing the data at the
+    front of the buffer, in order, without copying it.  Returns the
+    number of segments filled in.  The segments are valid until the
+    buffer is next changed.
+    */
+    int                    getSegments(Segment* segments, int count) const;
+
     //@}
 
 private:
     static const UInt32    kChunkSize;
 
-    typedef std::vector<UInt8> Chunk;
-    typedef std::list<Chunk> ChunkList;
+    // a block of memory.  data is stored between m_begin and m_end.
+    class Chunk {
+    public:
+        UInt8*            m_data;
+        UInt32            m_capacity;
+        UInt32            m_begin;
+        UInt32            m_end;
+    };
 
+    typedef std::deque<Chunk> ChunkList;
+
+    static Chunk        newChunk(UInt32 capacity);
+    static void            deleteChunk(Chunk&);
+
+    // append bytes to the chunks starting at m_tail.  if data is NULL
+    // the bytes are already in place.
+    void                append(const UInt8* data, UInt32 n);
+
+private:
+    // every chunk before m_tail is full to the end and every chunk
+    // after it is empty, so m_tail is the chunk the next byte goes in.
     ChunkList            m_chunks;
+    size_t                m_tail;
     UInt32                m_size;
-    UInt32                m_headUsed;
 };
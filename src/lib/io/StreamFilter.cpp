@@ -62,6 +62,25 @@ StreamFilter::write(const void* buffer, UInt32 n)
     getStream()->write(buffer, n);
 }
 
+void
+StreamFilter::writeVector(const void* const* buffers,
+                const UInt32* sizes, int count)
+{
+    getStream()->writeVector(buffers, sizes, count);
+}
+
+void
+StreamFilter::beginBatch()
+{
+    getStream()->beginBatch();
+}
+
+void
+StreamFilter::endBatch()
+{
+    getStream()->endBatch();
+}
+
 void
 StreamFilter::flush()
 {
@@ -80,6 +99,13 @@ StreamFilter::shutdownOutput()
     getStream()->shutdownOutput();
 }
 
+void
+StreamFilter::setOutputLimits(UInt32 lowWater,
+                UInt32 highWater, UInt32 hardLimit)
+{
+    getStream()->setOutputLimits(lowWater, highWater, hardLimit);
+}
+
 void*
 StreamFilter::getEventTarget() const
 {
@@ -98,6 +124,18 @@ StreamFilter::getSize() const
     return getStream()->getSize();
 }
 
+bool
+StreamFilter::isCongested() const
+{
+    return getStream()->isCongested();
+}
+
+bool
+StreamFilter::hasPendingOutput() const
+{
+    return getStream()->hasPendingOutput();
+}
+
 synergy::IStream*
 StreamFilter::getStream() const
 {
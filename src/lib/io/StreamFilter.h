@@ -47,12 +47,20 @@ public:
     virtual void        close();
     virtual UInt32        read(void* buffer, UInt32 n);
     virtual void        write(const void* buffer, UInt32 n);
+    virtual void        writeVector(const void* const* buffers,
+                            const UInt32* sizes, int count);
+    virtual void        beginBatch();
+    virtual void        endBatch();
     virtual void        flush();
     virtual void        shutdownInput();
     virtual void        shutdownOutput();
+    virtual void        setOutputLimits(UInt32 lowWater,
+                            UInt32 highWater, UInt32 hardLimit);
     virtual void*        getEventTarget() const;
     virtual bool        isReady() const;
     virtual UInt32        getSize() const;
+    virtual bool        isCongested() const;
+    virtual bool        hasPendingOutput() const;
 
     //! Get the stream
     /*!
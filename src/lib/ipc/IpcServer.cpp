@@ -96,11 +96,15 @@ IpcServer::listen()
 void
 IpcServer::handleClientConnecting(const Event&, void*)
 {
-    synergy::IStream* stream = m_socket->accept();
-    if (stream == NULL) {
-        return;
+    synergy::IStream* stream;
+    while ((stream = m_socket->accept()) != NULL) {
+        addClient(stream);
     }
+}
 
+void
+IpcServer::addClient(synergy::IStream* stream)
+{
     LOG((CLOG_DEBUG "accepted ipc client connection"));
 
     ARCH->lockMutex(m_clientsMutex);
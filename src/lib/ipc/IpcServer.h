@@ -32,6 +32,8 @@ class IpcMessage;
 class IEventQueue;
 class SocketMultiplexer;
 
+namespace synergy { class IStream; }
+
 //! IPC server for communication between daemon and GUI.
 /*!
 The IPC server listens on localhost. The IPC client runs on both the
@@ -71,6 +73,7 @@ public:
 private:
     void                init();
     void                handleClientConnecting(const Event&, void*);
+    void                addClient(synergy::IStream* stream);
     void                handleClientDisconnected(const Event&, void*);
     void                handleMessageReceived(const Event&, void*);
     void                deleteClient(IpcClientProxy* proxy);
@@ -0,0 +1,243 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/FingerprintDatabase.h"
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/Path.h"
+#include "common/stdmap.h"
+
+#include <fstream>
+#include <system_error>
+#if HAVE_SYS_INOTIFY_H
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#    include <climits>
+#endif
+
+static const char kFingerprintDirName[] = "SSL/Fingerprints";
+static const char kFingerprintTrustedServersFilename[] = "TrustedServers.txt";
+
+//
+// FingerprintDatabase
+//
+
+FingerprintDatabase::FingerprintDatabase(const String& filename) :
+    m_filename(filename),
+    m_mutex(ARCH->newMutex()),
+    m_loaded(false),
+    m_size(0),
+    m_watch(-1)
+{
+}
+
+FingerprintDatabase::~FingerprintDatabase()
+{
+    unwatch();
+    ARCH->closeMutex(m_mutex);
+}
+
+bool
+FingerprintDatabase::isTrusted(const Digest& digest)
+{
+    ArchMutexLock lock(m_mutex);
+    if (!m_loaded || hasChanged()) {
+        load();
+    }
+    if (m_digests.count(digest) != 0) {
+        return true;
+    }
+
+    // inotify doesn't see changes made on other machines to files on
+    // network file systems so check the file before turning this down
+    if (m_watch != -1 && hasModifiedTimeChanged()) {
+        load();
+        return (m_digests.count(digest) != 0);
+    }
+    return false;
+}
+
+FingerprintDatabase&
+FingerprintDatabase::getTrustedServers()
+{
+    // one database per file, in case the profile directory changes.
+    // they're never destroyed since sockets may use them until exit.
+    static ArchMutex s_mutex = ARCH->newMutex();
+    static std::map<String, FingerprintDatabase*> s_databases;
+
+    String filename = synergy::string::sprintf("%s/%s/%s",
+                            ARCH->getProfileDirectory().c_str(),
+                            kFingerprintDirName,
+                            kFingerprintTrustedServersFilename);
+
+    ArchMutexLock lock(s_mutex);
+    FingerprintDatabase*& database = s_databases[filename];
+    if (database == NULL) {
+        database = new FingerprintDatabase(filename);
+    }
+    return *database;
+}
+
+bool
+FingerprintDatabase::parse(const String& text, Digest& digest)
+{
+    size_t n = 0;
+    int nibbles = 0;
+    unsigned char byte = 0;
+    for (char c : text) {
+        unsigned char nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = static_cast<unsigned char>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f') {
+            nibble = static_cast<unsigned char>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F') {
+            nibble = static_cast<unsigned char>(c - 'A' + 10);
+        }
+        else if (c == ':' || c == ' ' || c == '\r' || c == '\t') {
+            continue;
+        }
+        else {
+            return false;
+        }
+
+        if (n == digest.size()) {
+            return false;
+        }
+        byte = static_cast<unsigned char>((byte << 4) | nibble);
+        if (++nibbles == 2) {
+            digest[n++] = byte;
+            nibbles     = 0;
+            byte        = 0;
+        }
+    }
+    return (n == digest.size() && nibbles == 0);
+}
+
+void
+FingerprintDatabase::load()
+{
+    // watch before reading so a change while reading isn't missed
+    if (m_watch == -1) {
+        watch();
+    }
+
+    std::error_code error;
+    auto path  = std::filesystem::path(synergy::filesystem::path(m_filename));
+    m_modified = std::filesystem::last_write_time(path, error);
+    m_size     = std::filesystem::file_size(path, error);
+    m_loaded   = true;
+    m_digests.clear();
+
+    std::ifstream file(synergy::filesystem::path(m_filename));
+    if (!file.is_open()) {
+        LOG((CLOG_ERR "Fail to open trusted fingerprints file: %s", m_filename.c_str()));
+        return;
+    }
+
+    String line;
+    Digest digest;
+    while (std::getline(file, line)) {
+        if (parse(line, digest)) {
+            m_digests.insert(digest);
+        }
+    }
+    LOG((CLOG_DEBUG1 "loaded %d trusted fingerprints from %s",
+                            static_cast<int>(m_digests.size()), m_filename.c_str()));
+}
+
+bool
+FingerprintDatabase::hasChanged()
+{
+#if HAVE_SYS_INOTIFY_H
+    if (m_watch != -1) {
+        String name = std::filesystem::path(m_filename).filename().string();
+
+        // drain the events, looking for any about the file
+        bool changed = false;
+        alignas(inotify_event) char buffer[sizeof(inotify_event) + NAME_MAX + 1];
+        ssize_t n;
+        while ((n = read(m_watch, buffer, sizeof(buffer))) > 0) {
+            for (char* i = buffer; i < buffer + n; ) {
+                auto event = reinterpret_cast<inotify_event*>(i);
+                i += sizeof(inotify_event) + event->len;
+
+                if ((event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+                    // the directory went away so fall back to checking
+                    // the file until it can be watched again
+                    unwatch();
+                    return true;
+                }
+                if (event->len != 0 && name == event->name) {
+                    changed = true;
+                }
+            }
+        }
+        return changed;
+    }
+#endif
+
+    return hasModifiedTimeChanged();
+}
+
+bool
+FingerprintDatabase::hasModifiedTimeChanged() const
+{
+    std::error_code error;
+    auto path     = std::filesystem::path(synergy::filesystem::path(m_filename));
+    auto modified = std::filesystem::last_write_time(path, error);
+    auto size     = std::filesystem::file_size(path, error);
+    return (modified != m_modified || size != m_size);
+}
+
+void
+FingerprintDatabase::watch()
+{
+#if HAVE_SYS_INOTIFY_H
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1) {
+        return;
+    }
+
+    String directory = std::filesystem::path(m_filename).parent_path().string();
+    if (directory.empty()) {
+        directory = ".";
+    }
+    if (inotify_add_watch(fd, directory.c_str(),
+                            IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                            IN_MOVED_FROM | IN_MOVED_TO |
+                            IN_DELETE_SELF | IN_MOVE_SELF) == -1) {
+        // probably no directory yet
+        close(fd);
+        return;
+    }
+    m_watch = fd;
+#endif
+}
+
+void
+FingerprintDatabase::unwatch()
+{
+#if HAVE_SYS_INOTIFY_H
+    if (m_watch != -1) {
+        close(m_watch);
+        m_watch = -1;
+    }
+#endif
+}
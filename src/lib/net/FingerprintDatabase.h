@@ -0,0 +1,107 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "arch/IArchMultithread.h"
+#include "base/String.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+
+//! Trusted fingerprint database
+/*!
+Keeps the SHA-256 certificate fingerprints listed in a file in memory,
+one per line in hex with optional colons, e.g. "AB:CD:...".  The file
+is only read again when it changes.  On Linux changes are noticed
+with inotify, elsewhere by checking the file's modification time.
+*/
+class FingerprintDatabase {
+public:
+    //! A raw SHA-256 fingerprint
+    typedef std::array<unsigned char, 32> Digest;
+
+    explicit FingerprintDatabase(const String& filename);
+    FingerprintDatabase(FingerprintDatabase const &) =delete;
+    FingerprintDatabase(FingerprintDatabase &&) =delete;
+    ~FingerprintDatabase();
+
+    FingerprintDatabase& operator=(FingerprintDatabase const &) =delete;
+    FingerprintDatabase& operator=(FingerprintDatabase &&) =delete;
+
+    //! @name accessors
+    //@{
+
+    //! Check a fingerprint
+    /*!
+    Returns true if \c digest is listed in the file.  This is safe to
+    call from any thread.
+    */
+    bool                isTrusted(const Digest& digest);
+
+    //! Get the trusted servers
+    /*!
+    Returns the shared database of trusted servers in the profile
+    directory.
+    */
+    static FingerprintDatabase&
+                        getTrustedServers();
+
+    //! Parse a fingerprint
+    /*!
+    Parses \c text as a hex SHA-256 fingerprint, ignoring colons and
+    case.  Returns false if it isn't one.
+    */
+    static bool         parse(const String& text, Digest& digest);
+
+    //@}
+
+private:
+    struct DigestHash {
+        size_t operator()(const Digest& digest) const
+        {
+            // digests are already uniformly distributed
+            size_t hash;
+            std::memcpy(&hash, digest.data(), sizeof(hash));
+            return hash;
+        }
+    };
+    typedef std::unordered_set<Digest, DigestHash> DigestSet;
+
+    void                load();
+    bool                hasChanged();
+    bool                hasModifiedTimeChanged() const;
+    void                watch();
+    void                unwatch();
+
+private:
+    String              m_filename;
+    ArchMutex           m_mutex;
+    DigestSet           m_digests;
+    bool                m_loaded;
+
+    // when and how big the file was when it was loaded
+    std::filesystem::file_time_type
+                        m_modified;
+    std::uintmax_t      m_size;
+
+    // inotify descriptor watching the file's directory, or -1 when
+    // checking the modification time instead
+    int                 m_watch;
+};
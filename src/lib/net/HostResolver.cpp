@@ -0,0 +1,276 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/HostResolver.h"
+
+#include "net/NetworkAddress.h"
+#include "net/XSocket.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "base/TMethodJob.h"
+#include "common/stdmap.h"
+#include "common/stddeque.h"
+#include "common/stdvector.h"
+
+//
+// HostResolver::Worker
+//
+
+// the worker owns the cache and the lookup thread.  it outlives the
+// resolver if the resolver is destroyed during a lookup, since the
+// lookup can't be interrupted, and deletes itself when that lookup
+// returns.
+class HostResolver::Worker {
+public:
+    class Entry {
+    public:
+        std::vector<ArchNetAddress>
+                        m_addresses;
+        XSocketAddress::EError
+                        m_error = XSocketAddress::kUnknown;
+        bool            m_failed = false;
+        bool            m_queued = false;
+        double          m_expires = 0.0;
+    };
+
+    Worker(IEventQueue* events, void* target, double ttl, double negativeTtl);
+    ~Worker();
+
+    // queue a lookup of address's hostname.  call with m_mutex locked.
+    void                queue(const NetworkAddress& address);
+
+    // stop the thread, deleting the worker now if it's idle.  the
+    // worker must not be used after this.
+    void                stop();
+
+private:
+    void                lookupThread(void*);
+
+    // save the result of a lookup and tell the resolver.  call with
+    // m_mutex locked.
+    void                save(const NetworkAddress& address,
+                            std::vector<ArchNetAddress>& addresses,
+                            bool failed, XSocketAddress::EError error);
+
+    static void         closeAddresses(std::vector<ArchNetAddress>&);
+
+public:
+    Mutex               m_mutex;
+    std::map<String, Entry>
+                        m_cache;
+
+private:
+    IEventQueue*        m_events;
+    void*               m_target;
+    double              m_ttl;
+    double              m_negativeTtl;
+    CondVarBase         m_queueReady;
+    std::deque<NetworkAddress>
+                        m_queue;
+    bool                m_stopped;
+    bool                m_busy;
+    Thread*             m_thread;
+};
+
+HostResolver::Worker::Worker(IEventQueue* events, void* target,
+                double ttl, double negativeTtl) :
+    m_events(events),
+    m_target(target),
+    m_ttl(ttl),
+    m_negativeTtl(negativeTtl),
+    m_queueReady(&m_mutex),
+    m_stopped(false),
+    m_busy(false),
+    m_thread(NULL)
+{
+    m_thread = new Thread(new TMethodJob<Worker>(
+                                this, &Worker::lookupThread));
+}
+
+HostResolver::Worker::~Worker()
+{
+    delete m_thread;
+    for (auto& i : m_cache) {
+        closeAddresses(i.second.m_addresses);
+    }
+}
+
+void
+HostResolver::Worker::queue(const NetworkAddress& address)
+{
+    m_queue.push_back(address);
+    m_queueReady.signal();
+}
+
+void
+HostResolver::Worker::stop()
+{
+    bool busy;
+    {
+        Lock lock(&m_mutex);
+        m_stopped = true;
+        busy      = m_busy;
+        m_queueReady.signal();
+    }
+
+    // an idle thread sees m_stopped and returns.  a busy one deletes
+    // the worker when its lookup returns.
+    if (!busy) {
+        m_thread->wait();
+        delete this;
+    }
+}
+
+void
+HostResolver::Worker::lookupThread(void*)
+{
+    for (;;) {
+        NetworkAddress address;
+        {
+            Lock lock(&m_mutex);
+            while (m_queue.empty() && !m_stopped) {
+                m_queueReady.wait();
+            }
+            if (m_stopped) {
+                return;
+            }
+            address = m_queue.front();
+            m_queue.pop_front();
+            m_busy = true;
+        }
+
+        // look up the name without holding the lock
+        LOG((CLOG_DEBUG1 "looking up %s", address.getHostname().c_str()));
+        std::vector<ArchNetAddress> addresses;
+        bool failed                  = false;
+        XSocketAddress::EError error = XSocketAddress::kUnknown;
+        try {
+            addresses = address.lookup();
+        }
+        catch (XSocketAddress& e) {
+            LOG((CLOG_DEBUG1 "failed to look up %s: %s",
+                            address.getHostname().c_str(), e.what()));
+            failed = true;
+            error  = e.getError();
+        }
+
+        bool stopped;
+        {
+            Lock lock(&m_mutex);
+            m_busy  = false;
+            stopped = m_stopped;
+            if (!stopped) {
+                save(address, addresses, failed, error);
+            }
+        }
+        if (stopped) {
+            // the resolver is gone and left us to clean up
+            closeAddresses(addresses);
+            delete this;
+            return;
+        }
+    }
+}
+
+void
+HostResolver::Worker::save(const NetworkAddress& address,
+                std::vector<ArchNetAddress>& addresses,
+                bool failed, XSocketAddress::EError error)
+{
+    Entry& entry   = m_cache[address.getHostname()];
+    entry.m_queued = false;
+    entry.m_failed = failed;
+    entry.m_error  = error;
+    if (failed) {
+        // keep any addresses we had.  they're better than nothing if
+        // the name server is only unreachable for a while.
+        entry.m_expires = ARCH->time() + m_negativeTtl;
+    }
+    else {
+        closeAddresses(entry.m_addresses);
+        entry.m_addresses.swap(addresses);
+        entry.m_expires = ARCH->time() + m_ttl;
+    }
+
+    m_events->addEvent(Event(m_events->forHostResolver().resolved(),
+                            m_target));
+}
+
+void
+HostResolver::Worker::closeAddresses(std::vector<ArchNetAddress>& addresses)
+{
+    for (auto address : addresses) {
+        ARCH->closeAddr(address);
+    }
+    addresses.clear();
+}
+
+//
+// HostResolver
+//
+
+HostResolver::HostResolver(IEventQueue* events,
+                double ttl, double negativeTtl) :
+    m_worker(new Worker(events, this, ttl, negativeTtl))
+{
+    // do nothing
+}
+
+HostResolver::~HostResolver()
+{
+    m_worker->stop();
+}
+
+size_t
+HostResolver::resolve(NetworkAddress& address, size_t index)
+{
+    // the wildcard address doesn't need a lookup
+    if (address.getHostname().empty()) {
+        return address.resolve(index);
+    }
+
+    Lock lock(&m_worker->m_mutex);
+    Worker::Entry& entry = m_worker->m_cache[address.getHostname()];
+
+    // refresh expired entries, including new ones
+    bool expired = (ARCH->time() >= entry.m_expires);
+    if (expired && !entry.m_queued) {
+        entry.m_queued = true;
+        m_worker->queue(address);
+    }
+
+    // prefer the last known addresses, even if they're stale
+    if (!entry.m_addresses.empty()) {
+        return address.setAddress(entry.m_addresses, index);
+    }
+    if (entry.m_failed && !expired) {
+        throw XSocketAddress(entry.m_error,
+                            address.getHostname(), address.getPort());
+    }
+    return 0;
+}
+
+void*
+HostResolver::getEventTarget() const
+{
+    return const_cast<void*>(static_cast<const void*>(this));
+}
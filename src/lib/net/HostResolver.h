@@ -0,0 +1,79 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+class IEventQueue;
+class NetworkAddress;
+
+//! Cached host name resolver
+/*!
+Resolves host names on a worker thread so the caller never waits on
+the name server.  Results are cached for a time to live;  failures are
+cached for a shorter time so a bad name doesn't hit the name server on
+every retry.  Once an entry expires the last known addresses are still
+used while a refresh runs in the background.
+*/
+class HostResolver {
+public:
+    /*!
+    Cache addresses for \c ttl seconds and failed lookups for
+    \c negativeTtl seconds.
+    */
+    HostResolver(IEventQueue* events,
+                            double ttl = 300.0, double negativeTtl = 5.0);
+    HostResolver(HostResolver const &) =delete;
+    HostResolver(HostResolver &&) =delete;
+    ~HostResolver();
+
+    HostResolver& operator=(HostResolver const &) =delete;
+    HostResolver& operator=(HostResolver &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Resolve address
+    /*!
+    Sets \c address to the cached address at \c index, as
+    NetworkAddress::resolve() does, and returns the count of addresses.
+    Returns 0 without changing \c address if there's nothing cached yet;
+    a \c resolved event is sent when the lookup finishes and the caller
+    should try again then.  Throws XSocketAddress if the last lookup of
+    the name failed recently.  Stale entries start a refresh but are
+    still used.  The wildcard address is resolved immediately.
+    */
+    size_t              resolve(NetworkAddress& address, size_t index = 0);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get event target
+    /*!
+    Returns the target of the \c resolved events.
+    */
+    void*               getEventTarget() const;
+
+    //@}
+
+private:
+    class Worker;
+
+    Worker*             m_worker;
+};
@@ -37,7 +37,9 @@ public:
     /*!
     Accept a connection, returning a socket representing the full-duplex
     data stream.  Returns NULL if no socket is waiting to be accepted.
-    This is only valid after a call to \c bind().
+    This is only valid after a call to \c bind().  After a connecting
+    event call this until it returns NULL;  the socket doesn't watch
+    for new connections again until then.
     */
     virtual IDataSocket*
                         accept() = 0;
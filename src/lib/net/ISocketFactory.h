@@ -38,7 +38,12 @@ public:
     virtual IDataSocket*    create(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET) const = 0;
 
     //! Create listen socket
-    virtual IListenSocket*    createListen(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET) const = 0;
+    /*!
+    \c backlog is the number of connections left waiting to be accepted;
+    zero or less uses the system maximum.
+    */
+    virtual IListenSocket*    createListen(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET,
+                            int backlog = 0) const = 0;
 
     //@}
 };
@@ -134,48 +134,65 @@ NetworkAddress::operator=(const NetworkAddress& addr)
 size_t
 NetworkAddress::resolve(size_t index)
 {
-    size_t resolvedAddressesCount = 0;
     // discard previous address
     if (m_address != nullptr) {
         ARCH->closeAddr(m_address);
         m_address = nullptr;
     }
 
-    try {
-        // if hostname is empty then use wildcard address otherwise look
-        // up the name.
-        if (m_hostname.empty()) {
-            m_address = ARCH->newAnyAddr(IArchNetwork::kINET);
-            resolvedAddressesCount = 1;
-        }
-        else {
-            // Logic for temporary filtring only ipv4 addresses
-            std::vector<ArchNetAddress> ipv4OnlyAddresses;
-            {
-                auto addresses = ARCH->nameToAddr(m_hostname);
-                for (auto address : addresses) {
-                    if (ARCH->getAddrFamily(address) == IArchNetwork::kINET) {
-                        ipv4OnlyAddresses.emplace_back(address);
-                    }
-                    else {
-                        ARCH->closeAddr(address);
-                    }
-                }
-            }
+    // if hostname is empty then use wildcard address otherwise look
+    // up the name.
+    if (m_hostname.empty()) {
+        m_address = ARCH->newAnyAddr(IArchNetwork::kINET);
+        ARCH->setAddrPort(m_address, m_port);
+        return 1;
+    }
+
+    auto addresses = lookup();
+    size_t resolvedAddressesCount = setAddress(addresses, index);
+    for (auto address : addresses) {
+        ARCH->closeAddr(address);
+    }
+    return resolvedAddressesCount;
+}
+
+size_t
+NetworkAddress::setAddress(const std::vector<ArchNetAddress>& addresses,
+                size_t index)
+{
+    assert(!addresses.empty());
+
+    if (m_address != nullptr) {
+        ARCH->closeAddr(m_address);
+        m_address = nullptr;
+    }
+
+    if (index < addresses.size() - 1) {
+        m_address = ARCH->copyAddr(addresses[index]);
+    }
+    else {
+        m_address = ARCH->copyAddr(addresses.back());
+    }
+
+    // set port in address
+    ARCH->setAddrPort(m_address, m_port);
 
-            resolvedAddressesCount = ipv4OnlyAddresses.size();
-            assert(resolvedAddressesCount > 0);
-            if (index < resolvedAddressesCount - 1) {
-                m_address = ipv4OnlyAddresses[index];
+    return addresses.size();
+}
+
+std::vector<ArchNetAddress>
+NetworkAddress::lookup() const
+{
+    // Logic for temporary filtring only ipv4 addresses
+    std::vector<ArchNetAddress> ipv4OnlyAddresses;
+    try {
+        auto addresses = ARCH->nameToAddr(m_hostname);
+        for (auto address : addresses) {
+            if (ARCH->getAddrFamily(address) == IArchNetwork::kINET) {
+                ipv4OnlyAddresses.emplace_back(address);
             }
             else {
-                m_address = ipv4OnlyAddresses[resolvedAddressesCount - 1];
-            }
-
-            for(auto address : ipv4OnlyAddresses) {
-                if(m_address != address) {
-                    ARCH->closeAddr(address);
-                }
+                ARCH->closeAddr(address);
             }
         }
     }
@@ -192,10 +209,10 @@ NetworkAddress::resolve(size_t index)
         throw XSocketAddress(XSocketAddress::kUnknown, m_hostname, m_port);
     }
 
-    // set port in address
-    ARCH->setAddrPort(m_address, m_port);
-
-    return resolvedAddressesCount;
+    if (ipv4OnlyAddresses.empty()) {
+        throw XSocketAddress(XSocketAddress::kUnsupported, m_hostname, m_port);
+    }
+    return ipv4OnlyAddresses;
 }
 
 bool
@@ -71,6 +71,16 @@ public:
     */
     size_t              resolve(size_t index = 0);
 
+    //! Use a looked up address
+    /*!
+    Replaces the address with a copy of \c addresses[index], or of the
+    last address if \c index is past the end, and sets the port.  The
+    caller keeps ownership of \c addresses, which must not be empty.
+    Returns the count of addresses.
+    */
+    size_t              setAddress(const std::vector<ArchNetAddress>& addresses,
+                            size_t index);
+
     //@}
     //! @name accessors
     //@{
@@ -113,6 +123,15 @@ public:
     */
     String                getHostname() const;
 
+    //! Look up hostname
+    /*!
+    Looks up the IPv4 addresses of the hostname without changing this
+    address.  This may block for as long as the system resolver takes.
+    The caller must close the returned addresses.  Throws XSocketAddress
+    if the hostname can't be resolved.
+    */
+    std::vector<ArchNetAddress>    lookup() const;
+
     //@}
 
 private:
@@ -0,0 +1,280 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/ParallelConnector.h"
+
+#include "net/IDataSocket.h"
+#include "net/ISocketFactory.h"
+#include "arch/Arch.h"
+#include "base/IEventQueue.h"
+#include "base/Log.h"
+#include "base/TMethodEventJob.h"
+#include "base/XBase.h"
+
+//
+// ParallelConnector
+//
+
+ParallelConnector::ParallelConnector(IEventQueue* events,
+                ISocketFactory* socketFactory, bool secure, double attemptDelay) :
+    m_events(events),
+    m_socketFactory(socketFactory),
+    m_secure(secure),
+    m_attemptDelay(attemptDelay),
+    m_next(0),
+    m_timer(NULL),
+    m_socket(NULL)
+{
+    assert(m_socketFactory != NULL);
+}
+
+ParallelConnector::~ParallelConnector()
+{
+    cleanupTimer();
+    for (const auto& attempt : m_attempts) {
+        closeAttempt(attempt);
+    }
+    delete m_socket;
+}
+
+void
+ParallelConnector::connect(const std::vector<NetworkAddress>& addresses)
+{
+    assert(m_attempts.empty() && m_socket == NULL);
+
+    m_addresses = interleave(addresses);
+    m_next      = 0;
+    m_lastError = "no address";
+    startNext();
+}
+
+IDataSocket*
+ParallelConnector::takeSocket()
+{
+    IDataSocket* socket = m_socket;
+    m_socket = NULL;
+    return socket;
+}
+
+void*
+ParallelConnector::getEventTarget() const
+{
+    return const_cast<void*>(static_cast<const void*>(this));
+}
+
+const NetworkAddress&
+ParallelConnector::getAddress() const
+{
+    return m_address;
+}
+
+std::vector<NetworkAddress>
+ParallelConnector::interleave(const std::vector<NetworkAddress>& addresses)
+{
+    if (addresses.empty()) {
+        return addresses;
+    }
+
+    // split by family, keeping the order within each family
+    IArchNetwork::EAddressFamily first =
+        ARCH->getAddrFamily(addresses.front().getAddress());
+    std::vector<NetworkAddress> preferred;
+    std::vector<NetworkAddress> others;
+    for (const auto& address : addresses) {
+        if (ARCH->getAddrFamily(address.getAddress()) == first) {
+            preferred.push_back(address);
+        }
+        else {
+            others.push_back(address);
+        }
+    }
+
+    // then alternate between the families
+    std::vector<NetworkAddress> result;
+    result.reserve(addresses.size());
+    for (size_t i = 0; i < preferred.size() || i < others.size(); ++i) {
+        if (i < preferred.size()) {
+            result.push_back(preferred[i]);
+        }
+        if (i < others.size()) {
+            result.push_back(others[i]);
+        }
+    }
+    return result;
+}
+
+void
+ParallelConnector::startNext()
+{
+    cleanupTimer();
+
+    while (m_next < m_addresses.size()) {
+        size_t index                  = m_next++;
+        const NetworkAddress& address = m_addresses[index];
+        LOG((CLOG_DEBUG1 "connecting to %s:%i",
+                            ARCH->addrToString(address.getAddress()).c_str(),
+                            address.getPort()));
+
+        Attempt attempt;
+        attempt.m_socket = NULL;
+        attempt.m_index  = index;
+        try {
+            attempt.m_socket = m_socketFactory->create(m_secure,
+                            ARCH->getAddrFamily(address.getAddress()));
+            m_events->adoptHandler(Event::kUnknown,
+                            attempt.m_socket->getEventTarget(),
+                            new TMethodEventJob<ParallelConnector>(this,
+                                &ParallelConnector::handleSocketEvent));
+            m_attempts.push_back(attempt);
+            attempt.m_socket->connect(address);
+        }
+        catch (XBase& e) {
+            // try the next address right away
+            LOG((CLOG_DEBUG1 "connection attempt failed: %s", e.what()));
+            m_lastError = e.what();
+            if (attempt.m_socket != NULL) {
+                m_attempts.pop_back();
+                closeAttempt(attempt);
+            }
+            continue;
+        }
+
+        // give this attempt a head start before trying the next
+        if (m_next < m_addresses.size()) {
+            setupTimer();
+        }
+        return;
+    }
+
+    if (m_attempts.empty()) {
+        fail();
+    }
+}
+
+void
+ParallelConnector::closeAttempt(const Attempt& attempt)
+{
+    m_events->removeHandler(Event::kUnknown,
+                            attempt.m_socket->getEventTarget());
+    delete attempt.m_socket;
+}
+
+void
+ParallelConnector::finish(size_t i)
+{
+    cleanupTimer();
+
+    Attempt winner = m_attempts[i];
+    m_attempts.erase(m_attempts.begin() + i);
+    for (const auto& attempt : m_attempts) {
+        closeAttempt(attempt);
+    }
+    m_attempts.clear();
+
+    m_events->removeHandler(Event::kUnknown, winner.m_socket->getEventTarget());
+    m_socket  = winner.m_socket;
+    m_address = m_addresses[winner.m_index];
+    LOG((CLOG_DEBUG1 "connected to %s:%i",
+                            ARCH->addrToString(m_address.getAddress()).c_str(),
+                            m_address.getPort()));
+
+    // dispatch rather than queue so the caller takes the socket before
+    // any of its events are dispatched.  the handler may delete us so
+    // this must be the last thing we do.
+    m_events->dispatchEvent(Event(m_events->forIDataSocket().connected(),
+                            getEventTarget()));
+}
+
+void
+ParallelConnector::fail()
+{
+    cleanupTimer();
+    LOG((CLOG_DEBUG1 "all connection attempts failed"));
+    auto info = new IDataSocket::ConnectionFailedInfo(m_lastError.c_str());
+    m_events->addEvent(Event(m_events->forIDataSocket().connectionFailed(),
+                            getEventTarget(), info, Event::kDontFreeData));
+}
+
+void
+ParallelConnector::setupTimer()
+{
+    assert(m_timer == NULL);
+
+    m_timer = m_events->newOneShotTimer(m_attemptDelay, NULL);
+    m_events->adoptHandler(Event::kTimer, m_timer,
+                            new TMethodEventJob<ParallelConnector>(this,
+                                &ParallelConnector::handleTimer));
+}
+
+void
+ParallelConnector::cleanupTimer()
+{
+    if (m_timer != NULL) {
+        m_events->removeHandler(Event::kTimer, m_timer);
+        m_events->deleteTimer(m_timer);
+        m_timer = NULL;
+    }
+}
+
+void
+ParallelConnector::handleTimer(const Event&, void*)
+{
+    startNext();
+}
+
+void
+ParallelConnector::handleSocketEvent(const Event& event, void*)
+{
+    size_t i = 0;
+    while (i < m_attempts.size() &&
+            m_attempts[i].m_socket->getEventTarget() != event.getTarget()) {
+        ++i;
+    }
+    if (i == m_attempts.size()) {
+        return;
+    }
+
+    Event::Type type = event.getType();
+    Event::Type ready = m_secure ?
+                            m_events->forIDataSocket().secureConnected() :
+                            m_events->forIDataSocket().connected();
+    if (type == ready) {
+        finish(i);
+    }
+    else if (type == m_events->forIDataSocket().connectionFailed() ||
+            type == m_events->forISocket().disconnected()) {
+        if (type == m_events->forIDataSocket().connectionFailed()) {
+            auto info = static_cast<IDataSocket::ConnectionFailedInfo*>(
+                                event.getData());
+            m_lastError = info->m_what;
+            delete info;
+        }
+        else {
+            m_lastError = "disconnected";
+        }
+
+        // move on to the next address without waiting for the timer
+        Attempt attempt = m_attempts[i];
+        m_attempts.erase(m_attempts.begin() + i);
+        closeAttempt(attempt);
+        startNext();
+    }
+    else if (type == m_events->forISocket().stopRetry()) {
+        // the server was rejected so let the caller know not to retry
+        m_events->addEvent(Event(type, getEventTarget()));
+    }
+}
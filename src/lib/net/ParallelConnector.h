@@ -0,0 +1,144 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "net/NetworkAddress.h"
+#include "base/String.h"
+#include "common/stdvector.h"
+
+class Event;
+class EventQueueTimer;
+class IDataSocket;
+class IEventQueue;
+class ISocketFactory;
+
+//! Parallel connector
+/*!
+Connects to the first of several addresses that answers, in the style
+of RFC 8305 (happy eyeballs).  Connection attempts are started one at
+a time, \c attemptDelay seconds apart or as soon as the previous attempt
+fails, so an unreachable address doesn't hold up the ones after it.
+The first socket to connect is kept and the other attempts are closed.
+
+The connector sends \c IDataSocket::connected once it has a socket;
+for secure sockets that's after the handshake.  It sends
+\c IDataSocket::connectionFailed with a \c ConnectionFailedInfo if every
+attempt failed.  Attempts that never finish are left to the caller's
+own timeout.
+*/
+class ParallelConnector {
+public:
+    ParallelConnector(IEventQueue* events, ISocketFactory* socketFactory,
+                            bool secure, double attemptDelay = 0.25);
+    ParallelConnector(ParallelConnector const &) =delete;
+    ParallelConnector(ParallelConnector &&) =delete;
+    ~ParallelConnector();
+
+    ParallelConnector& operator=(ParallelConnector const &) =delete;
+    ParallelConnector& operator=(ParallelConnector &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Start connecting
+    /*!
+    Starts connecting to \c addresses, which must be resolved.  The
+    addresses are tried in order except that address families are
+    interleaved so a family that doesn't work can't hold up the other.
+    */
+    void                connect(const std::vector<NetworkAddress>& addresses);
+
+    //! Take the connected socket
+    /*!
+    Returns the socket that connected, passing ownership to the caller,
+    or NULL if there's no such socket.  Call this when handling the
+    \c connected event.
+    */
+    IDataSocket*        takeSocket();
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Get event target
+    /*!
+    Returns the target of the \c connected and \c connectionFailed
+    events.
+    */
+    void*               getEventTarget() const;
+
+    //! Get connected address
+    /*!
+    Returns the address of the socket that connected.  Only valid after
+    the \c connected event.
+    */
+    const NetworkAddress&
+                        getAddress() const;
+
+    //@}
+
+    //! Order addresses for connecting
+    /*!
+    Returns \c addresses with the address families interleaved, keeping
+    the order within each family and starting with the family of the
+    first address.
+    */
+    static std::vector<NetworkAddress>
+                        interleave(const std::vector<NetworkAddress>& addresses);
+
+private:
+    class Attempt {
+    public:
+        IDataSocket*    m_socket;
+        size_t          m_index;
+    };
+
+    // start the next attempt, skipping addresses that fail immediately.
+    // fails the connect if there's nothing left to try.
+    void                startNext();
+
+    // stop listening to and delete an attempt's socket
+    void                closeAttempt(const Attempt&);
+
+    // keep the socket from attempt i and close the rest
+    void                finish(size_t i);
+
+    // report that every attempt failed
+    void                fail();
+
+    void                setupTimer();
+    void                cleanupTimer();
+
+    void                handleTimer(const Event&, void*);
+    void                handleSocketEvent(const Event&, void*);
+
+private:
+    IEventQueue*        m_events;
+    ISocketFactory*     m_socketFactory;
+    bool                m_secure;
+    double              m_attemptDelay;
+    std::vector<NetworkAddress>
+                        m_addresses;
+    size_t              m_next;
+    std::vector<Attempt>
+                        m_attempts;
+    EventQueueTimer*    m_timer;
+    IDataSocket*        m_socket;
+    NetworkAddress      m_address;
+    String              m_lastError;
+};
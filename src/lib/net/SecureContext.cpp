@@ -0,0 +1,246 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/SecureContext.h"
+
+#include "arch/Arch.h"
+#include "base/Log.h"
+#include "base/Path.h"
+#include "common/stdmap.h"
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <filesystem>
+#include <system_error>
+
+//
+// SecureContext
+//
+
+// how long a session can be resumed for, in seconds.  long enough to
+// cover a laptop sleeping overnight.
+static const long s_sessionTimeout = 24 * 60 * 60;
+
+// session id context for server session caches
+static const unsigned char s_sessionIdContext[] = "synergy";
+
+namespace {
+
+class ServerContext {
+public:
+    SSL_CTX*        m_context;
+    std::filesystem::file_time_type
+                    m_modified;
+};
+
+// the shared state.  it's created on first use, once ARCH exists, and
+// never destroyed since sockets may use the contexts until exit.
+class State {
+public:
+    State() :
+        m_mutex(ARCH->newMutex()),
+        m_client(NULL),
+        m_serverIndex(-1)
+    {
+        SSL_library_init();
+        OpenSSL_add_all_algorithms();
+        SSL_load_error_strings();
+        m_serverIndex = SSL_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+    }
+
+    ArchMutex       m_mutex;
+    SSL_CTX*        m_client;
+    std::map<String, ServerContext>
+                    m_servers;
+    std::map<String, SSL_SESSION*>
+                    m_sessions;
+
+    // index of the SSL ex data holding the server of a client session
+    int             m_serverIndex;
+};
+
+State&
+getState()
+{
+    static State* s_state = new State;
+    return *s_state;
+}
+
+void
+logError(const char* reason)
+{
+    LOG((CLOG_ERR "secure socket error: %s", reason));
+    unsigned long e = ERR_get_error();
+    if (e != 0) {
+        char error[256];
+        ERR_error_string_n(e, error, sizeof(error));
+        LOG((CLOG_ERR "openssl error: %s", error));
+    }
+}
+
+SSL_CTX*
+newContext(const SSL_METHOD* method)
+{
+    SSL_CTX* context = SSL_CTX_new(method);
+    if (context == NULL) {
+        logError("could not create tls context");
+        return NULL;
+    }
+
+    //Prevent the usage of of all version prior to TLSv1.2 as they are known to be vulnerable
+    SSL_CTX_set_options(context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
+    SSL_CTX_set_timeout(context, s_sessionTimeout);
+    return context;
+}
+
+// called by openssl when a client gets a session it could resume.  the
+// session is kept by us if this returns 1.
+int
+saveClientSession(SSL* ssl, SSL_SESSION* session)
+{
+    State& state = getState();
+    auto server  = static_cast<const String*>(
+                            SSL_get_ex_data(ssl, state.m_serverIndex));
+    if (server == NULL || !SSL_SESSION_is_resumable(session)) {
+        return 0;
+    }
+
+    ArchMutexLock lock(state.m_mutex);
+    SSL_SESSION*& saved = state.m_sessions[*server];
+    if (saved != NULL) {
+        SSL_SESSION_free(saved);
+    }
+    saved = session;
+    return 1;
+}
+
+std::filesystem::file_time_type
+getModified(const String& filename)
+{
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(
+                            std::filesystem::path(synergy::filesystem::path(filename)), error);
+    return error ? std::filesystem::file_time_type() : modified;
+}
+
+} // namespace
+
+SSL_CTX*
+SecureContext::getClientContext()
+{
+    State& state = getState();
+    ArchMutexLock lock(state.m_mutex);
+    if (state.m_client == NULL) {
+        state.m_client = newContext(TLS_client_method());
+        if (state.m_client == NULL) {
+            return NULL;
+        }
+
+        // keep client sessions ourselves, by server.  openssl's cache
+        // is keyed by session id which a client doesn't know up front.
+        SSL_CTX_set_session_cache_mode(state.m_client,
+                            SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(state.m_client, &saveClientSession);
+    }
+
+    SSL_CTX_up_ref(state.m_client);
+    return state.m_client;
+}
+
+SSL_CTX*
+SecureContext::getServerContext(const String& certificateFile)
+{
+    State& state  = getState();
+    auto modified = getModified(certificateFile);
+
+    ArchMutexLock lock(state.m_mutex);
+    auto i = state.m_servers.find(certificateFile);
+    if (i != state.m_servers.end() && i->second.m_modified == modified) {
+        SSL_CTX_up_ref(i->second.m_context);
+        return i->second.m_context;
+    }
+
+    LOG((CLOG_DEBUG "loading tls certificate: %s", certificateFile.c_str()));
+    SSL_CTX* context = newContext(TLS_server_method());
+    if (context == NULL) {
+        return NULL;
+    }
+
+    if (SSL_CTX_use_certificate_file(context, certificateFile.c_str(), SSL_FILETYPE_PEM) <= 0) {
+        logError("could not use tls certificate");
+        SSL_CTX_free(context);
+        return NULL;
+    }
+    if (SSL_CTX_use_PrivateKey_file(context, certificateFile.c_str(), SSL_FILETYPE_PEM) <= 0) {
+        logError("could not use tls private key");
+        SSL_CTX_free(context);
+        return NULL;
+    }
+    if (!SSL_CTX_check_private_key(context)) {
+        logError("could not verify tls private key");
+        SSL_CTX_free(context);
+        return NULL;
+    }
+
+    // resume sessions from the cache or from tickets, which are
+    // encrypted with a key belonging to the context
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(context, s_sessionIdContext,
+                            sizeof(s_sessionIdContext) - 1);
+
+    // replace the context for the old certificate.  sockets still
+    // using it keep their own references.
+    if (i != state.m_servers.end()) {
+        SSL_CTX_free(i->second.m_context);
+        state.m_servers.erase(i);
+    }
+    ServerContext server;
+    server.m_context  = context;
+    server.m_modified = modified;
+    state.m_servers.insert(std::make_pair(certificateFile, server));
+
+    SSL_CTX_up_ref(context);
+    return context;
+}
+
+void
+SecureContext::resumeSession(SSL* ssl, const String* server)
+{
+    State& state = getState();
+    SSL_set_ex_data(ssl, state.m_serverIndex, const_cast<String*>(server));
+
+    ArchMutexLock lock(state.m_mutex);
+    auto i = state.m_sessions.find(*server);
+    if (i != state.m_sessions.end()) {
+        if (SSL_SESSION_is_resumable(i->second) &&
+                SSL_set_session(ssl, i->second) == 1) {
+            LOG((CLOG_DEBUG1 "offering to resume tls session with %s", server->c_str()));
+        }
+    }
+}
+
+void
+SecureContext::forgetSession(const String& server)
+{
+    State& state = getState();
+    ArchMutexLock lock(state.m_mutex);
+    auto i = state.m_sessions.find(server);
+    if (i != state.m_sessions.end()) {
+        SSL_SESSION_free(i->second);
+        state.m_sessions.erase(i);
+    }
+}
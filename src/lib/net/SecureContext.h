@@ -0,0 +1,67 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+//! Shared TLS contexts
+/*!
+Keeps one process-wide TLS context for clients and one for each server
+certificate, so certificates are loaded once and sessions can be
+resumed.  Servers resume sessions through their own session cache and
+session tickets.  Clients remember the last session with each server
+and offer it on the next connect, so a reconnect after waking from
+sleep skips the full key exchange.
+*/
+class SecureContext {
+public:
+    //! Get client context
+    /*!
+    Returns a new reference to the shared client context, or NULL if
+    it can't be created.  Release it with \c SSL_CTX_free().
+    */
+    static SSL_CTX*     getClientContext();
+
+    //! Get server context
+    /*!
+    Returns a new reference to the shared context using the certificate
+    and private key in \c certificateFile, or NULL if they can't be
+    used.  The file is loaded again if it has changed since it was last
+    loaded.  Release the context with \c SSL_CTX_free().
+    */
+    static SSL_CTX*     getServerContext(const String& certificateFile);
+
+    //! Offer to resume a session
+    /*!
+    Sets up \c ssl, which must be from the client context, to offer the
+    last session with \c server and to remember the session it ends up
+    with.  \c server identifies the server, e.g. its host name and port,
+    and must outlive \c ssl.
+    */
+    static void         resumeSession(SSL* ssl, const String* server);
+
+    //! Forget sessions
+    /*!
+    Forgets the client sessions with \c server so the next connect does
+    a full handshake.
+    */
+    static void         forgetSession(const String& server);
+};
@@ -21,6 +21,7 @@
 #include "net/NetworkAddress.h"
 #include "net/SocketMultiplexer.h"
 #include "net/TSocketMultiplexerMethodJob.h"
+#include "net/XSocket.h"
 #include "arch/XArch.h"
 #include "synergy/ArgParser.h"
 #include "synergy/ArgsBase.h"
@@ -35,59 +36,63 @@ static const char s_certificateFilename[] = { "Synergy.pem" };
 SecureListenSocket::SecureListenSocket(
         IEventQueue* events,
         SocketMultiplexer* socketMultiplexer,
-        IArchNetwork::EAddressFamily family) :
-    TCPListenSocket(events, socketMultiplexer, family)
+        IArchNetwork::EAddressFamily family,
+        int backlog,
+        SocketMultiplexer* handshakeMultiplexer,
+        bool kernelTls) :
+    TCPListenSocket(events, socketMultiplexer, family, backlog),
+    m_handshakeMultiplexer(handshakeMultiplexer),
+    m_kernelTls(kernelTls)
 {
 }
 
 IDataSocket*
 SecureListenSocket::accept()
 {
-    SecureSocket* socket = NULL;
-    try {
-        socket = new SecureSocket(
-                        m_events,
-                        m_socketMultiplexer,
-                        ARCH->acceptSocket(m_socket, NULL));
-        socket->initSsl(true);
+    ArchSocket archSocket;
+    while ((archSocket = acceptSocket()) != NULL) {
+        SecureSocket* socket = NULL;
+        try {
+            socket = new SecureSocket(
+                            m_events,
+                            m_socketMultiplexer,
+                            archSocket);
+            socket->initSsl(true);
+            socket->setHandshakeMultiplexer(m_handshakeMultiplexer);
+            socket->setKernelTls(m_kernelTls);
 
-        if (socket != NULL) {
-            setListeningJob();
-        }
+            //default location of the TLS cert file in users dir
+            String certificateFilename = synergy::string::sprintf("%s/%s/%s",
+                                                                  ARCH->getProfileDirectory().c_str(),
+                                                                  s_certificateDir,
+                                                                  s_certificateFilename);
 
-        //default location of the TLS cert file in users dir
-        String certificateFilename = synergy::string::sprintf("%s/%s/%s",
-                                                              ARCH->getProfileDirectory().c_str(),
-                                                              s_certificateDir,
-                                                              s_certificateFilename);
+            //if the tls cert option is set use that for the certificate file
+            if (!ArgParser::argsBase().m_tlsCertFile.empty()) {
+                certificateFilename = ArgParser::argsBase().m_tlsCertFile;
+            }
 
-        //if the tls cert option is set use that for the certificate file
-        if (!ArgParser::argsBase().m_tlsCertFile.empty()) {
-            certificateFilename = ArgParser::argsBase().m_tlsCertFile;
-        }
+            bool loaded = socket->loadCertificates(certificateFilename);
+            if (!loaded) {
+                delete socket;
+                continue;
+            }
 
-        bool loaded = socket->loadCertificates(certificateFilename);
-        if (!loaded) {
+            socket->secureAccept();
+
+            return dynamic_cast<IDataSocket*>(socket);
+        }
+        catch (XArchNetwork&) {
             delete socket;
-            return NULL;
         }
-
-        socket->secureAccept();
-
-        return dynamic_cast<IDataSocket*>(socket);
-    }
-    catch (XArchNetwork&) {
-        if (socket != NULL) {
+        catch (XSocket&) {
             delete socket;
-            setListeningJob();
         }
-        return NULL;
-    }
-    catch (std::exception &ex) {
-        if (socket != NULL) {
+        catch (std::exception&) {
             delete socket;
             setListeningJob();
+            throw;
         }
-        throw ex;
     }
+    return NULL;
 }
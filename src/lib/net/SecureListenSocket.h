@@ -27,10 +27,16 @@ class IDataSocket;
 class SecureListenSocket : public TCPListenSocket{
 public:
     SecureListenSocket(IEventQueue* events,
-        SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family);
+        SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family,
+        int backlog = 0, SocketMultiplexer* handshakeMultiplexer = NULL,
+        bool kernelTls = false);
 
 
     // IListenSocket overrides
     virtual IDataSocket*
                         accept();
+
+private:
+    SocketMultiplexer*  m_handshakeMultiplexer;
+    bool                m_kernelTls;
 };
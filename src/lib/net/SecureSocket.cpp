@@ -17,6 +17,10 @@
 
 #include "SecureSocket.h"
 
+#include "net/SecureContext.h"
+#include "net/FingerprintDatabase.h"
+#include "net/NetworkAddress.h"
+#include "net/SocketMultiplexer.h"
 #include "net/TSocketMultiplexerMethodJob.h"
 #include "base/TMethodEventJob.h"
 #include "net/TCPSocket.h"
@@ -33,6 +37,7 @@
 #include <cstdlib>
 #include <memory>
 #include <fstream>
+#include <algorithm>
 
 //
 // SecureSocket
@@ -40,17 +45,14 @@
 
 #define MAX_ERROR_SIZE 65535
 
-static const float s_retryDelay = 0.01f;
+// the most plaintext handed to SSL_write at once.  this is the largest
+// tls record so bigger writes wouldn't make fewer records.
+static const UInt32 s_maxRecordSize = 16384;
 
 enum {
     kMsgSize = 128
 };
 
-static const char kFingerprintDirName[] = "SSL/Fingerprints";
-//static const char kFingerprintLocalFilename[] = "Local.txt";
-static const char kFingerprintTrustedServersFilename[] = "TrustedServers.txt";
-//static const char kFingerprintTrustedClientsFilename[] = "TrustedClients.txt";
-
 struct Ssl {
     SSL_CTX*    m_context;
     SSL*        m_ssl;
@@ -61,17 +63,33 @@ SecureSocket::SecureSocket(IEventQueue* events,
     TCPSocket(events, socketMultiplexer, family),
     m_ssl(nullptr),
     m_secureReady(false),
-    m_fatal(false)
+    m_fatal(false),
+    m_readRetry(0),
+    m_writeRetry(0),
+    m_handshakeRetry(0),
+    m_pendingWrite(0),
+    m_kernelTlsSend(false),
+    m_handshakeMultiplexer(NULL),
+    m_enableKernelTls(false)
 {
 }
 
 SecureSocket::SecureSocket(IEventQueue* events,
         SocketMultiplexer* socketMultiplexer,
         ArchSocket socket) :
-    TCPSocket(events, socketMultiplexer, socket),
+    // don't service the socket until secureAccept().  a job started now
+    // could read the handshake before this is a SecureSocket.
+    TCPSocket(events, socketMultiplexer, socket, false),
     m_ssl(nullptr),
     m_secureReady(false),
-    m_fatal(false)
+    m_fatal(false),
+    m_readRetry(0),
+    m_writeRetry(0),
+    m_handshakeRetry(0),
+    m_pendingWrite(0),
+    m_kernelTlsSend(false),
+    m_handshakeMultiplexer(NULL),
+    m_enableKernelTls(false)
 {
 }
 
@@ -90,6 +108,10 @@ SecureSocket::close()
 void
 SecureSocket::connect(const NetworkAddress& addr)
 {
+    // sessions are resumed by server name rather than address
+    m_server = synergy::string::sprintf("%s:%d",
+                            addr.getHostname().c_str(), addr.getPort());
+
     m_events->adoptHandler(m_events->forIDataSocket().connected(),
                 getEventTarget(),
                 new TMethodEventJob<SecureSocket>(this,
@@ -113,23 +135,73 @@ SecureSocket::newJob()
 void
 SecureSocket::secureConnect()
 {
-    setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
-                    this, &SecureSocket::serviceConnect,
-                    getSocket(), isReadable(), isWritable()));
+    startHandshake(&SecureSocket::serviceConnect);
 }
 
 void
 SecureSocket::secureAccept()
 {
-    setJob(new TSocketMultiplexerMethodJob<SecureSocket>(
-                    this, &SecureSocket::serviceAccept,
-                    getSocket(), isReadable(), isWritable()));
+    startHandshake(&SecureSocket::serviceAccept);
+}
+
+void
+SecureSocket::setHandshakeMultiplexer(SocketMultiplexer* multiplexer)
+{
+    m_handshakeMultiplexer = multiplexer;
+}
+
+void
+SecureSocket::setKernelTls(bool enable)
+{
+    m_enableKernelTls = enable;
+}
+
+bool
+SecureSocket::isKernelTls() const
+{
+    return m_kernelTlsSend;
+}
+
+bool
+SecureSocket::isSessionResumed() const
+{
+    return (m_ssl->m_ssl != NULL && SSL_session_reused(m_ssl->m_ssl));
+}
+
+void
+SecureSocket::startHandshake(ServiceMethod method)
+{
+    if (m_handshakeMultiplexer == NULL) {
+        setJob(newHandshakeJob(method));
+        return;
+    }
+
+    // handshake on the handshake threads so a slow peer or a slow key
+    // exchange doesn't hold up the sockets on the socket multiplexer.
+    // the socket goes back to that multiplexer when it's secure.
+    setJob(NULL);
+    m_handshakeMultiplexer->addSocket(this, newHandshakeJob(method));
+}
+
+ISocketMultiplexerJob*
+SecureSocket::newHandshakeJob(ServiceMethod method)
+{
+    // wait for whatever the handshake is blocked on.  the first try
+    // runs right away since the socket is writable.
+    bool readable = true;
+    bool writable = true;
+    if (m_handshakeRetry > 0 && m_ssl->m_ssl != NULL) {
+        writable = (SSL_want_write(m_ssl->m_ssl) != 0);
+        readable = !writable;
+    }
+    return new TSocketMultiplexerMethodJob<SecureSocket>(
+                    this, method, getSocket(), readable, writable);
 }
 
 TCPSocket::EJobResult
 SecureSocket::doRead()
 {
-    static UInt8 buffer[4096];
+    static thread_local UInt8 buffer[4096];
     memset(buffer, 0, sizeof(buffer));
     int bytesRead = 0;
     int status = 0;
@@ -184,59 +256,48 @@ SecureSocket::doRead()
 TCPSocket::EJobResult
 SecureSocket::doWrite()
 {
-    static bool s_retry = false;
-    static int s_retrySize = 0;
-    static int s_staticBufferSize = 0;
-    static void* s_staticBuffer = NULL;
-
-    // write data
-    int bufferSize = 0;
-    int bytesWrote = 0;
-    int status = 0;
-    
-    if (s_retry) {
-        bufferSize = s_retrySize;
-    }
-    else {
-        bufferSize = m_outputBuffer.getSize();
-        if (bufferSize != 0) {
-            if (bufferSize > s_staticBufferSize) {
-                s_staticBuffer = realloc(s_staticBuffer, bufferSize);
-                s_staticBufferSize = bufferSize;
-            }
-            memcpy(s_staticBuffer, m_outputBuffer.peek(bufferSize), bufferSize);
-        }
-    }
-    
-    if (bufferSize == 0) {
+    if (!isSecureReady()) {
         return kRetry;
     }
 
-    if (isSecureReady()) {
-        status = secureWrite(s_staticBuffer, bufferSize, bytesWrote);
-        if (status > 0) {
-            s_retry = false;
-            bufferSize = 0;
+    // the kernel makes the records so write the plaintext directly
+    if (m_kernelTlsSend) {
+        return TCPSocket::doWrite();
+    }
+
+    // hand the front of the output buffer to SSL_write in place, a
+    // record at a time.  a write that has to be retried must be retried
+    // with the same length.  the front of the buffer doesn't change
+    // until we discard what was written so the same bytes are there.
+    while (m_outputBuffer.getSize() > 0) {
+        StreamBuffer::Segment segment;
+        m_outputBuffer.getSegments(&segment, 1);
+        UInt32 size = m_pendingWrite;
+        if (size == 0) {
+            size = (segment.m_size < s_maxRecordSize) ?
+                            segment.m_size : s_maxRecordSize;
         }
-        else if (status < 0) {
+        assert(size <= segment.m_size);
+
+        int bytesWrote = 0;
+        int status = secureWrite(segment.m_data, static_cast<int>(size), bytesWrote);
+        if (status < 0) {
             return kBreak;
         }
         else if (status == 0) {
-            s_retry = true;
-            s_retrySize = bufferSize;
-            return kNew;
+            // try again when the socket is ready
+            m_pendingWrite = size;
+            break;
         }
-    }
-    else {
-        return kRetry;
-    }
-    
-    if (bytesWrote > 0) {
+
+        // with partial writes enabled this may be less than size
+        m_pendingWrite = 0;
         discardWrittenData(bytesWrote);
-        return kNew;
     }
 
-    return kRetry;
+    // nothing left to write or waiting to retry.  get a job that
+    // reflects which.
+    return kNew;
 }
 
 int
@@ -245,13 +306,11 @@ SecureSocket::secureRead(void* buffer, int size, int& read)
     if (m_ssl->m_ssl != NULL) {
         LOG((CLOG_DEBUG2 "reading secure socket"));
         read = SSL_read(m_ssl->m_ssl, buffer, size);
-        
-        static int retry;
 
         // Check result will cleanup the connection in the case of a fatal
-        checkResult(read, retry);
-        
-        if (retry) {
+        checkResult(read, m_readRetry);
+
+        if (m_readRetry) {
             return 0;
         }
 
@@ -272,13 +331,11 @@ SecureSocket::secureWrite(const void* buffer, int size, int& wrote)
         LOG((CLOG_DEBUG2 "writing secure socket: %p", this));
 
         wrote = SSL_write(m_ssl->m_ssl, buffer, size);
-        
-        static int retry;
 
         // Check result will cleanup the connection in the case of a fatal
-        checkResult(wrote, retry);
+        checkResult(wrote, m_writeRetry);
 
-        if (retry) {
+        if (m_writeRetry) {
             return 0;
         }
 
@@ -328,61 +385,29 @@ SecureSocket::loadCertificates(String& filename)
         }
     }
 
-    int r = 0;
-    r = SSL_CTX_use_certificate_file(m_ssl->m_context, filename.c_str(), SSL_FILETYPE_PEM);
-    if (r <= 0) {
-        showError("could not use tls certificate");
-        return false;
-    }
-
-    r = SSL_CTX_use_PrivateKey_file(m_ssl->m_context, filename.c_str(), SSL_FILETYPE_PEM);
-    if (r <= 0) {
-        showError("could not use tls private key");
-        return false;
-    }
-
-    r = SSL_CTX_check_private_key(m_ssl->m_context);
-    if (!r) {
-        showError("could not verify tls private key");
-        return false;
+    // the context with the certificate is shared by every socket using
+    // the same certificate, so it's only loaded once
+    if (m_ssl->m_context != NULL) {
+        SSL_CTX_free(m_ssl->m_context);
     }
-
-    return true;
+    m_ssl->m_context = SecureContext::getServerContext(filename);
+    return (m_ssl->m_context != NULL);
 }
 
 void
 SecureSocket::initContext(bool server)
 {
-    SSL_library_init();
-
-    const SSL_METHOD* method;
- 
-    // load & register all cryptos, etc.
-    OpenSSL_add_all_algorithms();
-
-    // load all error messages
-    SSL_load_error_strings();
-
     if (CLOG->getFilter() >= kINFO) {
         showSecureLibInfo();
     }
 
-    if (server) {
-        method = SSLv23_server_method();
-    }
-    else {
-        method = SSLv23_client_method();
-    }
-    
-    // create new context from method
-    SSL_METHOD* m = const_cast<SSL_METHOD*>(method);
-    m_ssl->m_context = SSL_CTX_new(m);
-
-    //Prevent the usage of of all version prior to TLSv1.2 as they are known to be vulnerable
-    SSL_CTX_set_options(m_ssl->m_context, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_TLSv1 | SSL_OP_NO_TLSv1_1);
-
-    if (m_ssl->m_context == NULL) {
-        showError();
+    // clients share one context so they can resume sessions.  servers
+    // get the context for their certificate in loadCertificates().
+    if (!server) {
+        m_ssl->m_context = SecureContext::getClientContext();
+        if (m_ssl->m_context == NULL) {
+            showError();
+        }
     }
 }
 
@@ -394,6 +419,19 @@ SecureSocket::createSSL()
     if (m_ssl->m_ssl == NULL) {
         assert(m_ssl->m_context != NULL);
         m_ssl->m_ssl = SSL_new(m_ssl->m_context);
+
+        // let SSL_write send part of a buffer and be retried with the
+        // buffer at another address so doWrite() can write in place
+        SSL_set_mode(m_ssl->m_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                            SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+#ifdef SSL_OP_ENABLE_KTLS
+        // openssl hands the keys to the kernel after the handshake if
+        // both support it, otherwise it quietly carries on without
+        if (m_enableKernelTls) {
+            SSL_set_options(m_ssl->m_ssl, SSL_OP_ENABLE_KTLS);
+        }
+#endif
     }
 }
 
@@ -403,7 +441,12 @@ SecureSocket::freeSSL()
     isFatal(true);
     // take socket from multiplexer ASAP otherwise the race condition
     // could cause events to get called on a dead object. TCPSocket
-    // will do this, too, but the double-call is harmless
+    // will do this, too, but the double-call is harmless.  a running
+    // handshake can hand the socket back to the socket multiplexer so
+    // wait for it first.
+    if (m_handshakeMultiplexer != NULL) {
+        m_handshakeMultiplexer->removeSocket(this);
+    }
     setJob(NULL);
     if (m_ssl->m_ssl != NULL) {
         SSL_shutdown(m_ssl->m_ssl);
@@ -428,37 +471,37 @@ SecureSocket::secureAccept(int socket)
     
     LOG((CLOG_DEBUG2 "accepting secure socket"));
     int r = SSL_accept(m_ssl->m_ssl);
-    
-    static int retry;
 
-    checkResult(r, retry);
+    checkResult(r, m_handshakeRetry);
 
     if (isFatal()) {
-        // tell user and sleep so the socket isn't hammered.
+        // tell user.  the socket isn't retried so it can't be hammered.
         LOG((CLOG_ERR "failed to accept secure socket"));
         LOG((CLOG_WARN "client connection may not be secure"));
         m_secureReady = false;
-        ARCH->sleep(1);
-        retry = 0;
+        m_handshakeRetry = 0;
         return -1; // Failed, error out
     }
 
     // If not fatal and no retry, state is good
-    if (retry == 0) {
+    if (m_handshakeRetry == 0) {
         m_secureReady = true;
         LOG((CLOG_INFO "accepted secure socket"));
+        if (SSL_session_reused(m_ssl->m_ssl)) {
+            LOG((CLOG_DEBUG "resumed tls session"));
+        }
         if (CLOG->getFilter() >= kDEBUG1) {
             showSecureCipherInfo();
         }
         showSecureConnectInfo();
+        checkKernelTls();
         return 1;
     }
 
     // If not fatal and retry is set, not ready, and return retry
-    if (retry > 0) {
+    if (m_handshakeRetry > 0) {
         LOG((CLOG_DEBUG2 "retry accepting secure socket"));
         m_secureReady = false;
-        ARCH->sleep(s_retryDelay);
         return 0;
     }
 
@@ -470,33 +513,32 @@ SecureSocket::secureAccept(int socket)
 int
 SecureSocket::secureConnect(int socket)
 {
-    createSSL();
+    if (m_ssl->m_ssl == NULL) {
+        createSSL();
+        SecureContext::resumeSession(m_ssl->m_ssl, &m_server);
+    }
 
     // attach the socket descriptor
     SSL_set_fd(m_ssl->m_ssl, socket);
     
     LOG((CLOG_DEBUG2 "connecting secure socket"));
     int r = SSL_connect(m_ssl->m_ssl);
-    
-    static int retry;
 
-    checkResult(r, retry);
+    checkResult(r, m_handshakeRetry);
 
     if (isFatal()) {
         LOG((CLOG_ERR "failed to connect secure socket"));
-        retry = 0;
+        m_handshakeRetry = 0;
         return -1;
     }
 
     // If we should retry, not ready and return 0
-    if (retry > 0) {
+    if (m_handshakeRetry > 0) {
         LOG((CLOG_DEBUG2 "retry connect secure socket"));
         m_secureReady = false;
-        ARCH->sleep(s_retryDelay);
         return 0;
     }
 
-    retry = 0;
     // No error, set ready, process and return ok
     m_secureReady = true;
     if (verifyCertFingerprint()) {
@@ -508,14 +550,19 @@ SecureSocket::secureConnect(int socket)
     }
     else {
         LOG((CLOG_ERR "failed to verify server certificate fingerprint"));
+        SecureContext::forgetSession(m_server);
         disconnect();
         return -1; // Fingerprint failed, error
     }
     LOG((CLOG_DEBUG2 "connected secure socket"));
+    if (SSL_session_reused(m_ssl->m_ssl)) {
+        LOG((CLOG_DEBUG "resumed tls session"));
+    }
     if (CLOG->getFilter() >= kDEBUG1) {
         showSecureCipherInfo();
     }
     showSecureConnectInfo();
+    checkKernelTls();
     return 1;
 }
 
@@ -695,39 +742,20 @@ SecureSocket::verifyCertFingerprint()
         return false;
     }
 
+    FingerprintDatabase::Digest digest;
+    if (tempFingerprintLen != digest.size()) {
+        LOG((CLOG_ERR "unexpected fingerprint size: %d", tempFingerprintLen));
+        return false;
+    }
+    std::copy(tempFingerprint, tempFingerprint + tempFingerprintLen, digest.begin());
+
     // format fingerprint into hexdecimal format with colon separator
     String fingerprint(static_cast<char*>(static_cast<void*>(tempFingerprint)), tempFingerprintLen);
     formatFingerprint(fingerprint);
     LOG((CLOG_NOTE "server fingerprint: %s", fingerprint.c_str()));
 
-    String trustedServersFilename;
-    trustedServersFilename = synergy::string::sprintf(
-        "%s/%s/%s",
-        ARCH->getProfileDirectory().c_str(),
-        kFingerprintDirName,
-        kFingerprintTrustedServersFilename);
-
     // check if this fingerprint exist
-    String fileLine;
-    std::ifstream file;
-    file.open(synergy::filesystem::path(trustedServersFilename));
-
-    bool isValid = false;
-    if (file.is_open()) {
-        while (!file.eof()) {
-            getline(file,fileLine);
-            if (!fileLine.empty() && !fileLine.compare(fingerprint)) {
-                isValid = true;
-                break;
-            }
-        }
-    }
-    else {
-        LOG((CLOG_ERR "Fail to open trusted fingerprints file: %s", trustedServersFilename.c_str()));
-    }
-
-    file.close();
-    return isValid;
+    return FingerprintDatabase::getTrustedServers().isTrusted(digest);
 }
 
 ISocketMultiplexerJob*
@@ -748,16 +776,19 @@ SecureSocket::serviceConnect(ISocketMultiplexerJob* job,
         return NULL;
     }
 
-    // If status > 0, success
+    // If status > 0, success.  hand the socket back to the socket
+    // multiplexer if it handshook elsewhere.
     if (status > 0) {
         sendEvent(m_events->forIDataSocket().secureConnected());
-        return newJob();
+        if (m_handshakeMultiplexer == NULL) {
+            return newJob();
+        }
+        setJob(newJob());
+        return NULL;
     }
 
     // Retry case
-    return new TSocketMultiplexerMethodJob<SecureSocket>(
-            this, &SecureSocket::serviceConnect,
-            getSocket(), isReadable(), isWritable());
+    return newHandshakeJob(&SecureSocket::serviceConnect);
 }
 
 ISocketMultiplexerJob*
@@ -777,16 +808,19 @@ SecureSocket::serviceAccept(ISocketMultiplexerJob* job,
         return NULL;
     }
 
-    // If status > 0, success
+    // If status > 0, success.  hand the socket back to the socket
+    // multiplexer if it handshook elsewhere.
     if (status > 0) {
         sendEvent(m_events->forClientListener().accepted());
-        return newJob();
+        if (m_handshakeMultiplexer == NULL) {
+            return newJob();
+        }
+        setJob(newJob());
+        return NULL;
     }
 
     // Retry case
-    return new TSocketMultiplexerMethodJob<SecureSocket>(
-            this, &SecureSocket::serviceAccept,
-            getSocket(), isReadable(), isWritable());
+    return newHandshakeJob(&SecureSocket::serviceAccept);
 }
 
 void
@@ -851,6 +885,31 @@ SecureSocket::showSecureLibInfo()
     return;
 }
 
+void
+SecureSocket::checkKernelTls()
+{
+    if (!m_enableKernelTls) {
+        return;
+    }
+
+#ifdef SSL_OP_ENABLE_KTLS
+    // once the kernel encrypts, writes skip openssl entirely.  reads
+    // still go through SSL_read(), which reads decrypted records from
+    // the kernel but also handles the handshake messages that tls 1.3
+    // sends after the handshake, e.g. session tickets.
+    m_kernelTlsSend = (BIO_get_ktls_send(SSL_get_wbio(m_ssl->m_ssl)) != 0);
+    bool receive    = (BIO_get_ktls_recv(SSL_get_rbio(m_ssl->m_ssl)) != 0);
+    if (m_kernelTlsSend || receive) {
+        LOG((CLOG_DEBUG "kernel tls enabled for%s%s",
+                            m_kernelTlsSend ? " sending" : "",
+                            receive ? " receiving" : ""));
+        return;
+    }
+#endif
+
+    LOG((CLOG_DEBUG "kernel tls not available, using openssl"));
+}
+
 void
 SecureSocket::showSecureConnectInfo()
 {
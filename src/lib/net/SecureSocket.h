@@ -32,6 +32,15 @@ A secure socket using SSL.
 */
 class SecureSocket : public TCPSocket {
 public:
+    enum {
+        //! Threads a handshake multiplexer should run
+        /*!
+        Handshakes are cpu bound so a few threads let several run at once
+        without starving the data sockets.
+        */
+        kHandshakeThreads = 2
+    };
+
     SecureSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family);
     SecureSocket(IEventQueue* events,
         SocketMultiplexer* socketMultiplexer,
@@ -63,7 +72,42 @@ public:
     void                initSsl(bool server);
     bool                loadCertificates(String& CertFile);
 
+    //! Set the handshake multiplexer
+    /*!
+    Run the tls handshake on \c multiplexer and hand the socket back to
+    the socket multiplexer when it's secure.  If \c multiplexer is NULL,
+    the default, the handshake runs on the socket multiplexer.  The
+    multiplexer must outlive the socket.  Call before connecting or
+    accepting.
+    */
+    void                setHandshakeMultiplexer(SocketMultiplexer* multiplexer);
+
+    //! Enable kernel tls
+    /*!
+    If \c enable is true, hand the session keys to the kernel after the
+    handshake when both it and openssl support it.  Otherwise openssl
+    does all the encryption, the default.  Call before connecting or
+    accepting.
+    */
+    void                setKernelTls(bool enable);
+
+    //! Check for kernel tls
+    /*!
+    Returns true if the kernel encrypts what's written to the socket.
+    */
+    bool                isKernelTls() const;
+
+    //! Check for a resumed session
+    /*!
+    Returns true if the handshake resumed an earlier session rather
+    than doing a full key exchange.
+    */
+    bool                isSessionResumed() const;
+
 private:
+    typedef ISocketMultiplexerJob* (SecureSocket::*ServiceMethod)(
+                            ISocketMultiplexerJob*, bool, bool, bool);
+
     // SSL
     void                initContext(bool server);
     void                createSSL();
@@ -88,6 +132,11 @@ private:
                         serviceAccept(ISocketMultiplexerJob*,
                             bool, bool, bool);
 
+    void                startHandshake(ServiceMethod);
+    ISocketMultiplexerJob*
+                        newHandshakeJob(ServiceMethod);
+
+    void                checkKernelTls();
     void                showSecureConnectInfo();
     void                showSecureLibInfo();
     void                showSecureCipherInfo();
@@ -98,4 +147,25 @@ private:
     Ssl*                m_ssl;
     bool                m_secureReady;
     bool                m_fatal;
+
+    // retry counts for checkResult(), kept per socket since sockets
+    // on the same thread must not share them
+    int                 m_readRetry;
+    int                 m_writeRetry;
+    int                 m_handshakeRetry;
+
+    // length of the write to retry, or 0 if there's no write to retry
+    UInt32              m_pendingWrite;
+
+    // true if the kernel encrypts what we write
+    bool                m_kernelTlsSend;
+
+    // the server a client connects to, naming its resumable session
+    String              m_server;
+
+    // runs the handshake, or NULL to handshake on the socket multiplexer
+    SocketMultiplexer*  m_handshakeMultiplexer;
+
+    // true to try kernel tls after the handshake
+    bool                m_enableKernelTls;
 };
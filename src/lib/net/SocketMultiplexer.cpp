@@ -18,60 +18,48 @@
 
 #include "net/SocketMultiplexer.h"
 
-#include "net/ISocketMultiplexerJob.h"
-#include "mt/CondVar.h"
+#include "net/SocketReactor.h"
 #include "mt/Lock.h"
 #include "mt/Mutex.h"
-#include "mt/Thread.h"
-#include "arch/Arch.h"
-#include "arch/XArch.h"
 #include "base/Log.h"
-#include "base/TMethodJob.h"
-#include "common/stdvector.h"
 
 //
 // SocketMultiplexer
 //
 
-SocketMultiplexer::SocketMultiplexer() :
-    m_mutex(new Mutex),
-    m_thread(NULL),
-    m_update(false),
-    m_jobsReady(new CondVar<bool>(m_mutex, false)),
-    m_jobListLock(new CondVar<bool>(m_mutex, false)),
-    m_jobListLockLocked(new CondVar<bool>(m_mutex, false)),
-    m_jobListLocker(NULL),
-    m_jobListLockLocker(NULL)
+SocketMultiplexer::SocketMultiplexer(int threads) :
+    m_mutex(new Mutex)
 {
-    // this pointer just has to be unique and not NULL.  it will
-    // never be dereferenced.  it's used to identify cursor nodes
-    // in the jobs list.
-    // TODO: Remove this evilness
-    m_cursorMark = reinterpret_cast<ISocketMultiplexerJob*>(this);
-
-    // start thread
-    m_thread = new Thread(new TMethodJob<SocketMultiplexer>(
-                                this, &SocketMultiplexer::serviceThread));
+    if (threads < 1) {
+        threads = 1;
+    }
+    LOG((CLOG_DEBUG1 "starting %d socket multiplexer thread%s",
+                        threads, threads == 1 ? "" : "s"));
+
+    m_reactors.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        ReactorSlot slot;
+        if (threads == 1) {
+            slot.m_reactor = new SocketReactor;
+        }
+        else {
+            size_t index = static_cast<size_t>(i);
+            slot.m_reactor = new SocketReactor([this, index](ISocket* socket) {
+                jobRemoved(index, socket);
+            });
+        }
+        slot.m_sockets = 0;
+        m_reactors.push_back(slot);
+    }
 }
 
 SocketMultiplexer::~SocketMultiplexer()
 {
-    m_thread->cancel();
-    m_thread->unblockPollSocket();
-    m_thread->wait();
-    delete m_thread;
-    delete m_jobsReady;
-    delete m_jobListLock;
-    delete m_jobListLockLocked;
-    delete m_jobListLocker;
-    delete m_jobListLockLocker;
-    delete m_mutex;
-
-    // clean up jobs
-    for (SocketJobMap::iterator i = m_socketJobMap.begin();
-                        i != m_socketJobMap.end(); ++i) {
-        delete *(i->second);
+    for (ReactorList::iterator i = m_reactors.begin();
+                        i != m_reactors.end(); ++i) {
+        delete i->m_reactor;
     }
+    delete m_mutex;
 }
 
 void
@@ -80,36 +68,17 @@ SocketMultiplexer::addSocket(ISocket* socket, ISocketMultiplexerJob* job)
     assert(socket != NULL);
     assert(job    != NULL);
 
-    // prevent other threads from locking the job list
-    lockJobListLock();
-
-    // break thread out of poll
-    m_thread->unblockPollSocket();
-
-    // lock the job list
-    lockJobList();
-
-    // insert/replace job
-    SocketJobMap::iterator i = m_socketJobMap.find(socket);
-    if (i == m_socketJobMap.end()) {
-        // we *must* put the job at the end so the order of jobs in
-        // the list continue to match the order of jobs in pfds in
-        // serviceThread().
-        JobCursor j = m_socketJobs.insert(m_socketJobs.end(), job);
-        m_update     = true;
-        m_socketJobMap.insert(std::make_pair(socket, j));
-    }
-    else {
-        JobCursor j = i->second;
-        if (*j != job) {
-            delete *j;
-            *j = job;
-        }
-        m_update = true;
+    // with a single reactor there's nothing to assign
+    if (m_reactors.size() == 1) {
+        m_reactors[0].m_reactor->addSocket(socket, job);
+        return;
     }
 
-    // unlock the job list
-    unlockJobList();
+    // queue the job while holding the lock so jobRemoved() either sees
+    // it queued or runs before the socket is assigned again.  queueing
+    // doesn't block.
+    Lock lock(m_mutex);
+    assignReactor(socket)->addSocket(socket, job);
 }
 
 void
@@ -117,236 +86,80 @@ SocketMultiplexer::removeSocket(ISocket* socket)
 {
     assert(socket != NULL);
 
-    // prevent other threads from locking the job list
-    lockJobListLock();
-
-    // break thread out of poll
-    m_thread->unblockPollSocket();
-
-    // lock the job list
-    lockJobList();
-
-    // remove job.  rather than removing it from the map we put NULL
-    // in the list instead so the order of jobs in the list continues
-    // to match the order of jobs in pfds in serviceThread().
-    SocketJobMap::iterator i = m_socketJobMap.find(socket);
-    if (i != m_socketJobMap.end()) {
-        if (*(i->second) != NULL) {
-            delete *(i->second);
-            *(i->second) = NULL;
-            m_update     = true;
-        }
+    if (m_reactors.size() == 1) {
+        m_reactors[0].m_reactor->removeSocket(socket);
+        return;
     }
 
-    // unlock the job list
-    unlockJobList();
-}
-
-void
-SocketMultiplexer::serviceThread(void*)
-{
-    std::vector<IArchNetwork::PollEntry> pfds;
-    IArchNetwork::PollEntry pfd;
-
-    // service the connections
-    for (;;) {
-        Thread::testCancel();
-
-        // wait until there are jobs to handle
-        {
-            Lock lock(m_mutex);
-            while (!(bool)*m_jobsReady) {
-                m_jobsReady->wait();
-            }
+    SocketReactor* reactor;
+    {
+        Lock lock(m_mutex);
+        SocketReactorMap::iterator i = m_socketReactorMap.find(socket);
+        if (i == m_socketReactorMap.end()) {
+            // never added or already removed
+            return;
         }
-
-        // lock the job list
-        lockJobListLock();
-        lockJobList();
-
-        // collect poll entries
-        if (m_update) {
-            m_update = false;
-            pfds.clear();
-            pfds.reserve(m_socketJobMap.size());
-
-            JobCursor cursor    = newCursor();
-            JobCursor jobCursor = nextCursor(cursor);
-            while (jobCursor != m_socketJobs.end()) {
-                ISocketMultiplexerJob* job = *jobCursor;
-                if (job != NULL) {
-                    pfd.m_socket = job->getSocket();
-                    pfd.m_events = 0;
-                    if (job->isReadable()) {
-                        pfd.m_events |= IArchNetwork::kPOLLIN;
-                    }
-                    if (job->isWritable()) {
-                        pfd.m_events |= IArchNetwork::kPOLLOUT;
-                    }
-                    pfds.push_back(pfd);
-                }                
-                jobCursor = nextCursor(cursor);
-            }
-            deleteCursor(cursor);
-        }
-
-        int status;
-        try {
-            // check for status
-            if (!pfds.empty()) {
-                status = ARCH->pollSocket(&pfds[0], (int)pfds.size(), -1);
-            }
-            else {
-                status = 0;
-            }
-        }
-        catch (XArchNetwork& e) {
-            LOG((CLOG_WARN "error in socket multiplexer: %s", e.what()));
-            status = 0;
-        }
-
-        if (status != 0) {
-            // iterate over socket jobs, invoking each and saving the
-            // new job.
-            UInt32 i             = 0;
-            JobCursor cursor    = newCursor();
-            JobCursor jobCursor = nextCursor(cursor);
-            while (i < pfds.size() && jobCursor != m_socketJobs.end()) {
-                if (*jobCursor != NULL) {
-                    // get poll state
-                    unsigned short revents = pfds[i].m_revents;
-                    bool read  = ((revents & IArchNetwork::kPOLLIN) != 0);
-                    bool write = ((revents & IArchNetwork::kPOLLOUT) != 0);
-                    bool error = ((revents & (IArchNetwork::kPOLLERR |
-                                              IArchNetwork::kPOLLNVAL)) != 0);
-
-                    // run job
-                    ISocketMultiplexerJob* job    = *jobCursor;
-                    ISocketMultiplexerJob* newJob = job->run(read, write, error);
-
-                    // save job, if different
-                    if (newJob != job) {
-                        Lock lock(m_mutex);
-                        delete job;
-                        *jobCursor = newJob;
-                        m_update   = true;
-                    }
-                    ++i;
-                }
-
-                // next job
-                jobCursor = nextCursor(cursor);
-            }
-            deleteCursor(cursor);
-        }
-
-        // delete any removed socket jobs
-        for (SocketJobMap::iterator i = m_socketJobMap.begin();
-                            i != m_socketJobMap.end();) {
-            if (*(i->second) == NULL) {
-                m_socketJobs.erase(i->second);
-                m_socketJobMap.erase(i++);
-                m_update = true;
-            }
-            else {
-                ++i;
-            }
-        }
-
-        // unlock the job list
-        unlockJobList();
+        ReactorSlot& slot = m_reactors[i->second];
+        reactor = slot.m_reactor;
+        --slot.m_sockets;
+        m_socketReactorMap.erase(i);
     }
-}
 
-SocketMultiplexer::JobCursor
-SocketMultiplexer::newCursor()
-{
-    Lock lock(m_mutex);
-    return m_socketJobs.insert(m_socketJobs.begin(), m_cursorMark);
+    // don't hold the lock while removing since that may wait for the
+    // socket's job to finish
+    reactor->removeSocket(socket);
 }
 
-SocketMultiplexer::JobCursor
-SocketMultiplexer::nextCursor(JobCursor cursor)
+int
+SocketMultiplexer::getThreads() const
 {
-    Lock lock(m_mutex);
-    JobCursor j = m_socketJobs.end();
-    JobCursor i = cursor;
-    while (++i != m_socketJobs.end()) {
-        if (*i != m_cursorMark) {
-            // found a real job (as opposed to a cursor)
-            j = i;
-
-            // move our cursor just past the job
-            m_socketJobs.splice(++i, m_socketJobs, cursor);
-            break;
-        }
-    }
-    return j;
+    return static_cast<int>(m_reactors.size());
 }
 
-void
-SocketMultiplexer::deleteCursor(JobCursor cursor)
+size_t
+SocketMultiplexer::getAssignedSockets() const
 {
     Lock lock(m_mutex);
-    m_socketJobs.erase(cursor);
+    return m_socketReactorMap.size();
 }
 
-void
-SocketMultiplexer::lockJobListLock()
+SocketReactor*
+SocketMultiplexer::assignReactor(ISocket* socket)
 {
-    Lock lock(m_mutex);
-
-    // wait for the lock on the lock
-    while (*m_jobListLockLocked) {
-        m_jobListLockLocked->wait();
+    // keep the socket's existing reactor so its jobs never run on two
+    // threads at once
+    SocketReactorMap::iterator i = m_socketReactorMap.find(socket);
+    if (i != m_socketReactorMap.end()) {
+        return m_reactors[i->second].m_reactor;
     }
 
-    // take ownership of the lock on the lock
-    *m_jobListLockLocked = true;
-    m_jobListLockLocker  = new Thread(Thread::getCurrentThread());
-}
-
-void
-SocketMultiplexer::lockJobList()
-{
-    Lock lock(m_mutex);
-
-    // make sure we're the one that called lockJobListLock()
-    assert(*m_jobListLockLocker == Thread::getCurrentThread());
-
-    // wait for the job list lock
-    while (*m_jobListLock) {
-        m_jobListLock->wait();
+    // otherwise use the reactor with the fewest sockets
+    size_t best = 0;
+    for (size_t j = 1; j < m_reactors.size(); ++j) {
+        if (m_reactors[j].m_sockets < m_reactors[best].m_sockets) {
+            best = j;
+        }
     }
-
-    // take ownership of the lock
-    *m_jobListLock      = true;
-    m_jobListLocker     = m_jobListLockLocker;
-    m_jobListLockLocker = NULL;
-
-    // release the lock on the lock
-    *m_jobListLockLocked = false;
-    m_jobListLockLocked->broadcast();
+    ++m_reactors[best].m_sockets;
+    m_socketReactorMap.insert(std::make_pair(socket, best));
+    return m_reactors[best].m_reactor;
 }
 
 void
-SocketMultiplexer::unlockJobList()
+SocketMultiplexer::jobRemoved(size_t index, ISocket* socket)
 {
     Lock lock(m_mutex);
 
-    // make sure we're the one that called lockJobList()
-    assert(*m_jobListLocker == Thread::getCurrentThread());
-
-    // release the lock
-    delete m_jobListLocker;
-    m_jobListLocker = NULL;
-    *m_jobListLock  = false;
-    m_jobListLock->signal();
-
-    // set new jobs ready state
-    bool isReady = !m_socketJobMap.empty();
-    if (*m_jobsReady != isReady) {
-        *m_jobsReady = isReady;
-        m_jobsReady->signal();
+    // the socket may have been removed, and maybe assigned elsewhere,
+    // or been given a new job since its job removed itself
+    SocketReactorMap::iterator i = m_socketReactorMap.find(socket);
+    if (i == m_socketReactorMap.end() || i->second != index) {
+        return;
+    }
+    ReactorSlot& slot = m_reactors[index];
+    if (slot.m_reactor->hasQueuedOperation(socket)) {
+        return;
     }
+    --slot.m_sockets;
+    m_socketReactorMap.erase(i);
 }
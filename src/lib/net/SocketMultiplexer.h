@@ -18,24 +18,34 @@
 
 #pragma once
 
-#include "arch/IArchNetwork.h"
-#include "common/stdlist.h"
 #include "common/stdmap.h"
+#include "common/stdvector.h"
+
+#include <cstddef>
 
-template <class T>
-class CondVar;
 class Mutex;
-class Thread;
 class ISocket;
 class ISocketMultiplexerJob;
+class SocketReactor;
 
 //! Socket multiplexer
 /*!
 A socket multiplexer services multiple sockets simultaneously.
+
+Sockets are spread across a pool of reactors, each with its own service
+thread, so a slow job on one socket (a TLS handshake, say) only delays
+the sockets sharing its reactor.  A socket is assigned to the least
+loaded reactor when its first job is added and stays there until it's
+removed so its jobs always run on the same thread, one at a time.
 */
 class SocketMultiplexer {
 public:
-    SocketMultiplexer();
+    //! Create a multiplexer
+    /*!
+    Creates a multiplexer with \c threads service threads.  Values less
+    than one are treated as one.
+    */
+    explicit SocketMultiplexer(int threads = 1);
     SocketMultiplexer(SocketMultiplexer const &) =delete;
     SocketMultiplexer(SocketMultiplexer &&) =delete;
     ~SocketMultiplexer();
@@ -46,14 +56,38 @@ public:
     //! @name manipulators
     //@{
 
+    //! Set the job for a socket
+    /*!
+    Queues \c job to service \c socket, replacing and deleting any
+    job the socket already has.  The multiplexer takes ownership of
+    \c job.  This does not block.
+    */
     void                addSocket(ISocket*, ISocketMultiplexerJob*);
 
+    //! Remove the job for a socket
+    /*!
+    Queues the removal of the job for \c socket.  When this returns
+    the job is not running and will never run again, so the caller is
+    free to destroy the socket.  This only blocks if the job happens
+    to be running at the time.
+    */
     void                removeSocket(ISocket*);
 
     //@}
     //! @name accessors
     //@{
 
+    //! Get the number of service threads
+    int                 getThreads() const;
+
+    //! Get the number of assigned sockets
+    /*!
+    Returns the number of sockets assigned to a service thread, which
+    are those with a job or a queued job.  Sockets are only assigned
+    when there's more than one thread.
+    */
+    size_t              getAssignedSockets() const;
+
     // maybe belongs on ISocketMultiplexer
     static SocketMultiplexer*
                         getInstance();
@@ -61,56 +95,27 @@ public:
     //@}
 
 private:
-    // list of jobs.  we use a list so we can safely iterate over it
-    // while other threads modify it.
-    typedef std::list<ISocketMultiplexerJob*> SocketJobs;
-    typedef SocketJobs::iterator JobCursor;
-    typedef std::map<ISocket*, JobCursor> SocketJobMap;
-
-    // service sockets.  the service thread will only access m_sockets
-    // and m_update while m_pollable and m_polling are true.  all other
-    // threads must only modify these when m_pollable and m_polling are
-    // false.  only the service thread sets m_polling.
-    void                serviceThread(void*);
-
-    // create, iterate, and destroy a cursor.  a cursor is used to
-    // safely iterate through the job list while other threads modify
-    // the list.  it works by inserting a dummy item in the list and
-    // moving that item through the list.  the dummy item will never
-    // be removed by other edits so an iterator pointing at the item
-    // remains valid until we remove the dummy item in deleteCursor().
-    // nextCursor() finds the next non-dummy item, moves our dummy
-    // item just past it, and returns an iterator for the non-dummy
-    // item.  all cursor calls lock the mutex for their duration.
-    JobCursor            newCursor();
-    JobCursor            nextCursor(JobCursor);
-    void                deleteCursor(JobCursor);
-
-    // lock out locking the job list.  this blocks if another thread
-    // has already locked out locking.  once it returns, only the
-    // calling thread will be able to lock the job list after any
-    // current lock is released.
-    void                lockJobListLock();
-
-    // lock the job list.  this blocks if the job list is already
-    // locked.  the calling thread must have called requestJobLock.
-    void                lockJobList();
-
-    // unlock the job list and the lock out on locking.
-    void                unlockJobList();
+    // a reactor and the number of sockets assigned to it
+    class ReactorSlot {
+    public:
+        SocketReactor*  m_reactor;
+        size_t          m_sockets;
+    };
+
+    typedef std::vector<ReactorSlot> ReactorList;
+    typedef std::map<ISocket*, size_t> SocketReactorMap;
+
+    // get the reactor for a socket, assigning one if it has none.  the
+    // caller must hold m_mutex.
+    SocketReactor*      assignReactor(ISocket*);
+
+    // release the assignment of a socket whose job on reactor index
+    // removed itself, unless it has been given another job since.
+    // called on the reactor's service thread.
+    void                jobRemoved(size_t index, ISocket*);
 
 private:
-    Mutex*                m_mutex;
-    Thread*                m_thread;
-    bool                m_update;
-    CondVar<bool>*        m_jobsReady;
-    CondVar<bool>*        m_jobListLock;
-    CondVar<bool>*        m_jobListLockLocked;
-    Thread*                m_jobListLocker;
-    Thread*                m_jobListLockLocker;
-
-    SocketJobs            m_socketJobs;
-    SocketJobMap        m_socketJobMap;
-    ISocketMultiplexerJob*
-                        m_cursorMark;
+    Mutex*              m_mutex;
+    ReactorList         m_reactors;
+    SocketReactorMap    m_socketReactorMap;
 };
@@ -0,0 +1,499 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2012-2016 Symless Ltd.
+ * Copyright (C) 2004 Chris Schoeneman
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/SocketReactor.h"
+
+#include "net/ISocketMultiplexerJob.h"
+#include "mt/CondVar.h"
+#include "mt/Lock.h"
+#include "mt/Mutex.h"
+#include "mt/Thread.h"
+#include "arch/Arch.h"
+#include "arch/XArch.h"
+#include "base/Log.h"
+#include "base/TMethodJob.h"
+#include "common/stdvector.h"
+
+// maximum number of ready sockets handled per wait on the poll set
+static const int s_maxReadyJobs = 64;
+
+// number of queued operations that don't need an allocation
+static const UInt32 s_operationPoolSize = 256;
+
+//
+// SocketReactor
+//
+
+SocketReactor::SocketReactor(const JobRemovedFunc& jobRemoved) :
+    m_jobRemoved(jobRemoved),
+    m_mutex(new Mutex),
+    m_thread(NULL),
+    m_pollSet(NULL),
+    m_jobsReady(new CondVarBase(m_mutex)),
+    m_jobDone(new CondVarBase(m_mutex)),
+    m_update(false),
+    m_runningJobs(false),
+    m_operations(NULL),
+    m_operationPool(new JobOperation[s_operationPoolSize]),
+    m_freeOperations(0),
+    m_pendingRemovals(0),
+    m_running(NULL),
+    m_runningWaiters(0),
+    m_idle(false)
+{
+    for (UInt32 i = 0; i < s_operationPoolSize; ++i) {
+        releaseOperation(&m_operationPool[i]);
+    }
+
+    // use a persistent poll set if the platform has one, otherwise
+    // fall back to polling all of the jobs on each pass
+    try {
+        m_pollSet = ARCH->newPollSet();
+    }
+    catch (XArchNetwork& e) {
+        LOG((CLOG_WARN "failed to create poll set: %s", e.what()));
+        m_pollSet = NULL;
+    }
+
+    // start thread
+    m_thread = new Thread(new TMethodJob<SocketReactor>(
+                                this, &SocketReactor::serviceThread));
+}
+
+SocketReactor::~SocketReactor()
+{
+    m_thread->cancel();
+    m_thread->unblockPollSocket();
+    m_thread->wait();
+    delete m_thread;
+
+    // clean up jobs, including any still queued
+    applyOperations();
+    for (SocketJobMap::iterator i = m_socketJobMap.begin();
+                        i != m_socketJobMap.end(); ++i) {
+        delete i->second;
+    }
+
+    if (m_pollSet != NULL) {
+        ARCH->closePollSet(m_pollSet);
+    }
+    delete[] m_operationPool;
+    delete m_jobsReady;
+    delete m_jobDone;
+    delete m_mutex;
+}
+
+void
+SocketReactor::addSocket(ISocket* socket, ISocketMultiplexerJob* job)
+{
+    assert(socket != NULL);
+    assert(job    != NULL);
+
+    queueOperation(socket, job);
+}
+
+void
+SocketReactor::removeSocket(ISocket* socket)
+{
+    assert(socket != NULL);
+
+    // count the removal before queueing it.  the service thread checks
+    // the count after saying which job it's about to run so either it
+    // sees the removal or we see the job running.
+    ++m_pendingRemovals;
+    queueOperation(socket, NULL);
+
+    // if the job is running then wait for it to finish since the caller
+    // may destroy the socket as soon as we return.  a job removing its
+    // own socket must not wait for itself.
+    if (m_running == socket && !(Thread::getCurrentThread() == *m_thread)) {
+        ++m_runningWaiters;
+        try {
+            Lock lock(m_mutex);
+            while (m_running == socket) {
+                m_jobDone->wait();
+            }
+        }
+        catch (...) {
+            --m_runningWaiters;
+            throw;
+        }
+        --m_runningWaiters;
+    }
+}
+
+void
+SocketReactor::queueOperation(ISocket* socket, ISocketMultiplexerJob* job)
+{
+    JobOperation* op = newOperation();
+    op->m_socket = socket;
+    op->m_job    = job;
+
+    // push onto the stack.  on failure head is reloaded for the retry.
+    JobOperation* head = m_operations.load();
+    do {
+        op->m_next = head;
+    } while (!m_operations.compare_exchange_weak(head, op));
+
+    // if the queue wasn't empty then the service thread has already
+    // been woken and will see this operation with the others.
+    if (head == NULL) {
+        if (m_idle) {
+            Lock lock(m_mutex);
+            m_jobsReady->signal();
+        }
+        else {
+            m_thread->unblockPollSocket();
+        }
+    }
+}
+
+bool
+SocketReactor::hasQueuedOperation(ISocket* socket) const
+{
+    // only the service thread releases nodes so the stack can be walked
+    // while other threads push onto it
+    for (const JobOperation* op = m_operations.load();
+                        op != NULL; op = op->m_next) {
+        if (op->m_socket == socket) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SocketReactor::JobOperation*
+SocketReactor::newOperation()
+{
+    std::uint64_t head = m_freeOperations.load();
+    for (;;) {
+        UInt32 index = static_cast<UInt32>(head);
+        if (index == 0) {
+            return new JobOperation;
+        }
+
+        // the node may be taken and reused by the time we read its link
+        // but then the pop count has changed and the exchange fails
+        JobOperation* op = &m_operationPool[index - 1];
+        std::uint64_t next      = ((head >> 32) + 1) << 32 |
+                            op->m_nextFree.load(std::memory_order_relaxed);
+        if (m_freeOperations.compare_exchange_weak(head, next)) {
+            return op;
+        }
+    }
+}
+
+void
+SocketReactor::releaseOperation(JobOperation* op)
+{
+    if (op < m_operationPool || op >= m_operationPool + s_operationPoolSize) {
+        delete op;
+        return;
+    }
+
+    std::uint64_t index = static_cast<std::uint64_t>(op - m_operationPool) + 1;
+    std::uint64_t head  = m_freeOperations.load();
+    do {
+        op->m_nextFree.store(static_cast<UInt32>(head),
+                            std::memory_order_relaxed);
+    } while (!m_freeOperations.compare_exchange_weak(head,
+                            (head & 0xffffffff00000000ull) | index));
+}
+
+void
+SocketReactor::applyOperations()
+{
+    // erase the sockets whose jobs were removed while jobs were running
+    if (!m_runningJobs) {
+        for (ISocket* socket : m_removedJobs) {
+            SocketJobMap::iterator i = m_socketJobMap.find(socket);
+            if (i != m_socketJobMap.end() && i->second == NULL) {
+                m_socketJobMap.erase(i);
+            }
+        }
+        m_removedJobs.clear();
+    }
+
+    // take the whole stack and reverse it so the operations are applied
+    // in the order they were queued
+    JobOperation* ops  = NULL;
+    JobOperation* head = m_operations.exchange(NULL);
+    while (head != NULL) {
+        JobOperation* next = head->m_next;
+        head->m_next = ops;
+        ops          = head;
+        head         = next;
+    }
+
+    while (ops != NULL) {
+        JobOperation* op = ops;
+        ops = op->m_next;
+
+        SocketJobMap::iterator i = m_socketJobMap.find(op->m_socket);
+        if (op->m_job == NULL) {
+            // remove job
+            if (i != m_socketJobMap.end() && i->second != NULL) {
+                updatePollSet(op->m_socket, i->second, NULL);
+                delete i->second;
+                i->second = NULL;
+                removedJob(i);
+            }
+            --m_pendingRemovals;
+        }
+        else if (i == m_socketJobMap.end()) {
+            // insert job
+            m_socketJobMap.insert(std::make_pair(op->m_socket, op->m_job));
+            updatePollSet(op->m_socket, NULL, op->m_job);
+            m_update = true;
+        }
+        else if (i->second != op->m_job) {
+            // replace job
+            updatePollSet(op->m_socket, i->second, op->m_job);
+            delete i->second;
+            i->second = op->m_job;
+            m_update  = true;
+        }
+        releaseOperation(op);
+    }
+}
+
+void
+SocketReactor::removedJob(SocketJobMap::iterator i)
+{
+    m_update = true;
+    if (m_runningJobs) {
+        m_removedJobs.push_back(i->first);
+    }
+    else {
+        m_socketJobMap.erase(i);
+    }
+}
+
+void
+SocketReactor::serviceThread(void*)
+{
+    std::vector<IArchNetwork::PollEntry> pfds;
+
+    // service the connections
+    for (;;) {
+        Thread::testCancel();
+
+        // pick up changes to the jobs
+        applyOperations();
+
+        // wait until there are jobs to handle
+        if (m_socketJobMap.empty()) {
+            Lock lock(m_mutex);
+            m_idle = true;
+            while (m_operations.load() == NULL) {
+                m_jobsReady->wait();
+            }
+            m_idle = false;
+            continue;
+        }
+
+        // wait for and run ready jobs
+        if (m_pollSet != NULL) {
+            servicePollSet();
+        }
+        else {
+            servicePoll(pfds);
+        }
+    }
+}
+
+void
+SocketReactor::servicePollSet()
+{
+    IArchNetwork::PollSetEntry ready[s_maxReadyJobs];
+
+    int n;
+    try {
+        // the poll set already reflects the jobs so there's no need to
+        // look at m_update
+        n = ARCH->waitPollSet(m_pollSet, ready, s_maxReadyJobs, -1);
+    }
+    catch (XArchNetwork& e) {
+        LOG((CLOG_WARN "error in socket reactor: %s", e.what()));
+        n = 0;
+    }
+
+    m_runningJobs = true;
+    for (int k = 0; k < n; ++k) {
+        // find the job.  the socket may have been removed since the
+        // poll set reported it.
+        ISocket* socket = static_cast<ISocket*>(ready[k].m_data);
+        SocketJobMap::iterator i = m_socketJobMap.find(socket);
+        if (i != m_socketJobMap.end()) {
+            runJob(i, ready[k].m_revents);
+        }
+    }
+    m_runningJobs = false;
+}
+
+void
+SocketReactor::servicePoll(std::vector<IArchNetwork::PollEntry>& pfds)
+{
+    IArchNetwork::PollEntry pfd;
+
+    // collect poll entries
+    if (m_update) {
+        m_update = false;
+        pfds.clear();
+        pfds.reserve(m_socketJobMap.size());
+        m_pollJobs.clear();
+        m_pollJobs.reserve(m_socketJobMap.size());
+
+        for (SocketJobMap::iterator i = m_socketJobMap.begin();
+                            i != m_socketJobMap.end(); ++i) {
+            ISocketMultiplexerJob* job = i->second;
+            if (job != NULL) {
+                pfd.m_socket = job->getSocket();
+                pfd.m_events = 0;
+                if (job->isReadable()) {
+                    pfd.m_events |= IArchNetwork::kPOLLIN;
+                }
+                if (job->isWritable()) {
+                    pfd.m_events |= IArchNetwork::kPOLLOUT;
+                }
+                pfds.push_back(pfd);
+                m_pollJobs.push_back(i);
+            }
+        }
+    }
+
+    int status;
+    try {
+        // check for status
+        if (!pfds.empty()) {
+            status = ARCH->pollSocket(&pfds[0], (int)pfds.size(), -1);
+        }
+        else {
+            status = 0;
+        }
+    }
+    catch (XArchNetwork& e) {
+        LOG((CLOG_WARN "error in socket reactor: %s", e.what()));
+        status = 0;
+    }
+
+    if (status > 0) {
+        // run the jobs with events.  m_pollJobs stays valid while we do
+        // since removed jobs aren't erased until the next pass.
+        m_runningJobs = true;
+        for (size_t i = 0; i < pfds.size(); ++i) {
+            if (pfds[i].m_revents != 0) {
+                runJob(m_pollJobs[i], pfds[i].m_revents);
+            }
+        }
+        m_runningJobs = false;
+    }
+}
+
+void
+SocketReactor::runJob(SocketJobMap::iterator i, unsigned short revents)
+{
+    // say which socket we're about to run.  if a removal is pending then
+    // apply it first since the socket's owner may be about to destroy it.
+    m_running = i->first;
+    if (m_pendingRemovals != 0) {
+        applyOperations();
+    }
+
+    // the job may have changed since the socket was polled so only pass
+    // on the events it's interested in
+    ISocketMultiplexerJob* job = i->second;
+    if (job != NULL) {
+        bool read  = ((revents & IArchNetwork::kPOLLIN) != 0) &&
+                        job->isReadable();
+        bool write = ((revents & IArchNetwork::kPOLLOUT) != 0) &&
+                        job->isWritable();
+        bool error = ((revents & (IArchNetwork::kPOLLERR |
+                                  IArchNetwork::kPOLLNVAL)) != 0);
+
+        // run job
+        ISocketMultiplexerJob* newJob = job->run(read, write, error);
+
+        // save job, if different
+        if (newJob != job) {
+            ISocket* socket = i->first;
+            updatePollSet(socket, job, newJob);
+            delete job;
+            i->second = newJob;
+            if (newJob == NULL) {
+                removedJob(i);
+                if (m_jobRemoved) {
+                    m_jobRemoved(socket);
+                }
+            }
+            else {
+                m_update = true;
+            }
+        }
+    }
+
+    // done with the job.  wake removeSocket() if it's waiting on us.
+    m_running = NULL;
+    if (m_runningWaiters != 0) {
+        Lock lock(m_mutex);
+        m_jobDone->broadcast();
+    }
+}
+
+void
+SocketReactor::updatePollSet(ISocket* socket,
+                ISocketMultiplexerJob* oldJob, ISocketMultiplexerJob* newJob)
+{
+    if (m_pollSet == NULL) {
+        return;
+    }
+
+    unsigned short oldEvents = 0;
+    if (oldJob != NULL) {
+        if (oldJob->isReadable()) {
+            oldEvents |= IArchNetwork::kPOLLIN;
+        }
+        if (oldJob->isWritable()) {
+            oldEvents |= IArchNetwork::kPOLLOUT;
+        }
+    }
+    unsigned short newEvents = 0;
+    if (newJob != NULL) {
+        if (newJob->isReadable()) {
+            newEvents |= IArchNetwork::kPOLLIN;
+        }
+        if (newJob->isWritable()) {
+            newEvents |= IArchNetwork::kPOLLOUT;
+        }
+    }
+
+    try {
+        if (oldJob != NULL && (newJob == NULL ||
+                oldJob->getSocket() != newJob->getSocket())) {
+            ARCH->removeFromPollSet(m_pollSet, oldJob->getSocket());
+            oldJob = NULL;
+        }
+        if (newJob != NULL && (oldJob == NULL || oldEvents != newEvents)) {
+            ARCH->updatePollSet(m_pollSet, newJob->getSocket(),
+                                newEvents, socket);
+        }
+    }
+    catch (XArchNetwork& e) {
+        LOG((CLOG_WARN "error updating socket reactor: %s", e.what()));
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2012-2016 Symless Ltd.
+ * Copyright (C) 2004 Chris Schoeneman
+ * 
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ * 
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "arch/IArchNetwork.h"
+#include "common/basic_types.h"
+#include "common/stdmap.h"
+#include "common/stdvector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+class CondVarBase;
+class Mutex;
+class Thread;
+class ISocket;
+class ISocketMultiplexerJob;
+
+//! Socket reactor
+/*!
+A socket reactor services multiple sockets simultaneously on a single
+service thread.  SocketMultiplexer spreads sockets across one or more
+reactors.
+
+Changes to the jobs are queued without locking and picked up by the
+service thread between waits so threads changing jobs don't block
+behind the service thread.  Queued changes use nodes from a fixed pool
+so they don't allocate unless many are queued at once.
+*/
+class SocketReactor {
+public:
+    typedef std::function<void(ISocket*)> JobRemovedFunc;
+
+    //! Create a reactor
+    /*!
+    \c jobRemoved, if set, is called on the service thread when a job
+    removes its socket by returning NULL.
+    */
+    explicit SocketReactor(const JobRemovedFunc& jobRemoved = JobRemovedFunc());
+    SocketReactor(SocketReactor const &) =delete;
+    SocketReactor(SocketReactor &&) =delete;
+    ~SocketReactor();
+
+    SocketReactor& operator=(SocketReactor const &) =delete;
+    SocketReactor& operator=(SocketReactor &&) =delete;
+
+    //! @name manipulators
+    //@{
+
+    //! Set the job for a socket
+    /*!
+    Queues \c job to service \c socket, replacing and deleting any
+    job the socket already has.  The reactor takes ownership of
+    \c job.  This does not block.
+    */
+    void                addSocket(ISocket*, ISocketMultiplexerJob*);
+
+    //! Remove the job for a socket
+    /*!
+    Queues the removal of the job for \c socket.  When this returns
+    the job is not running and will never run again, so the caller is
+    free to destroy the socket.  This only blocks if the job happens
+    to be running at the time.
+    */
+    void                removeSocket(ISocket*);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Check for queued changes to a socket's job
+    /*!
+    Returns true if a change to the job for \c socket is queued but not
+    yet applied.  Only call this on the service thread, like from the
+    job removed callback.
+    */
+    bool                hasQueuedOperation(ISocket* socket) const;
+
+    //@}
+
+private:
+    // a queued change to the jobs.  a NULL job removes the socket.
+    class JobOperation {
+    public:
+        ISocket*        m_socket;
+        ISocketMultiplexerJob*
+                        m_job;
+        JobOperation*    m_next;
+
+        // 1 + index of the next free node in the pool, 0 for none
+        std::atomic<UInt32>
+                        m_nextFree;
+    };
+
+    // jobs by socket.  only the service thread uses the map.  removed
+    // jobs are set to NULL rather than erased so iterators stay valid
+    // while the service thread is running jobs.
+    typedef std::map<ISocket*, ISocketMultiplexerJob*> SocketJobMap;
+
+    // push an operation onto the queue, waking the service thread if
+    // the queue was empty.
+    void                queueOperation(ISocket*, ISocketMultiplexerJob*);
+
+    // get an operation node from the pool or, if it's empty, the heap
+    // and give it back.  any thread may take a node but only the
+    // service thread releases them.
+    JobOperation*       newOperation();
+    void                releaseOperation(JobOperation*);
+
+    // apply the queued operations in the order they were queued and
+    // erase the sockets whose jobs were removed.  only called by the
+    // service thread.  while it's running jobs the erasing is left to
+    // the next call so iterators stay valid.
+    void                applyOperations();
+
+    // note that the socket's job was removed
+    void                removedJob(SocketJobMap::iterator);
+
+    // service sockets
+    void                serviceThread(void*);
+
+    // wait for and run ready jobs using the persistent poll set
+    void                servicePollSet();
+
+    // wait for and run ready jobs using pollSocket(), rebuilding the
+    // poll entries in pfds if the jobs changed
+    void                servicePoll(std::vector<IArchNetwork::PollEntry>& pfds);
+
+    // run the job for a socket that has events \c revents and save the
+    // job it returns
+    void                runJob(SocketJobMap::iterator, unsigned short revents);
+
+    // change the registration of socket in the poll set to reflect a
+    // change of its job from oldJob to newJob.  either job may be NULL.
+    // this only touches the poll set if the socket or the events of
+    // interest differ between the jobs.
+    void                updatePollSet(ISocket* socket,
+                            ISocketMultiplexerJob* oldJob,
+                            ISocketMultiplexerJob* newJob);
+
+private:
+    JobRemovedFunc        m_jobRemoved;
+    Mutex*                m_mutex;
+    Thread*                m_thread;
+    ArchPollSet            m_pollSet;
+    CondVarBase*        m_jobsReady;
+    CondVarBase*        m_jobDone;
+
+    // state owned by the service thread
+    bool                m_update;
+    bool                m_runningJobs;
+    SocketJobMap        m_socketJobMap;
+    std::vector<SocketJobMap::iterator>
+                        m_pollJobs;
+    std::vector<ISocket*>
+                        m_removedJobs;
+
+    // state shared with other threads.  m_operations is the head of
+    // a lock-free stack of queued operations.  m_freeOperations is the
+    // head of the stack of free nodes in m_operationPool with a count
+    // of pops in the high 32 bits so a node that was popped and pushed
+    // again in between doesn't fool a pop.  m_running is the socket
+    // whose job is being run, if any.
+    std::atomic<JobOperation*>
+                        m_operations;
+    JobOperation*        m_operationPool;
+    std::atomic<std::uint64_t>    m_freeOperations;
+    std::atomic<int>    m_pendingRemovals;
+    std::atomic<ISocket*>
+                        m_running;
+    std::atomic<int>    m_runningWaiters;
+    std::atomic<bool>    m_idle;
+};
@@ -35,9 +35,11 @@
 // TCPListenSocket
 //
 
-TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family) :
+TCPListenSocket::TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                IArchNetwork::EAddressFamily family, int backlog) :
     m_events(events),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    m_backlog(backlog)
 {
     m_mutex = new Mutex;
     try {
@@ -70,7 +72,7 @@ TCPListenSocket::bind(const NetworkAddress& addr)
         Lock lock(m_mutex);
         ARCH->setReuseAddrOnSocket(m_socket, true);
         ARCH->bindSocket(m_socket, addr.getAddress());
-        ARCH->listenOnSocket(m_socket);
+        ARCH->listenOnSocket(m_socket, m_backlog);
         m_socketMultiplexer->addSocket(this,
                             new TSocketMultiplexerMethodJob<TCPListenSocket>(
                                 this, &TCPListenSocket::serviceListening,
@@ -110,28 +112,35 @@ TCPListenSocket::getEventTarget() const
 IDataSocket*
 TCPListenSocket::accept()
 {
-    IDataSocket* socket = NULL;
-    try {
-        socket = new TCPSocket(m_events, m_socketMultiplexer, ARCH->acceptSocket(m_socket, NULL));
-        if (socket != NULL) {
-            setListeningJob();
+    ArchSocket socket;
+    while ((socket = acceptSocket()) != NULL) {
+        try {
+            return new TCPSocket(m_events, m_socketMultiplexer, socket);
         }
-        return socket;
-    }
-    catch (XArchNetwork&) {
-        if (socket != NULL) {
-            delete socket;
-            setListeningJob();
+        catch (XSocket& e) {
+            // the socket is closed.  try the next connection.
+            LOG((CLOG_WARN "failed to accept connection: %s", e.what()));
         }
-        return NULL;
     }
-    catch (std::exception &ex) {
-        if (socket != NULL) {
-            delete socket;
-            setListeningJob();
-        }
-        throw ex;
+    return NULL;
+}
+
+ArchSocket
+TCPListenSocket::acceptSocket()
+{
+    ArchSocket socket = NULL;
+    try {
+        socket = ARCH->acceptSocket(m_socket, NULL);
+    }
+    catch (XArchNetwork& e) {
+        LOG((CLOG_WARN "failed to accept connection: %s", e.what()));
+    }
+
+    // wait for more connections once all pending ones are accepted
+    if (socket == NULL) {
+        setListeningJob();
     }
+    return socket;
 }
 
 void
@@ -32,7 +32,12 @@ A listen socket using TCP.
 */
 class TCPListenSocket : public IListenSocket {
 public:
-    TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family);
+    /*!
+    \c backlog is the number of connections left waiting to be accepted;
+    zero or less uses the system maximum.
+    */
+    TCPListenSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                            IArchNetwork::EAddressFamily family, int backlog = 0);
     TCPListenSocket(TCPListenSocket const &) =delete;
     TCPListenSocket(TCPListenSocket &&) =delete;
     virtual ~TCPListenSocket();
@@ -52,6 +57,13 @@ public:
 protected:
     void                setListeningJob();
 
+    //! Accept pending connection
+    /*!
+    Returns the next pending connection or NULL, after going back to
+    watching for connections, if there are none left.
+    */
+    ArchSocket            acceptSocket();
+
 public:
     ISocketMultiplexerJob*
                         serviceListening(ISocketMultiplexerJob*,
@@ -62,4 +74,5 @@ protected:
     Mutex*                m_mutex;
     IEventQueue*        m_events;
     SocketMultiplexer*    m_socketMultiplexer;
+    int                    m_backlog;
 };
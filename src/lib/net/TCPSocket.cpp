@@ -33,6 +33,28 @@
 #include <cstdlib>
 #include <memory>
 
+// bytes of buffer space offered to each read from the socket
+static const UInt32 s_readSize = 65536;
+
+// maximum number of buffer segments passed to one read or write
+static const int s_maxSegments = 32;
+
+// translate stream buffer segments for the socket layer and return
+// their total size
+static
+size_t
+toIOVectors(const StreamBuffer::Segment* segments, int num,
+                IArchNetwork::IOVector* vectors)
+{
+    size_t size = 0;
+    for (int i = 0; i < num; ++i) {
+        vectors[i].m_data = segments[i].m_data;
+        vectors[i].m_size = segments[i].m_size;
+        size += segments[i].m_size;
+    }
+    return size;
+}
+
 //
 // TCPSocket
 //
@@ -42,7 +64,16 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
     m_events(events),
     m_mutex(),
     m_flushed(&m_mutex, true),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    m_batchDepth(0),
+    m_batchPending(false),
+    m_corked(false),
+    m_batchMember(this),
+    // output is unlimited until setOutputLimits()
+    m_lowWater(0),
+    m_highWater(0),
+    m_hardLimit(0),
+    m_congested(false)
 {
     try {
         m_socket = ARCH->newSocket(family, IArchNetwork::kSTREAM);
@@ -56,13 +87,22 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
     init();
 }
 
-TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket) :
+TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket, bool service) :
     IDataSocket(events),
     m_events(events),
     m_mutex(),
     m_socket(socket),
     m_flushed(&m_mutex, true),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    m_batchDepth(0),
+    m_batchPending(false),
+    m_corked(false),
+    m_batchMember(this),
+    // output is unlimited until setOutputLimits()
+    m_lowWater(0),
+    m_highWater(0),
+    m_hardLimit(0),
+    m_congested(false)
 {
     assert(m_socket != nullptr);
 
@@ -71,11 +111,16 @@ TCPSocket::TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
     // socket starts in connected state
     init();
     onConnected();
-    setJob(newJob());
+    if (service) {
+        setJob(newJob());
+    }
 }
 
 TCPSocket::~TCPSocket()
 {
+    // don't let an open event batch end a batch on us
+    EventBatch::leave(&m_batchMember);
+
     try {
         // warning virtual function in destructor is very danger practice
         close();
@@ -110,6 +155,8 @@ TCPSocket::close()
     Lock lock(&m_mutex);
 
     // clear buffers and enter disconnected state
+    m_batchPending = false;
+    m_corked       = false;
     if (m_connected) {
         sendEvent(m_events->forISocket().disconnected());
     }
@@ -144,10 +191,7 @@ TCPSocket::read(void* buffer, UInt32 n)
     if (n > size) {
         n = size;
     }
-    if (buffer != nullptr && n != 0) {
-        memcpy(buffer, m_inputBuffer.peek(n), n);
-    }
-    m_inputBuffer.pop(n);
+    m_inputBuffer.read(buffer, n);
 
     // if no more data and we cannot read or write then send disconnected
     if (n > 0 && m_inputBuffer.getSize() == 0 && !m_readable && !m_writable) {
@@ -161,6 +205,19 @@ TCPSocket::read(void* buffer, UInt32 n)
 void
 TCPSocket::write(const void* buffer, UInt32 n)
 {
+    writeVector(&buffer, &n, 1);
+}
+
+void
+TCPSocket::writeVector(const void* const* buffers,
+                const UInt32* sizes, int count)
+{
+    // hold back writes made while handling an event until the handler
+    // returns so a burst of messages goes out together
+    if (EventBatch::join(&m_batchMember)) {
+        beginBatch();
+    }
+
     bool wasEmpty;
     {
         Lock lock(&m_mutex);
@@ -171,17 +228,32 @@ TCPSocket::write(const void* buffer, UInt32 n)
             return;
         }
 
+        // copy data to the output buffer
+        UInt32 size = m_outputBuffer.getSize();
+        wasEmpty    = (size == 0);
+        for (int i = 0; i < count; ++i) {
+            if (sizes[i] != 0) {
+                m_outputBuffer.write(buffers[i], sizes[i]);
+            }
+        }
+
         // ignore empty writes
-        if (n == 0) {
+        if (m_outputBuffer.getSize() == size) {
             return;
         }
 
-        // copy data to the output buffer
-        wasEmpty = (m_outputBuffer.getSize() == 0);
-        m_outputBuffer.write(buffer, n);
-
         // there's data to write
         m_flushed = false;
+
+        if (!checkOutputLimits()) {
+            // we gave up on the consumer.  a new job drops the socket.
+            wasEmpty = true;
+        }
+        else if (wasEmpty && m_batchDepth > 0) {
+            // in a batch the write job is made when the batch ends
+            m_batchPending = true;
+            wasEmpty       = false;
+        }
     }
 
     // make sure we're waiting to write
@@ -190,9 +262,60 @@ TCPSocket::write(const void* buffer, UInt32 n)
     }
 }
 
+void
+TCPSocket::beginBatch()
+{
+    Lock lock(&m_mutex);
+    if (m_batchDepth++ == 0 && m_socket != nullptr &&
+                        m_outputBuffer.getSize() > 0) {
+        // the write job is already running and may send part of the
+        // batch, so have the system hold back partial packets
+        m_corked = ARCH->setCorkOnSocket(m_socket, true);
+    }
+}
+
+void
+TCPSocket::endBatch()
+{
+    bool pending;
+    {
+        Lock lock(&m_mutex);
+        assert(m_batchDepth > 0);
+        if (--m_batchDepth != 0) {
+            return;
+        }
+
+        if (m_corked) {
+            m_corked = false;
+            if (m_socket != nullptr) {
+                ARCH->setCorkOnSocket(m_socket, false);
+            }
+        }
+
+        pending        = m_batchPending;
+        m_batchPending = false;
+    }
+
+    // send the batch
+    if (pending) {
+        setJob(newJob());
+    }
+}
+
 void
 TCPSocket::flush()
 {
+    // don't wait for a batch to end before sending
+    bool pending;
+    {
+        Lock lock(&m_mutex);
+        pending        = m_batchPending;
+        m_batchPending = false;
+    }
+    if (pending) {
+        setJob(newJob());
+    }
+
     Lock lock(&m_mutex);
     while (m_flushed == false) {
         m_flushed.wait();
@@ -255,6 +378,15 @@ TCPSocket::shutdownOutput()
     }
 }
 
+void
+TCPSocket::setOutputLimits(UInt32 lowWater, UInt32 highWater, UInt32 hardLimit)
+{
+    Lock lock(&m_mutex);
+    m_lowWater  = lowWater;
+    m_highWater = highWater;
+    m_hardLimit = hardLimit;
+}
+
 bool
 TCPSocket::isReady() const
 {
@@ -277,6 +409,20 @@ TCPSocket::getSize() const
     return m_inputBuffer.getSize();
 }
 
+bool
+TCPSocket::isCongested() const
+{
+    Lock lock(&m_mutex);
+    return m_congested;
+}
+
+bool
+TCPSocket::hasPendingOutput() const
+{
+    Lock lock(&m_mutex);
+    return (m_outputBuffer.getSize() > 0);
+}
+
 void
 TCPSocket::connect(const NetworkAddress& addr)
 {
@@ -336,22 +482,26 @@ TCPSocket::init()
 TCPSocket::EJobResult
 TCPSocket::doRead()
 {
-    UInt8 buffer[4096];
-    memset(buffer, 0, sizeof(buffer));
-    size_t bytesRead = 0;
-    
-    bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
-    
+    StreamBuffer::Segment segments[s_maxSegments];
+    IArchNetwork::IOVector vectors[s_maxSegments];
+
+    // read straight into free space at the end of the input buffer
+    bool wasEmpty = (m_inputBuffer.getSize() == 0);
+    int n = m_inputBuffer.reserve(s_readSize, segments, s_maxSegments);
+    size_t space = toIOVectors(segments, n, vectors);
+    size_t bytesRead = ARCH->readSocketVector(m_socket, vectors, n);
+
     if (bytesRead > 0) {
-        bool wasEmpty = (m_inputBuffer.getSize() == 0);
-        
-        // slurp up as much as possible
-        do {
-            m_inputBuffer.write(buffer, static_cast<UInt32>(bytesRead));
-
-            bytesRead = ARCH->readSocket(m_socket, buffer, sizeof(buffer));
-        } while (bytesRead > 0);
-        
+        // slurp up as much as possible.  a short read means we've
+        // drained the socket.
+        while (bytesRead == space) {
+            m_inputBuffer.commit(static_cast<UInt32>(bytesRead));
+            n = m_inputBuffer.reserve(s_readSize, segments, s_maxSegments);
+            space = toIOVectors(segments, n, vectors);
+            bytesRead = ARCH->readSocketVector(m_socket, vectors, n);
+        }
+        m_inputBuffer.commit(static_cast<UInt32>(bytesRead));
+
         // send input ready if input buffer was empty
         if (wasEmpty) {
             sendEvent(m_events->forIStream().inputReady());
@@ -369,26 +519,31 @@ TCPSocket::doRead()
         m_readable = false;
         return kNew;
     }
-    
+
     return kRetry;
 }
 
 TCPSocket::EJobResult
 TCPSocket::doWrite()
 {
-    // write data
-    UInt32 bufferSize = 0;
-    int bytesWrote = 0;
+    if (m_outputBuffer.getSize() == 0) {
+        // the job was made before the buffer was flushed.  get a job
+        // that isn't waiting to write.
+        return kNew;
+    }
 
-    bufferSize = m_outputBuffer.getSize();
-    const void* buffer = m_outputBuffer.peek(bufferSize);
-    bytesWrote = (UInt32)ARCH->writeSocket(m_socket, buffer, bufferSize);
+    // write as much of the output buffer as we can in place
+    StreamBuffer::Segment segments[s_maxSegments];
+    IArchNetwork::IOVector vectors[s_maxSegments];
+    int n = m_outputBuffer.getSegments(segments, s_maxSegments);
+    toIOVectors(segments, n, vectors);
+    size_t bytesWrote = ARCH->writeSocketVector(m_socket, vectors, n);
 
     if (bytesWrote > 0) {
-        discardWrittenData(bytesWrote);
+        discardWrittenData(static_cast<int>(bytesWrote));
         return kNew;
     }
-    
+
     return kRetry;
 }
 
@@ -432,6 +587,29 @@ TCPSocket::newJob()
     }
 }
 
+bool
+TCPSocket::checkOutputLimits()
+{
+    // note -- must have m_mutex locked on entry
+
+    UInt32 size = m_outputBuffer.getSize();
+    if (m_hardLimit != 0 && size > m_hardLimit) {
+        // give up on the consumer.  onDisconnected() discards the output.
+        LOG((CLOG_WARN "output buffer exceeded %u bytes, disconnecting", m_hardLimit));
+        onDisconnected();
+        sendEvent(m_events->forIStream().outputError());
+        sendEvent(m_events->forISocket().disconnected());
+        return false;
+    }
+
+    if (!m_congested && m_highWater != 0 && size > m_highWater) {
+        LOG((CLOG_DEBUG "output congested, %u bytes buffered", size));
+        m_congested = true;
+        sendEvent(m_events->forIStream().outputCongested());
+    }
+    return true;
+}
+
 void
 TCPSocket::sendConnectionFailedEvent(const char* msg)
 {
@@ -450,6 +628,11 @@ void
 TCPSocket::discardWrittenData(int bytesWrote)
 {
     m_outputBuffer.pop(bytesWrote);
+    if (m_congested && m_outputBuffer.getSize() <= m_lowWater) {
+        LOG((CLOG_DEBUG "output drained"));
+        m_congested = false;
+        sendEvent(m_events->forIStream().outputDrained());
+    }
     if (m_outputBuffer.getSize() == 0) {
         sendEvent(m_events->forIStream().outputFlushed());
         m_flushed = true;
@@ -476,7 +659,8 @@ void
 TCPSocket::onOutputShutdown()
 {
     m_outputBuffer.pop(m_outputBuffer.getSize());
-    m_writable = false;
+    m_writable  = false;
+    m_congested = false;
 
     // we're now flushed
     m_flushed = true;
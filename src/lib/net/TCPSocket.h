@@ -23,6 +23,7 @@
 #include "mt/CondVar.h"
 #include "mt/Mutex.h"
 #include "arch/IArchNetwork.h"
+#include "base/EventBatch.h"
 
 class Mutex;
 class Thread;
@@ -37,7 +38,13 @@ A data socket using TCP.
 class TCPSocket : public IDataSocket {
 public:
     TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, IArchNetwork::EAddressFamily family = IArchNetwork::kINET);
-    TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket);
+    //! Create an accepted socket
+    /*!
+    The socket is serviced right away unless \c service is false, for
+    subclasses that must finish constructing first.  Those call
+    \c setJob() when they're ready.
+    */
+    TCPSocket(IEventQueue* events, SocketMultiplexer* socketMultiplexer, ArchSocket socket, bool service = true);
     TCPSocket(TCPSocket const &) =delete;
     TCPSocket(TCPSocket &&) =delete;
     virtual ~TCPSocket();
@@ -53,12 +60,20 @@ public:
     // IStream overrides
     virtual UInt32        read(void* buffer, UInt32 n);
     virtual void        write(const void* buffer, UInt32 n);
+    virtual void        writeVector(const void* const* buffers,
+                            const UInt32* sizes, int count);
+    virtual void        beginBatch();
+    virtual void        endBatch();
     virtual void        flush();
     virtual void        shutdownInput();
     virtual void        shutdownOutput();
+    virtual void        setOutputLimits(UInt32 lowWater,
+                            UInt32 highWater, UInt32 hardLimit);
     virtual bool        isReady() const;
     virtual bool        isFatal() const;
     virtual UInt32        getSize() const;
+    virtual bool        isCongested() const;
+    virtual bool        hasPendingOutput() const;
 
     // IDataSocket overrides
     virtual void        connect(const NetworkAddress&);
@@ -90,8 +105,23 @@ protected:
     void                discardWrittenData(int bytesWrote);
 
 private:
+    // ends the batch a socket joined to hold back its writes while an
+    // event is handled
+    class BatchMember : public EventBatch::IMember {
+    public:
+        BatchMember(TCPSocket* socket) : m_socket(socket) { }
+
+        // EventBatch::IMember overrides
+        virtual void    batchClosed() { m_socket->endBatch(); }
+
+    private:
+        TCPSocket*        m_socket;
+    };
+
     void                init();
 
+    bool                checkOutputLimits();
+
     void                sendConnectionFailedEvent(const char*);
     void                onConnected();
     void                onInputShutdown();
@@ -118,4 +148,19 @@ private:
     ArchSocket            m_socket;
     CondVar<bool>        m_flushed;
     SocketMultiplexer*    m_socketMultiplexer;
+
+    // write batching.  m_batchPending is true if data was written during
+    // the batch that the write job wasn't told about, and m_corked is true
+    // if the socket was corked when the batch began.
+    int                    m_batchDepth;
+    bool                m_batchPending;
+    bool                m_corked;
+    BatchMember            m_batchMember;
+
+    // output limits.  m_congested is true from when the output buffer
+    // grows past m_highWater until it falls back to m_lowWater.
+    UInt32                m_lowWater;
+    UInt32                m_highWater;
+    UInt32                m_hardLimit;
+    bool                m_congested;
 };
@@ -28,9 +28,14 @@
 // TCPSocketFactory
 //
 
-TCPSocketFactory::TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer) :
+TCPSocketFactory::TCPSocketFactory(IEventQueue* events,
+                SocketMultiplexer* socketMultiplexer,
+                SocketMultiplexer* handshakeMultiplexer,
+                bool kernelTls) :
     m_events(events),
-    m_socketMultiplexer(socketMultiplexer)
+    m_socketMultiplexer(socketMultiplexer),
+    m_handshakeMultiplexer(handshakeMultiplexer),
+    m_kernelTls(kernelTls)
 {
     // do nothing
 }
@@ -46,6 +51,8 @@ TCPSocketFactory::create(bool secure, IArchNetwork::EAddressFamily family) const
     if (secure) {
         SecureSocket* secureSocket = new SecureSocket(m_events, m_socketMultiplexer, family);
         secureSocket->initSsl (false);
+        secureSocket->setHandshakeMultiplexer(m_handshakeMultiplexer);
+        secureSocket->setKernelTls(m_kernelTls);
         return secureSocket;
     }
     else {
@@ -54,14 +61,16 @@ TCPSocketFactory::create(bool secure, IArchNetwork::EAddressFamily family) const
 }
 
 IListenSocket*
-TCPSocketFactory::createListen(bool secure, IArchNetwork::EAddressFamily family) const
+TCPSocketFactory::createListen(bool secure, IArchNetwork::EAddressFamily family,
+                int backlog) const
 {
     IListenSocket* socket = NULL;
     if (secure) {
-        socket = new SecureListenSocket(m_events, m_socketMultiplexer, family);
+        socket = new SecureListenSocket(m_events, m_socketMultiplexer, family, backlog,
+                            m_handshakeMultiplexer, m_kernelTls);
     }
     else {
-        socket = new TCPListenSocket(m_events, m_socketMultiplexer, family);
+        socket = new TCPListenSocket(m_events, m_socketMultiplexer, family, backlog);
     }
 
     return socket;
@@ -27,16 +27,28 @@ class SocketMultiplexer;
 //! Socket factory for TCP sockets
 class TCPSocketFactory : public ISocketFactory {
 public:
-    TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer);
+    //! Constructor
+    /*!
+    Secure sockets run their tls handshake on \c handshakeMultiplexer if
+    it's not NULL, otherwise on \c socketMultiplexer.  Both must outlive
+    the sockets.  If \c kernelTls is true secure sockets try to have the
+    kernel encrypt after the handshake.
+    */
+    TCPSocketFactory(IEventQueue* events, SocketMultiplexer* socketMultiplexer,
+                            SocketMultiplexer* handshakeMultiplexer = NULL,
+                            bool kernelTls = false);
     virtual ~TCPSocketFactory();
 
     // ISocketFactory overrides
     virtual IDataSocket*
                         create(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET) const;
     virtual IListenSocket*
-                        createListen(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET) const;
+                        createListen(bool secure, IArchNetwork::EAddressFamily family = IArchNetwork::kINET,
+                            int backlog = 0) const;
 
 private:
     IEventQueue*        m_events;
     SocketMultiplexer*    m_socketMultiplexer;
+    SocketMultiplexer*    m_handshakeMultiplexer;
+    bool                m_kernelTls;
 };
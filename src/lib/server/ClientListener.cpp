@@ -36,7 +36,8 @@
 ClientListener::ClientListener(const NetworkAddress& address,
                 ISocketFactory* socketFactory,
                 IEventQueue* events,
-                bool enableCrypto) :
+                bool enableCrypto,
+                int backlog) :
     m_socketFactory(socketFactory),
     m_server(NULL),
     m_events(events),
@@ -45,7 +46,8 @@ ClientListener::ClientListener(const NetworkAddress& address,
     assert(m_socketFactory != NULL);
 
     try {
-        m_listen = m_socketFactory->createListen(m_useSecureNetwork, ARCH->getAddrFamily(address.getAddress()));
+        m_listen = m_socketFactory->createListen(m_useSecureNetwork,
+                            ARCH->getAddrFamily(address.getAddress()), backlog);
 
         // setup event handler
         m_events->adoptHandler(m_events->forIListenSocket().connecting(),
@@ -122,25 +124,23 @@ ClientListener::getNextClient()
 void
 ClientListener::handleClientConnecting(const Event&, void*)
 {
-    // accept client connection
-    IDataSocket* socket = m_listen->accept();
-
-    if (socket == NULL) {
-        return;
-    }
-    
-    m_clientSockets.insert(socket);
+    // accept every pending connection.  clients tend to reconnect all at
+    // once, e.g. after the server restarts.
+    IDataSocket* socket;
+    while ((socket = m_listen->accept()) != NULL) {
+        m_clientSockets.insert(socket);
+
+        m_events->adoptHandler(m_events->forClientListener().accepted(),
+                    socket->getEventTarget(),
+                    new TMethodEventJob<ClientListener>(this,
+                            &ClientListener::handleClientAccepted, socket));
 
-    m_events->adoptHandler(m_events->forClientListener().accepted(),
-                socket->getEventTarget(),
-                new TMethodEventJob<ClientListener>(this,
-                        &ClientListener::handleClientAccepted, socket));
-    
-    // When using non SSL, server accepts clients immediately, while SSL
-    // has to call secure accept which may require retry
-    if (!m_useSecureNetwork) {
-        m_events->addEvent(Event(m_events->forClientListener().accepted(),
-                                socket->getEventTarget()));
+        // When using non SSL, server accepts clients immediately, while SSL
+        // has to call secure accept which may require retry
+        if (!m_useSecureNetwork) {
+            m_events->addEvent(Event(m_events->forClientListener().accepted(),
+                                    socket->getEventTarget()));
+        }
     }
 }
 
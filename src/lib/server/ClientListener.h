@@ -35,11 +35,13 @@ class IDataSocket;
 
 class ClientListener {
 public:
-    // The factories are adopted.
+    // The factories are adopted.  backlog is the number of connections
+    // left waiting to be accepted, zero or less for the system maximum.
     ClientListener(const NetworkAddress&,
                             ISocketFactory*,
                             IEventQueue* events,
-                            bool enableCrypto);
+                            bool enableCrypto,
+                            int backlog = 0);
     ClientListener(ClientListener const &) =delete;
     ClientListener(ClientListener &&) =delete;
     ~ClientListener();
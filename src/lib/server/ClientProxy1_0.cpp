@@ -27,6 +27,14 @@
 
 #include <cstring>
 
+// output limits for a client.  clipboard and file data goes out in 512 KB
+// chunks so the high water mark leaves room for a couple of chunks.
+// the senders hold back while the client is congested, so only a client
+// that stops reading reaches the hard limit.
+static const UInt32 s_outputLowWater  = 256 * 1024;
+static const UInt32 s_outputHighWater = 1024 * 1024;
+static const UInt32 s_outputHardLimit = 64 * 1024 * 1024;
+
 //
 // ClientProxy1_0
 //
@@ -35,8 +43,15 @@ ClientProxy1_0::ClientProxy1_0(const String& name, synergy::IStream* stream, IEv
     ClientProxy(name, stream),
     m_heartbeatTimer(NULL),
     m_parser(&ClientProxy1_0::parseHandshakeMessage),
-    m_events(events)
+    m_events(events),
+    m_motionPending(false),
+    m_motionX(0),
+    m_motionY(0)
 {
+    // don't let a client that's stopped reading use unbounded memory
+    stream->setOutputLimits(s_outputLowWater, s_outputHighWater,
+                            s_outputHardLimit);
+
     // install event handlers
     m_events->adoptHandler(m_events->forIStream().inputReady(),
                             stream->getEventTarget(),
@@ -54,14 +69,56 @@ ClientProxy1_0::ClientProxy1_0(const String& name, synergy::IStream* stream, IEv
                             stream->getEventTarget(),
                             new TMethodEventJob<ClientProxy1_0>(this,
                                 &ClientProxy1_0::handleWriteError, NULL));
+    m_events->adoptHandler(m_events->forIStream().outputCongested(),
+                            stream->getEventTarget(),
+                            new TMethodEventJob<ClientProxy1_0>(this,
+                                &ClientProxy1_0::handleOutputCongested, NULL));
+    m_events->adoptHandler(m_events->forIStream().outputDrained(),
+                            stream->getEventTarget(),
+                            new TMethodEventJob<ClientProxy1_0>(this,
+                                &ClientProxy1_0::handleOutputDrained, NULL));
+    m_events->adoptHandler(m_events->forIStream().outputFlushed(),
+                            stream->getEventTarget(),
+                            new TMethodEventJob<ClientProxy1_0>(this,
+                                &ClientProxy1_0::handleOutputFlushed, NULL));
     m_events->adoptHandler(Event::kTimer, this,
                             new TMethodEventJob<ClientProxy1_0>(this,
                                 &ClientProxy1_0::handleFlatline, NULL));
 
+    auto noop = [this] {
+        // discard no-ops
+        LOG((CLOG_DEBUG2 "no-op from", getName().c_str()));
+        return true;
+    };
+
+    m_handshakeMessages.add(kMsgCNoop, noop);
+    m_handshakeMessages.add(kMsgDInfo, [this] {
+        // future messages get parsed by parseMessage
+        m_parser = &ClientProxy1_0::parseMessage;
+        if (recvInfo()) {
+            m_events->addEvent(Event(m_events->forClientProxy().ready(), getEventTarget()));
+            addHeartbeatTimer();
+            return true;
+        }
+        return false;
+    });
+
+    m_messages.add(kMsgDInfo, [this] {
+        if (recvInfo()) {
+            m_events->addEvent(
+                            Event(m_events->forIScreen().shapeChanged(), getEventTarget()));
+            return true;
+        }
+        return false;
+    });
+    m_messages.add(kMsgCNoop, noop);
+    m_messages.add(kMsgCClipboard, [this] { return recvGrabClipboard(); });
+    m_messages.add(kMsgDClipboard, [this] { return recvClipboard(); });
+
     setHeartbeatRate(kHeartRate, kHeartRate * kHeartBeatsUntilDeath);
 
     LOG((CLOG_DEBUG1 "querying client \"%s\" info", getName().c_str()));
-    ProtocolUtil::writef(getStream(), kMsgQInfo);
+    ProtocolUtil::writeMessage<synergy::protocol::QInfo>(getStream());
 }
 
 ClientProxy1_0::~ClientProxy1_0()
@@ -89,6 +146,12 @@ ClientProxy1_0::removeHandlers()
                             getStream()->getEventTarget());
     m_events->removeHandler(m_events->forIStream().outputShutdown(),
                             getStream()->getEventTarget());
+    m_events->removeHandler(m_events->forIStream().outputCongested(),
+                            getStream()->getEventTarget());
+    m_events->removeHandler(m_events->forIStream().outputDrained(),
+                            getStream()->getEventTarget());
+    m_events->removeHandler(m_events->forIStream().outputFlushed(),
+                            getStream()->getEventTarget());
     m_events->removeHandler(Event::kTimer, this);
 
     // remove timer
@@ -115,9 +178,16 @@ ClientProxy1_0::removeHeartbeatTimer()
 void
 ClientProxy1_0::resetHeartbeatTimer()
 {
-    // reset the alarm
-    removeHeartbeatTimer();
-    addHeartbeatTimer();
+    // reset the alarm.  this happens for every packet so restart the
+    // timer rather than replacing it.  only the alarm is reset, not
+    // any other timers a subclass adds with it.
+    if (m_heartbeatTimer != NULL && m_heartbeatAlarm > 0.0) {
+        m_events->rearmTimer(m_heartbeatTimer, m_heartbeatAlarm);
+    }
+    else {
+        ClientProxy1_0::removeHeartbeatTimer();
+        ClientProxy1_0::addHeartbeatTimer();
+    }
 }
 
 void
@@ -163,49 +233,24 @@ ClientProxy1_0::handleData(const Event&, void*)
     resetHeartbeatTimer();
 }
 
+void
+ClientProxy1_0::addMessageHandler(const char* code, const MessageHandler& handler)
+{
+    m_messages.add(code, handler);
+}
+
 bool
 ClientProxy1_0::parseHandshakeMessage(const UInt8* code)
 {
-    if (memcmp(code, kMsgCNoop, 4) == 0) {
-        // discard no-ops
-        LOG((CLOG_DEBUG2 "no-op from", getName().c_str()));
-        return true;
-    }
-    else if (memcmp(code, kMsgDInfo, 4) == 0) {
-        // future messages get parsed by parseMessage
-        m_parser = &ClientProxy1_0::parseMessage;
-        if (recvInfo()) {
-            m_events->addEvent(Event(m_events->forClientProxy().ready(), getEventTarget()));
-            addHeartbeatTimer();
-            return true;
-        }
-    }
-    return false;
+    const MessageHandler* handler = m_handshakeMessages.find(code);
+    return (handler != NULL && (*handler)());
 }
 
 bool
 ClientProxy1_0::parseMessage(const UInt8* code)
 {
-    if (memcmp(code, kMsgDInfo, 4) == 0) {
-        if (recvInfo()) {
-            m_events->addEvent(
-                            Event(m_events->forIScreen().shapeChanged(), getEventTarget()));
-            return true;
-        }
-        return false;
-    }
-    else if (memcmp(code, kMsgCNoop, 4) == 0) {
-        // discard no-ops
-        LOG((CLOG_DEBUG2 "no-op from", getName().c_str()));
-        return true;
-    }
-    else if (memcmp(code, kMsgCClipboard, 4) == 0) {
-        return recvGrabClipboard();
-    }
-    else if (memcmp(code, kMsgDClipboard, 4) == 0) {
-        return recvClipboard();
-    }
-    return false;
+    const MessageHandler* handler = m_messages.find(code);
+    return (handler != NULL && (*handler)());
 }
 
 void
@@ -230,6 +275,46 @@ ClientProxy1_0::handleFlatline(const Event&, void*)
     disconnect();
 }
 
+void
+ClientProxy1_0::handleOutputCongested(const Event&, void*)
+{
+    outputCongested();
+}
+
+void
+ClientProxy1_0::handleOutputDrained(const Event&, void*)
+{
+    outputDrained();
+}
+
+void
+ClientProxy1_0::handleOutputFlushed(const Event&, void*)
+{
+    // everything was sent so the latest motion can go now
+    flushMotion();
+}
+
+void
+ClientProxy1_0::outputCongested()
+{
+    LOG((CLOG_DEBUG "client \"%s\" is not keeping up", getName().c_str()));
+}
+
+void
+ClientProxy1_0::outputDrained()
+{
+    LOG((CLOG_DEBUG "client \"%s\" caught up", getName().c_str()));
+}
+
+void
+ClientProxy1_0::flushMotion()
+{
+    if (m_motionPending) {
+        m_motionPending = false;
+        sendMouseMove(m_motionX, m_motionY);
+    }
+}
+
 bool
 ClientProxy1_0::getClipboard(ClipboardID id, IClipboard* clipboard) const
 {
@@ -258,16 +343,21 @@ void
 ClientProxy1_0::enter(SInt32 xAbs, SInt32 yAbs,
                 UInt32 seqNum, KeyModifierMask mask, bool)
 {
+    // enter sets the position
+    m_motionPending = false;
+
     LOG((CLOG_DEBUG1 "send enter to \"%s\", %d,%d %d %04x", getName().c_str(), xAbs, yAbs, seqNum, mask));
-    ProtocolUtil::writef(getStream(), kMsgCEnter,
+    ProtocolUtil::writeMessage<synergy::protocol::CEnter>(getStream(),
                                 xAbs, yAbs, seqNum, mask);
 }
 
 bool
 ClientProxy1_0::leave()
 {
+    flushMotion();
+
     LOG((CLOG_DEBUG1 "send leave to \"%s\"", getName().c_str()));
-    ProtocolUtil::writef(getStream(), kMsgCLeave);
+    ProtocolUtil::writeMessage<synergy::protocol::CLeave>(getStream());
 
     // we can never prevent the user from leaving
     return true;
@@ -283,7 +373,7 @@ void
 ClientProxy1_0::grabClipboard(ClipboardID id)
 {
     LOG((CLOG_DEBUG "send grab clipboard %d to \"%s\"", id, getName().c_str()));
-    ProtocolUtil::writef(getStream(), kMsgCClipboard, id, 0);
+    ProtocolUtil::writeMessage<synergy::protocol::CClipboard>(getStream(), id, 0);
 
     // this clipboard is now dirty
     m_clipboard[id].m_dirty = true;
@@ -298,44 +388,66 @@ ClientProxy1_0::setClipboardDirty(ClipboardID id, bool dirty)
 void
 ClientProxy1_0::keyDown(KeyID key, KeyModifierMask mask, KeyButton, const String&)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask));
-    ProtocolUtil::writef(getStream(), kMsgDKeyDown1_0, key, mask);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyDown1_0>(getStream(), key, mask);
 }
 
 void
 ClientProxy1_0::keyRepeat(KeyID key, KeyModifierMask mask,
                 SInt32 count, KeyButton, const String&)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key repeat to \"%s\" id=%d, mask=0x%04x, count=%d", getName().c_str(), key, mask, count));
-    ProtocolUtil::writef(getStream(), kMsgDKeyRepeat1_0, key, mask, count);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyRepeat1_0>(getStream(), key, mask, count);
 }
 
 void
 ClientProxy1_0::keyUp(KeyID key, KeyModifierMask mask, KeyButton)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key up to \"%s\" id=%d, mask=0x%04x", getName().c_str(), key, mask));
-    ProtocolUtil::writef(getStream(), kMsgDKeyUp1_0, key, mask);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyUp1_0>(getStream(), key, mask);
 }
 
 void
 ClientProxy1_0::mouseDown(ButtonID button)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send mouse down to \"%s\" id=%d", getName().c_str(), button));
-    ProtocolUtil::writef(getStream(), kMsgDMouseDown, button);
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseDown>(getStream(), button);
 }
 
 void
 ClientProxy1_0::mouseUp(ButtonID button)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send mouse up to \"%s\" id=%d", getName().c_str(), button));
-    ProtocolUtil::writef(getStream(), kMsgDMouseUp, button);
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseUp>(getStream(), button);
 }
 
 void
 ClientProxy1_0::mouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+    if (getStream()->hasPendingOutput()) {
+        // positions behind unsent output would be stale by the time
+        // they're sent so only keep the latest.  it's sent when the
+        // output has gone out or before the next button or key.
+        m_motionPending = true;
+        m_motionX       = xAbs;
+        m_motionY       = yAbs;
+        return;
+    }
+
+    m_motionPending = false;
+    sendMouseMove(xAbs, yAbs);
+}
+
+void
+ClientProxy1_0::sendMouseMove(SInt32 xAbs, SInt32 yAbs)
 {
     LOG((CLOG_DEBUG2 "send mouse move to \"%s\" %d,%d", getName().c_str(), xAbs, yAbs));
-    ProtocolUtil::writef(getStream(), kMsgDMouseMove, xAbs, yAbs);
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseMove>(getStream(), xAbs, yAbs);
 }
 
 void
@@ -347,9 +459,11 @@ ClientProxy1_0::mouseRelativeMove(SInt32, SInt32)
 void
 ClientProxy1_0::mouseWheel(SInt32, SInt32 yDelta)
 {
+    flushMotion();
+
     // clients prior to 1.3 only support the y axis
     LOG((CLOG_DEBUG2 "send mouse wheel to \"%s\" %+d", getName().c_str(), yDelta));
-    ProtocolUtil::writef(getStream(), kMsgDMouseWheel1_0, yDelta);
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseWheel1_0>(getStream(), yDelta);
 }
 
 void
@@ -385,14 +499,14 @@ void
 ClientProxy1_0::screensaver(bool on)
 {
     LOG((CLOG_DEBUG1 "send screen saver to \"%s\" on=%d", getName().c_str(), on ? 1 : 0));
-    ProtocolUtil::writef(getStream(), kMsgCScreenSaver, on ? 1 : 0);
+    ProtocolUtil::writeMessage<synergy::protocol::CScreenSaver>(getStream(), on ? 1 : 0);
 }
 
 void
 ClientProxy1_0::resetOptions()
 {
     LOG((CLOG_DEBUG1 "send reset options to \"%s\"", getName().c_str()));
-    ProtocolUtil::writef(getStream(), kMsgCResetOptions);
+    ProtocolUtil::writeMessage<synergy::protocol::CResetOptions>(getStream());
 
     // reset heart rate and death
     resetHeartbeatRate();
@@ -404,7 +518,7 @@ void
 ClientProxy1_0::setOptions(const OptionsList& options)
 {
     LOG((CLOG_DEBUG1 "send set options to \"%s\" size=%d", getName().c_str(), options.size()));
-    ProtocolUtil::writef(getStream(), kMsgDSetOptions, &options);
+    ProtocolUtil::writeMessage<synergy::protocol::DSetOptions>(getStream(), options);
 
     // check options
     for (UInt32 i = 0, n = (UInt32)options.size(); i < n; i += 2) {
@@ -425,8 +539,8 @@ ClientProxy1_0::recvInfo()
 {
     // parse the message
     SInt16 x, y, w, h, dummy1, mx, my;
-    if (!ProtocolUtil::readf(getStream(), kMsgDInfo + 4,
-                            &x, &y, &w, &h, &dummy1, &mx, &my)) {
+    if (!ProtocolUtil::readMessage<synergy::protocol::DInfo>(getStream(),
+                            x, y, w, h, dummy1, mx, my)) {
         return false;
     }
     LOG((CLOG_DEBUG "received client \"%s\" info shape=%d,%d %dx%d at %d,%d", getName().c_str(), x, y, w, h, mx, my));
@@ -450,7 +564,7 @@ ClientProxy1_0::recvInfo()
 
     // acknowledge receipt
     LOG((CLOG_DEBUG1 "send info ack to \"%s\"", getName().c_str()));
-    ProtocolUtil::writef(getStream(), kMsgCInfoAck);
+    ProtocolUtil::writeMessage<synergy::protocol::CInfoAck>(getStream());
     return true;
 }
 
@@ -467,7 +581,7 @@ ClientProxy1_0::recvGrabClipboard()
     // parse message
     ClipboardID id;
     UInt32 seqNum;
-    if (!ProtocolUtil::readf(getStream(), kMsgCClipboard + 4, &id, &seqNum)) {
+    if (!ProtocolUtil::readMessage<synergy::protocol::CClipboard>(getStream(), id, seqNum)) {
         return false;
     }
     LOG((CLOG_DEBUG "received client \"%s\" grabbed clipboard %d seqnum=%d", getName().c_str(), id, seqNum));
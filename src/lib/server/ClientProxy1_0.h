@@ -21,6 +21,9 @@
 #include "server/ClientProxy.h"
 #include "synergy/Clipboard.h"
 #include "synergy/protocol_types.h"
+#include "synergy/MessageTable.h"
+
+#include <functional>
 
 class Event;
 class EventQueueTimer;
@@ -69,8 +72,17 @@ public:
     void        secureInputNotification(const String& app) const override;
 
 protected:
-    virtual bool        parseHandshakeMessage(const UInt8* code);
-    virtual bool        parseMessage(const UInt8* code);
+    typedef std::function<bool()> MessageHandler;
+
+    //! Handle a message
+    /*!
+    Makes \c handler parse messages with \c code once the handshake is
+    done, replacing the handler the message had.  Later protocol
+    versions call this from their constructors to handle new messages.
+    \c handler returns false if the message was invalid.
+    */
+    void                addMessageHandler(const char* code,
+                            const MessageHandler& handler);
 
     virtual void        resetHeartbeatRate();
     virtual void        setHeartbeatRate(double rate, double alarm);
@@ -78,7 +90,39 @@ protected:
     virtual void        addHeartbeatTimer();
     virtual void        removeHeartbeatTimer();
     virtual bool        recvClipboard();
+
+    //! Handle output congestion
+    /*!
+    Called when the client stops keeping up with what we send.
+    */
+    virtual void        outputCongested();
+
+    //! Handle drained output
+    /*!
+    Called when the client has caught up after \c outputCongested().
+    */
+    virtual void        outputDrained();
+
+    //! Send held back motion
+    /*!
+    Mouse motion isn't sent while the stream has unsent output; only
+    the latest position is kept.  This sends it and must be called
+    before any message that must not be reordered with motion, like
+    buttons and keys.
+    */
+    virtual void        flushMotion();
+
+    //! Send mouse motion
+    /*!
+    Sends the pointer position to the client.  Called for motion that
+    isn't held back, including by \c flushMotion().
+    */
+    virtual void        sendMouseMove(SInt32 xAbs, SInt32 yAbs);
+
 private:
+    bool                parseHandshakeMessage(const UInt8* code);
+    bool                parseMessage(const UInt8* code);
+
     void                disconnect();
     void                removeHandlers();
 
@@ -86,6 +130,9 @@ private:
     void                handleDisconnect(const Event&, void*);
     void                handleWriteError(const Event&, void*);
     void                handleFlatline(const Event&, void*);
+    void                handleOutputCongested(const Event&, void*);
+    void                handleOutputDrained(const Event&, void*);
+    void                handleOutputFlushed(const Event&, void*);
 
     bool                recvInfo();
     bool                recvGrabClipboard();
@@ -110,5 +157,12 @@ private:
     double                m_heartbeatAlarm;
     EventQueueTimer*    m_heartbeatTimer;
     MessageParser        m_parser;
+    MessageTable<MessageHandler> m_handshakeMessages;
+    MessageTable<MessageHandler> m_messages;
     IEventQueue*        m_events;
+
+    // latest mouse position not sent because of unsent output
+    bool                m_motionPending;
+    SInt32                m_motionX;
+    SInt32                m_motionY;
 };
@@ -42,21 +42,24 @@ ClientProxy1_1::~ClientProxy1_1()
 void
 ClientProxy1_1::keyDown(KeyID key, KeyModifierMask mask, KeyButton button, const String&)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button));
-    ProtocolUtil::writef(getStream(), kMsgDKeyDown, key, mask, button);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyDown>(getStream(), key, mask, button);
 }
 
 void
 ClientProxy1_1::keyRepeat(KeyID key, KeyModifierMask mask,
                 SInt32 count, KeyButton button, const String& lang)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key repeat to \"%s\" id=%d, mask=0x%04x, count=%d, button=0x%04x, lang=\"%s\"", getName().c_str(), key, mask, count, button, lang.c_str()));
-    ProtocolUtil::writef(getStream(), kMsgDKeyRepeat, key, mask, count, button, &lang);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyRepeat>(getStream(), key, mask, count, button, lang);
 }
 
 void
 ClientProxy1_1::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key up to \"%s\" id=%d, mask=0x%04x, button=0x%04x", getName().c_str(), key, mask, button));
-    ProtocolUtil::writef(getStream(), kMsgDKeyUp, key, mask, button);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyUp>(getStream(), key, mask, button);
 }
@@ -19,6 +19,7 @@
 #include "server/ClientProxy1_2.h"
 
 #include "synergy/ProtocolUtil.h"
+#include "io/IStream.h"
 #include "base/Log.h"
 
 //
@@ -26,7 +27,10 @@
 //
 
 ClientProxy1_2::ClientProxy1_2(const String& name, synergy::IStream* stream, IEventQueue* events) :
-    ClientProxy1_1(name, stream, events)
+    ClientProxy1_1(name, stream, events),
+    m_relativePending(false),
+    m_relativeX(0),
+    m_relativeY(0)
 {
     // do nothing
 }
@@ -39,6 +43,30 @@ ClientProxy1_2::~ClientProxy1_2()
 void
 ClientProxy1_2::mouseRelativeMove(SInt32 xRel, SInt32 yRel)
 {
+    if (getStream()->hasPendingOutput()) {
+        // add up the motion and send it once the output has gone out
+        // or before the next button or key
+        m_relativePending = true;
+        m_relativeX      += xRel;
+        m_relativeY      += yRel;
+        return;
+    }
+
+    flushMotion();
     LOG((CLOG_DEBUG2 "send mouse relative move to \"%s\" %d,%d", getName().c_str(), xRel, yRel));
-    ProtocolUtil::writef(getStream(), kMsgDMouseRelMove, xRel, yRel);
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseRelMove>(getStream(), xRel, yRel);
+}
+
+void
+ClientProxy1_2::flushMotion()
+{
+    ClientProxy1_1::flushMotion();
+
+    if (m_relativePending) {
+        LOG((CLOG_DEBUG2 "send mouse relative move to \"%s\" %d,%d", getName().c_str(), m_relativeX, m_relativeY));
+        ProtocolUtil::writeMessage<synergy::protocol::DMouseRelMove>(getStream(), m_relativeX, m_relativeY);
+        m_relativePending = false;
+        m_relativeX       = 0;
+        m_relativeY       = 0;
+    }
 }
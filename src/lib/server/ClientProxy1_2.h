@@ -30,4 +30,14 @@ public:
 
     // IClient overrides
     virtual void        mouseRelativeMove(SInt32 xRel, SInt32 yRel);
+
+protected:
+    // ClientProxy1_0 overrides
+    virtual void        flushMotion();
+
+private:
+    // relative motion not sent because of unsent output
+    bool                m_relativePending;
+    SInt32                m_relativeX;
+    SInt32                m_relativeY;
 };
@@ -37,6 +37,12 @@ ClientProxy1_3::ClientProxy1_3(const String& name, synergy::IStream* stream, IEv
     m_events(events)
 {
     setHeartbeatRate(kKeepAliveRate, kKeepAliveRate * kKeepAlivesUntilDeath);
+
+    addMessageHandler(kMsgCKeepAlive, [this] {
+        // reset alarm
+        resetHeartbeatTimer();
+        return true;
+    });
 }
 
 ClientProxy1_3::~ClientProxy1_3()
@@ -48,22 +54,9 @@ ClientProxy1_3::~ClientProxy1_3()
 void
 ClientProxy1_3::mouseWheel(SInt32 xDelta, SInt32 yDelta)
 {
+    flushMotion();
     LOG((CLOG_DEBUG2 "send mouse wheel to \"%s\" %+d,%+d", getName().c_str(), xDelta, yDelta));
-    ProtocolUtil::writef(getStream(), kMsgDMouseWheel, xDelta, yDelta);
-}
-
-bool
-ClientProxy1_3::parseMessage(const UInt8* code)
-{
-    // process message
-    if (memcmp(code, kMsgCKeepAlive, 4) == 0) {
-        // reset alarm
-        resetHeartbeatTimer();
-        return true;
-    }
-    else {
-        return ClientProxy1_2::parseMessage(code);
-    }
+    ProtocolUtil::writeMessage<synergy::protocol::DMouseWheel>(getStream(), xDelta, yDelta);
 }
 
 void
@@ -79,14 +72,6 @@ ClientProxy1_3::setHeartbeatRate(double rate, double)
     ClientProxy1_2::setHeartbeatRate(rate, rate * kKeepAlivesUntilDeath);
 }
 
-void
-ClientProxy1_3::resetHeartbeatTimer()
-{
-    // reset the alarm but not the keep alive timer
-    ClientProxy1_2::removeHeartbeatTimer();
-    ClientProxy1_2::addHeartbeatTimer();
-}
-
 void
 ClientProxy1_3::addHeartbeatTimer()
 {
@@ -125,5 +110,5 @@ ClientProxy1_3::handleKeepAlive(const Event&, void*)
 void
 ClientProxy1_3::keepAlive()
 {
-    ProtocolUtil::writef(getStream(), kMsgCKeepAlive);
+    ProtocolUtil::writeMessage<synergy::protocol::CKeepAlive>(getStream());
 }
@@ -38,10 +38,8 @@ public:
 
 protected:
     // ClientProxy overrides
-    virtual bool        parseMessage(const UInt8* code);
     virtual void        resetHeartbeatRate();
     virtual void        setHeartbeatRate(double rate, double alarm);
-    virtual void        resetHeartbeatTimer();
     virtual void        addHeartbeatTimer();
     virtual void        removeHeartbeatTimer();
     virtual void        keepAlive();
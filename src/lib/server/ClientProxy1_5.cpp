@@ -33,18 +33,25 @@
 
 ClientProxy1_5::ClientProxy1_5(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
     ClientProxy1_4(name, stream, server, events),
-    m_events(events)
+    m_events(events),
+    m_filePaused(false)
 {
 
     m_events->adoptHandler(m_events->forFile().keepAlive(),
                             this,
                             new TMethodEventJob<ClientProxy1_3>(this,
                                 &ClientProxy1_3::handleKeepAlive, NULL));
+
+    addMessageHandler(kMsgDFileTransfer, [this] { fileChunkReceived(); return true; });
+    addMessageHandler(kMsgDDragInfo, [this] { dragInfoReceived(); return true; });
 }
 
 ClientProxy1_5::~ClientProxy1_5()
 {
     m_events->removeHandler(m_events->forFile().keepAlive(), this);
+    if (m_filePaused) {
+        StreamChunker::resumeFile();
+    }
 }
 
 void
@@ -52,29 +59,43 @@ ClientProxy1_5::sendDragInfo(UInt32 fileCount, const char* info, size_t size)
 {
     String data(info, size);
 
-    ProtocolUtil::writef(getStream(), kMsgDDragInfo, fileCount, &data);
+    ProtocolUtil::writeMessage<synergy::protocol::DDragInfo>(getStream(), fileCount, data);
 }
 
 void
 ClientProxy1_5::fileChunkSending(UInt8 mark, char* data, size_t dataSize)
 {
     FileChunk::send(getStream(), mark, data, dataSize);
+
+    // the congested event is queued behind this chunk so check now,
+    // before the file thread queues another
+    if (!m_filePaused && getStream()->isCongested()) {
+        m_filePaused = true;
+        StreamChunker::pauseFile();
+    }
 }
 
-bool
-ClientProxy1_5::parseMessage(const UInt8* code)
+void
+ClientProxy1_5::outputCongested()
 {
-    if (memcmp(code, kMsgDFileTransfer, 4) == 0) {
-        fileChunkReceived();
-    }
-    else if (memcmp(code, kMsgDDragInfo, 4) == 0) {
-        dragInfoReceived();
-    }
-    else {
-        return ClientProxy1_4::parseMessage(code);
+    ClientProxy1_4::outputCongested();
+
+    // stop reading file chunks faster than the client takes them
+    if (!m_filePaused) {
+        m_filePaused = true;
+        StreamChunker::pauseFile();
     }
+}
+
+void
+ClientProxy1_5::outputDrained()
+{
+    ClientProxy1_4::outputDrained();
 
-    return true;
+    if (m_filePaused) {
+        m_filePaused = false;
+        StreamChunker::resumeFile();
+    }
 }
 
 void
@@ -104,7 +125,7 @@ ClientProxy1_5::dragInfoReceived()
     // parse
     UInt32 fileNum = 0;
     String content;
-    ProtocolUtil::readf(getStream(), kMsgDDragInfo + 4, &fileNum, &content);
+    ProtocolUtil::readMessage<synergy::protocol::DDragInfo>(getStream(), fileNum, content);
     
     m_server->dragInfoReceived(fileNum, content);
 }
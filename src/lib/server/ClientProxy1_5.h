@@ -37,10 +37,15 @@ public:
 
     virtual void        sendDragInfo(UInt32 fileCount, const char* info, size_t size);
     virtual void        fileChunkSending(UInt8 mark, char* data, size_t dataSize);
-    virtual bool        parseMessage(const UInt8* code);
     void                fileChunkReceived();
     void                dragInfoReceived();
 
+protected:
+    // ClientProxy1_0 overrides
+    virtual void        outputCongested();
+    virtual void        outputDrained();
+
 private:
     IEventQueue*        m_events;
+    bool                m_filePaused;
 };
@@ -22,7 +22,6 @@
 #include "synergy/StreamChunker.h"
 #include "synergy/ClipboardChunk.h"
 #include "io/IStream.h"
-#include "base/TMethodEventJob.h"
 #include "base/Log.h"
 
 //
@@ -33,10 +32,6 @@ ClientProxy1_6::ClientProxy1_6(const String& name, synergy::IStream* stream, Ser
     ClientProxy1_5(name, stream, server, events),
     m_events(events)
 {
-    m_events->adoptHandler(m_events->forClipboard().clipboardSending(),
-                                this,
-                                new TMethodEventJob<ClientProxy1_6>(this,
-                                    &ClientProxy1_6::handleClipboardSendingEvent));
 }
 
 ClientProxy1_6::~ClientProxy1_6()
@@ -54,17 +49,67 @@ ClientProxy1_6::setClipboard(ClipboardID id, const IClipboard* clipboard)
 
         String data = m_clipboard[id].m_clipboard.marshall();
 
-        size_t size = data.size();
         LOG((CLOG_DEBUG "sending clipboard %d to \"%s\"", id, getName().c_str()));
 
-        StreamChunker::sendClipboard(data, size, id, 0, m_events, this);
+        // a send of this clipboard that hasn't started yet is stale
+        bool queued = false;
+        for (ClipboardSend& send : m_clipboardSends) {
+            if (send.m_id == id && !send.m_started) {
+                send.m_data = data;
+                queued      = true;
+            }
+        }
+        if (!queued) {
+            m_clipboardSends.push_back(ClipboardSend(id, data));
+        }
+
+        sendClipboardChunks();
     }
 }
 
 void
-ClientProxy1_6::handleClipboardSendingEvent(const Event& event, void*)
+ClientProxy1_6::outputDrained()
+{
+    ClientProxy1_5::outputDrained();
+    sendClipboardChunks();
+}
+
+void
+ClientProxy1_6::sendClipboardChunks()
 {
-    ClipboardChunk::send(getStream(), event.getDataObject());
+    // send chunks until the client stops keeping up.  the rest are
+    // sent when the output drains so a client that isn't reading
+    // doesn't get the whole clipboard buffered for it.
+    while (!m_clipboardSends.empty() && !getStream()->isCongested()) {
+        ClipboardSend& send = m_clipboardSends.front();
+        size_t size = send.m_data.size();
+
+        ClipboardChunk* chunk;
+        if (!send.m_started) {
+            // first message is the data size
+            send.m_started = true;
+            String dataSize = synergy::string::sizeTypeToString(size);
+            chunk = ClipboardChunk::start(send.m_id, 0, dataSize);
+        }
+        else if (send.m_sent < size) {
+            size_t chunkSize = StreamChunker::getChunkSize();
+            if (chunkSize > size - send.m_sent) {
+                chunkSize = size - send.m_sent;
+            }
+            keepAlive();
+            chunk = ClipboardChunk::data(send.m_id, 0,
+                            send.m_data.substr(send.m_sent, chunkSize));
+            send.m_sent += chunkSize;
+        }
+        else {
+            chunk = ClipboardChunk::end(send.m_id, 0);
+            LOG((CLOG_DEBUG "sent clipboard size=%d", static_cast<int>(send.m_sent)));
+            m_clipboardSends.pop_front();
+        }
+
+        ClipboardChunk::send(getStream(), chunk);
+        delete chunk;
+    }
 }
 
 bool
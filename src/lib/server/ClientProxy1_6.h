@@ -19,6 +19,8 @@
 
 #include "server/ClientProxy1_5.h"
 
+#include <deque>
+
 class Server;
 class IEventQueue;
 
@@ -31,9 +33,30 @@ public:
     virtual void        setClipboard(ClipboardID id, const IClipboard* clipboard);
     virtual bool        recvClipboard();
 
+protected:
+    // ClientProxy1_0 overrides
+    virtual void        outputDrained();
+
 private:
-    void                handleClipboardSendingEvent(const Event&, void*);
+    // a clipboard being sent in chunks
+    class ClipboardSend {
+    public:
+        ClipboardSend(ClipboardID id, const String& data) :
+            m_id(id), m_data(data), m_sent(0), m_started(false) { }
+
+    public:
+        ClipboardID        m_id;
+        String            m_data;
+        size_t            m_sent;
+        bool            m_started;
+    };
+
+    void                sendClipboardChunks();
 
 private:
     IEventQueue*        m_events;
+
+    // clipboards waiting to be sent, oldest first.  only the front one
+    // is partly sent.
+    std::deque<ClipboardSend>    m_clipboardSends;
 };
@@ -37,5 +37,5 @@ void
 ClientProxy1_7::secureInputNotification(const String& app) const
 {
     LOG((CLOG_DEBUG2 "send secure input notification to \"%s\" %s", getName().c_str(), app.c_str()));
-    ProtocolUtil::writef(getStream(), kMsgDSecureInputNotification, &app);
+    ProtocolUtil::writeMessage<synergy::protocol::DSecureInputNotification>(getStream(), app);
 }
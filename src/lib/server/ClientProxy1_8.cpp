@@ -33,7 +33,7 @@ void ClientProxy1_8::synchronizeLanguages() const
     auto localLanguages = languageManager.getSerializedLocalLanguages();
     if (!localLanguages.empty()) {
         LOG((CLOG_DEBUG1 "send server languages to the client: %s", localLanguages.c_str()));
-        ProtocolUtil::writef(getStream(), kMsgDLanguageSynchronisation, &localLanguages);
+        ProtocolUtil::writeMessage<synergy::protocol::DLanguageSynchronisation>(getStream(), localLanguages);
     }
     else {
         LOG((CLOG_ERR "Fail to read server languages"));
@@ -43,7 +43,8 @@ void ClientProxy1_8::synchronizeLanguages() const
 void
 ClientProxy1_8::keyDown(KeyID key, KeyModifierMask mask, KeyButton button, const String& language)
 {
+    flushMotion();
     LOG((CLOG_DEBUG1 "send key down to \"%s\" id=%d, mask=0x%04x, button=0x%04x, language=%s", getName().c_str(), key, mask, button, language.c_str()));
-    ProtocolUtil::writef(getStream(), kMsgDKeyDownLang, key, mask, button, &language);
+    ProtocolUtil::writeMessage<synergy::protocol::DKeyDownLang>(getStream(), key, mask, button, language);
 }
 
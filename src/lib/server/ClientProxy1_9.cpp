@@ -0,0 +1,220 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_9.h"
+
+#include "synergy/option_types.h"
+#include "synergy/ProtocolUtil.h"
+#include "io/IStream.h"
+#include "base/IEventQueue.h"
+#include "base/TMethodEventJob.h"
+#include "base/Log.h"
+
+#include <algorithm>
+
+// timers must have a positive duration
+static const double kMinBatchWindow = 1.0e-6;
+
+static const SInt32 kDefaultAbsoluteMotionInterval = 32;
+
+//
+// ClientProxy1_9
+//
+
+ClientProxy1_9::ClientProxy1_9(const String& name, synergy::IStream* stream, Server* server, IEventQueue* events) :
+    ClientProxy1_8(name, stream, server, events),
+    m_events(events),
+    m_batchWindow(0.0),
+    m_absoluteInterval(kDefaultAbsoluteMotionInterval),
+    m_haveMotionBase(false),
+    m_xMotionBase(0),
+    m_yMotionBase(0),
+    m_deltaCount(0),
+    m_batchOpen(false)
+{
+    // one timer closes every batch.  it's rearmed when a batch opens so
+    // its first expiry, with no batch open, does nothing.
+    m_batchTimer = m_events->newOneShotTimer(kMinBatchWindow, NULL);
+    m_events->adoptHandler(Event::kTimer, m_batchTimer,
+                            new TMethodEventJob<ClientProxy1_9>(this,
+                                &ClientProxy1_9::handleInputBatchTimer));
+}
+
+ClientProxy1_9::~ClientProxy1_9()
+{
+    endInputBatch();
+    m_events->removeHandler(Event::kTimer, m_batchTimer);
+    m_events->deleteTimer(m_batchTimer);
+}
+
+void
+ClientProxy1_9::enter(SInt32 xAbs, SInt32 yAbs,
+                UInt32 seqNum, KeyModifierMask mask, bool forScreensaver)
+{
+    ClientProxy1_8::enter(xAbs, yAbs, seqNum, mask, forScreensaver);
+
+    // the client takes the enter position as the base for deltas
+    m_haveMotionBase = true;
+    m_xMotionBase    = static_cast<SInt16>(xAbs);
+    m_yMotionBase    = static_cast<SInt16>(yAbs);
+    m_deltaCount     = 0;
+}
+
+void
+ClientProxy1_9::keyDown(KeyID key, KeyModifierMask mask, KeyButton button, const String& language)
+{
+    beginInputBatch();
+    ClientProxy1_8::keyDown(key, mask, button, language);
+}
+
+void
+ClientProxy1_9::keyRepeat(KeyID key, KeyModifierMask mask,
+                SInt32 count, KeyButton button, const String& language)
+{
+    beginInputBatch();
+    ClientProxy1_8::keyRepeat(key, mask, count, button, language);
+}
+
+void
+ClientProxy1_9::keyUp(KeyID key, KeyModifierMask mask, KeyButton button)
+{
+    beginInputBatch();
+    ClientProxy1_8::keyUp(key, mask, button);
+}
+
+void
+ClientProxy1_9::mouseDown(ButtonID button)
+{
+    beginInputBatch();
+    ClientProxy1_8::mouseDown(button);
+}
+
+void
+ClientProxy1_9::mouseUp(ButtonID button)
+{
+    beginInputBatch();
+    ClientProxy1_8::mouseUp(button);
+}
+
+void
+ClientProxy1_9::mouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+    beginInputBatch();
+    ClientProxy1_8::mouseMove(xAbs, yAbs);
+}
+
+void
+ClientProxy1_9::mouseRelativeMove(SInt32 xRel, SInt32 yRel)
+{
+    beginInputBatch();
+    ClientProxy1_8::mouseRelativeMove(xRel, yRel);
+}
+
+void
+ClientProxy1_9::mouseWheel(SInt32 xDelta, SInt32 yDelta)
+{
+    beginInputBatch();
+    ClientProxy1_8::mouseWheel(xDelta, yDelta);
+}
+
+void
+ClientProxy1_9::resetOptions()
+{
+    ClientProxy1_8::resetOptions();
+    m_batchWindow      = 0.0;
+    m_absoluteInterval = kDefaultAbsoluteMotionInterval;
+}
+
+void
+ClientProxy1_9::setOptions(const OptionsList& options)
+{
+    ClientProxy1_8::setOptions(options);
+
+    for (UInt32 i = 0, n = (UInt32)options.size(); i < n; i += 2) {
+        if (options[i] == kOptionInputBatchWindow) {
+            SInt32 window = static_cast<SInt32>(options[i + 1]);
+            m_batchWindow = (window < 0) ? -1.0 : 1.0e-6 * window;
+            LOG((CLOG_DEBUG1 "input batch window for \"%s\" is %dus", getName().c_str(), window));
+        }
+        else if (options[i] == kOptionAbsoluteMotionInterval) {
+            m_absoluteInterval = static_cast<SInt32>(options[i + 1]);
+            LOG((CLOG_DEBUG1 "absolute motion interval for \"%s\" is %d", getName().c_str(), m_absoluteInterval));
+        }
+    }
+}
+
+void
+ClientProxy1_9::sendMouseMove(SInt32 xAbs, SInt32 yAbs)
+{
+    using synergy::protocol::Varint;
+
+    // positions go out as 16 bit values so deltas are between those
+    SInt16 x  = static_cast<SInt16>(xAbs);
+    SInt16 y  = static_cast<SInt16>(yAbs);
+    SInt32 dx = x - m_xMotionBase;
+    SInt32 dy = y - m_yMotionBase;
+
+    // send an absolute position every so often and when the delta
+    // isn't any shorter
+    if (!m_haveMotionBase || m_deltaCount >= m_absoluteInterval ||
+        Varint::size(dx) + Varint::size(dy) >= 4) {
+        ClientProxy1_8::sendMouseMove(xAbs, yAbs);
+        m_deltaCount = 0;
+    }
+    else {
+        LOG((CLOG_DEBUG2 "send mouse delta to \"%s\" %+d,%+d", getName().c_str(), dx, dy));
+        ProtocolUtil::writeMessage<synergy::protocol::DMouseDelta>(getStream(), dx, dy);
+        ++m_deltaCount;
+    }
+
+    m_haveMotionBase = true;
+    m_xMotionBase    = x;
+    m_yMotionBase    = y;
+}
+
+void
+ClientProxy1_9::beginInputBatch()
+{
+    if (m_batchOpen || m_batchWindow < 0.0) {
+        return;
+    }
+
+    // timers only fire when no events are waiting so the shortest
+    // window closes the batch once the queued input has been handled
+    getStream()->beginBatch();
+    m_batchOpen = true;
+    m_events->rearmTimer(m_batchTimer, std::max(m_batchWindow, kMinBatchWindow));
+}
+
+void
+ClientProxy1_9::endInputBatch()
+{
+    if (!m_batchOpen) {
+        return;
+    }
+    m_batchOpen = false;
+
+    // motion held back behind the batch goes out with it
+    flushMotion();
+    getStream()->endBatch();
+}
+
+void
+ClientProxy1_9::handleInputBatchTimer(const Event&, void*)
+{
+    endInputBatch();
+}
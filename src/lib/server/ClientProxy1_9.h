@@ -0,0 +1,97 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "server/ClientProxy1_8.h"
+
+//! Proxy for client implementing protocol version 1.9
+/*!
+Input sent to the client is batched: the first input message opens a
+batch on the stream and everything sent until it closes goes out in
+a single packet.  By default the batch closes once the event queue
+has no more events waiting.  The \c inputBatchWindow option instead
+holds it open for that many microseconds; a negative window turns
+batching off.
+
+Mouse motion is sent as small deltas from the last position sent.  An
+absolute position follows every \c absoluteMotionInterval deltas, 32
+by default;  0 sends only absolute positions.
+
+The client never acknowledges positions; it doesn't need to.  The
+stream delivers every message in order and the client moves its base
+to each position it reads, even one it ignores, so the last position
+sent is always the base the client has when the next delta arrives.
+\c enter() resets the base on both ends and a new connection gets a
+new proxy.  The periodic absolute positions are only a guard against
+drift, not what keeps the ends in step.
+*/
+class ClientProxy1_9 : public ClientProxy1_8 {
+public:
+    ClientProxy1_9(const String& name, synergy::IStream* adoptedStream, Server* server, IEventQueue* events);
+    ClientProxy1_9(ClientProxy1_9 const &) =delete;
+    ClientProxy1_9(ClientProxy1_9 &&) =delete;
+    ~ClientProxy1_9() override;
+
+    ClientProxy1_9& operator=(ClientProxy1_9 const &) =delete;
+    ClientProxy1_9& operator=(ClientProxy1_9 &&) =delete;
+
+    // IClient overrides
+    void        enter(SInt32 xAbs, SInt32 yAbs,
+                            UInt32 seqNum, KeyModifierMask mask,
+                            bool forScreensaver) override;
+    void        keyDown(KeyID, KeyModifierMask, KeyButton, const String&) override;
+    void        keyRepeat(KeyID, KeyModifierMask,
+                            SInt32 count, KeyButton, const String&) override;
+    void        keyUp(KeyID, KeyModifierMask, KeyButton) override;
+    void        mouseDown(ButtonID) override;
+    void        mouseUp(ButtonID) override;
+    void        mouseMove(SInt32 xAbs, SInt32 yAbs) override;
+    void        mouseRelativeMove(SInt32 xRel, SInt32 yRel) override;
+    void        mouseWheel(SInt32 xDelta, SInt32 yDelta) override;
+    void        resetOptions() override;
+    void        setOptions(const OptionsList& options) override;
+
+protected:
+    // ClientProxy1_0 overrides
+    void                sendMouseMove(SInt32 xAbs, SInt32 yAbs) override;
+
+private:
+    void                beginInputBatch();
+    void                endInputBatch();
+    void                handleInputBatchTimer(const Event&, void*);
+
+private:
+    IEventQueue*        m_events;
+
+    // seconds to hold a batch open, or negative to not batch
+    double              m_batchWindow;
+
+    // deltas to send between absolute positions
+    SInt32              m_absoluteInterval;
+
+    // the position the client has, which deltas are from, and how
+    // many deltas were sent since the last absolute position
+    bool                m_haveMotionBase;
+    SInt16              m_xMotionBase;
+    SInt16              m_yMotionBase;
+    SInt32              m_deltaCount;
+
+    // closes the open batch when it expires
+    bool                m_batchOpen;
+    EventQueueTimer*    m_batchTimer;
+};
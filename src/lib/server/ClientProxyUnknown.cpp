@@ -28,6 +28,7 @@
 #include "server/ClientProxy1_6.h"
 #include "server/ClientProxy1_7.h"
 #include "server/ClientProxy1_8.h"
+#include "server/ClientProxy1_9.h"
 #include "synergy/protocol_types.h"
 #include "synergy/ProtocolUtil.h"
 #include "synergy/AppUtil.h"
@@ -61,7 +62,7 @@ ClientProxyUnknown::ClientProxyUnknown(synergy::IStream* stream, double timeout,
     addStreamHandlers();
 
     LOG((CLOG_DEBUG1 "saying hello"));
-    ProtocolUtil::writef(m_stream, kMsgHello, kProtocolMajorVersion, kProtocolMinorVersion);
+    ProtocolUtil::writeMessage<synergy::protocol::Hello>(m_stream, kProtocolMajorVersion, kProtocolMinorVersion);
 }
 
 ClientProxyUnknown::~ClientProxyUnknown()
@@ -214,6 +215,10 @@ ClientProxyUnknown::initProxy(const String& name, int major, int minor)
         case 8:
             m_proxy = new ClientProxy1_8(name, m_stream, m_server, m_events);
             break;
+
+        case 9:
+            m_proxy = new ClientProxy1_9(name, m_stream, m_server, m_events);
+            break;
         }
     }
 
@@ -268,14 +273,13 @@ ClientProxyUnknown::handleData(const Event&, void*)
     catch (XIncompatibleClient& e) {
         // client is incompatible
         LOG((CLOG_WARN "client \"%s\" has incompatible version %d.%d)", name.c_str(), e.getMajor(), e.getMinor()));
-        ProtocolUtil::writef(m_stream,
-                            kMsgEIncompatible,
+        ProtocolUtil::writeMessage<synergy::protocol::EIncompatible>(m_stream,
                             kProtocolMajorVersion, kProtocolMinorVersion);
     }
     catch (XBadClient&) {
         // client not behaving
         LOG((CLOG_WARN "protocol error from client \"%s\"", name.c_str()));
-        ProtocolUtil::writef(m_stream, kMsgEBad);
+        ProtocolUtil::writeMessage<synergy::protocol::EBad>(m_stream);
     }
     catch (XBase& e) {
         // misc error
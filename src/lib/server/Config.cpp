@@ -804,6 +804,12 @@ Config::readSectionOptions(ConfigReadContext& s)
 		else if (name == "clipboardSharingSize") {
 			addOption("", kOptionClipboardSharingSize, s.parseInt(value));
 		}
+		else if (name == "inputBatchWindow") {
+			addOption("", kOptionInputBatchWindow, s.parseInt(value));
+		}
+		else if (name == "absoluteMotionInterval") {
+			addOption("", kOptionAbsoluteMotionInterval, s.parseInt(value));
+		}
 		else {
 			handled = false;
 		}
@@ -1441,6 +1447,12 @@ Config::getOptionName(OptionID id)
 	if (id == kOptionClipboardSharingSize) {
 		return "clipboardSharingSize";
 	}
+	if (id == kOptionInputBatchWindow) {
+		return "inputBatchWindow";
+	}
+	if (id == kOptionAbsoluteMotionInterval) {
+		return "absoluteMotionInterval";
+	}
 	return NULL;
 }
 
@@ -1491,6 +1503,8 @@ Config::getOptionValue(OptionID id, OptionValue value)
 		}
 	}
 	if (id == kOptionHeartbeat ||
+		id == kOptionInputBatchWindow ||
+		id == kOptionAbsoluteMotionInterval ||
 		id == kOptionScreenSwitchCornerSize ||
 		id == kOptionScreenSwitchDelay ||
 		id == kOptionScreenSwitchTwoTap) {
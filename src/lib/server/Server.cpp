@@ -1571,6 +1571,7 @@ void
 Server::handleFileChunkSendingEvent(const Event& event, void*)
 {
 	onFileChunkSending(event.getDataObject());
+	StreamChunker::fileChunkSent();
 }
 
 void
@@ -68,7 +68,8 @@ App::App(IEventQueue* events, CreateTaskBarReceiverFunc createTaskBarReceiver, l
     m_createTaskBarReceiver(createTaskBarReceiver),
     m_appUtil(events),
     m_ipcClient(nullptr),
-    m_socketMultiplexer(nullptr)
+    m_socketMultiplexer(nullptr),
+    m_handshakeMultiplexer(nullptr)
 {
     assert(s_instance == nullptr);
     s_instance = this;
@@ -103,6 +103,9 @@ public:
     void                setSocketMultiplexer(SocketMultiplexer* sm) { m_socketMultiplexer = sm; }
     SocketMultiplexer*    getSocketMultiplexer() const { return m_socketMultiplexer; }
 
+    void                setHandshakeMultiplexer(SocketMultiplexer* sm) { m_handshakeMultiplexer = sm; }
+    SocketMultiplexer*    getHandshakeMultiplexer() const { return m_handshakeMultiplexer; }
+
     void                setEvents(EventQueue& events) { m_events = &events; }
 
 private:
@@ -125,6 +128,7 @@ private:
     ARCH_APP_UTIL m_appUtil;
     IpcClient*            m_ipcClient;
     SocketMultiplexer*    m_socketMultiplexer;
+    SocketMultiplexer*    m_handshakeMultiplexer;
 };
 
 class MinimalApp : public App {
@@ -170,7 +174,8 @@ private:
     "      --no-tray            disable the system tray icon.\n" \
     "      --enable-drag-drop   enable file drag & drop.\n" \
     "      --enable-crypto      enable the crypto (ssl) plugin.\n" \
-    "      --tls-cert           specify the path to the tls certificate file.\n"
+    "      --tls-cert           specify the path to the tls certificate file.\n" \
+    "      --enable-ktls        let the kernel encrypt tls traffic if it can.\n"
 
 #define HELP_COMMON_INFO_2 \
     "  -h, --help               display this help and exit.\n" \
@@ -71,6 +71,22 @@ ArgParser::parseServerArgs(lib::synergy::ServerArgs& args, int argc, const char*
         else if (isArg(i, argc, argv, "", "--serial-key", 1)) {
             args.m_serial = SerialKey(argv[++i]);
         }
+        else if (isArg(i, argc, argv, nullptr, "--net-threads", 1)) {
+            // number of threads servicing client sockets
+            args.m_netThreads = atoi(argv[++i]);
+            if (args.m_netThreads < 1) {
+                LOG((CLOG_PRINT "%s: invalid thread count `%s'" BYE, args.m_pname, argv[i], args.m_pname));
+                return false;
+            }
+        }
+        else if (isArg(i, argc, argv, nullptr, "--listen-backlog", 1)) {
+            // connections the system queues until we accept them
+            args.m_listenBacklog = atoi(argv[++i]);
+            if (args.m_listenBacklog < 1) {
+                LOG((CLOG_PRINT "%s: invalid backlog `%s'" BYE, args.m_pname, argv[i], args.m_pname));
+                return false;
+            }
+        }
         else {
             LOG((CLOG_PRINT "%s: unrecognized option `%s'" BYE, args.m_pname, argv[i], args.m_pname));
             return false;
@@ -309,6 +325,9 @@ ArgParser::parseGenericArgs(int argc, const char* const* argv, int& i)
     else if (isArg(i, argc, argv, nullptr, "--tls-cert", 1)) {
         argsBase().m_tlsCertFile = argv[++i];
     }
+    else if (isArg(i, argc, argv, nullptr, "--enable-ktls")) {
+        argsBase().m_enableKernelTls = true;
+    }
     else if (isArg(i, argc, argv, nullptr, "--prevent-sleep")) {
         argsBase().m_preventSleep = true;
     }
@@ -58,6 +58,7 @@ namespace lib {
             String               m_profileDirectory;               /// @brief The profile DIR to use for the application
             String               m_pluginDirectory;                /// @brief //TODO Plugins? Get set in ARCH but doesn't seem to get used
             String               m_tlsCertFile;                    /// @brief Contains the location of the TLS certificate file
+            bool                 m_enableKernelTls   = false;      /// @brief Should TLS records be encrypted by the kernel when it can
             bool                 m_preventSleep = false;           /// @brief Stop this computer from sleeping
 
 #if SYSAPI_WIN32
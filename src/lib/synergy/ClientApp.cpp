@@ -27,6 +27,7 @@
 #include "net/NetworkAddress.h"
 #include "net/TCPSocketFactory.h"
 #include "net/SocketMultiplexer.h"
+#include "net/SecureSocket.h"
 #include "net/XSocket.h"
 #include "mt/Thread.h"
 #include "arch/IArchTaskBarReceiver.h"
@@ -119,7 +120,7 @@ ClientApp::help()
 #  define WINAPI_ARG
 #  define WINAPI_INFO
 #endif
-    static const int buffer_size = 2000;
+    static const int buffer_size = 3000;
     char buffer[buffer_size];
     snprintf(
         buffer,
@@ -310,20 +311,8 @@ ClientApp::handleClientConnected(const Event&, void*)
 void
 ClientApp::handleClientFailed(const Event& e, void*)
 {
-    if ( (++m_lastServerAddressIndex) < m_client->getLastResolvedAddressesCount()) {
-        std::unique_ptr<Client::FailInfo> info(static_cast<Client::FailInfo*>(e.getData()));
-
-        updateStatus(String("Failed to connect to server: ") + info->m_what + " Trying next address...");
-        LOG((CLOG_NOTE "Failed to connect to server: %s. Trying next address...", info->m_what.c_str()));
-        if (!m_suspended) {
-            scheduleClientRestart(nextRestartTimeout());
-        }
-    }
-    else {
-        m_lastServerAddressIndex = 0;
-        handleClientRefused(e, nullptr);
-    }
-
+    // the client already tried every address of the server
+    handleClientRefused(e, nullptr);
 }
 
 void
@@ -366,7 +355,8 @@ ClientApp::openClient(const String& name, const NetworkAddress& address,
         m_events,
         name,
         address,
-        new TCPSocketFactory(m_events, getSocketMultiplexer()),
+        new TCPSocketFactory(m_events, getSocketMultiplexer(),
+                            getHandshakeMultiplexer(), args().m_enableKernelTls),
         screen,
         args());
 
@@ -437,7 +427,7 @@ ClientApp::startClient()
             LOG((CLOG_NOTE "started client"));
         }
 
-        m_client->connect(m_lastServerAddressIndex);
+        m_client->connect();
 
         updateStatus();
         return true;
@@ -488,6 +478,16 @@ ClientApp::mainLoop()
     SocketMultiplexer multiplexer;
     setSocketMultiplexer(&multiplexer);
 
+    // tls handshakes get their own multiplexer so they don't hold up
+    // connected sockets.  it's torn down with the socket multiplexer
+    // after the sockets are gone.
+    std::unique_ptr<SocketMultiplexer> handshakeMultiplexer;
+    if (args().m_enableCrypto) {
+        handshakeMultiplexer.reset(
+            new SocketMultiplexer(SecureSocket::kHandshakeThreads));
+    }
+    setHandshakeMultiplexer(handshakeMultiplexer.get());
+
     // start client, etc
     appUtil().startNode();
     
@@ -85,5 +85,4 @@ private:
     Client*            m_client;
     synergy::Screen*   m_clientScreen;
     NetworkAddress*    m_serverAddress;
-    size_t             m_lastServerAddressIndex = 0;
 };
@@ -92,7 +92,7 @@ ClipboardChunk::assemble(synergy::IStream* stream,
     UInt8 mark;
     String data;
 
-    if (!ProtocolUtil::readf(stream, kMsgDClipboard + 4, &id, &sequence, &mark, &data)) {
+    if (!ProtocolUtil::readMessage<synergy::protocol::DClipboard>(stream, id, sequence, mark, data)) {
         return kError;
     }
     
@@ -150,5 +150,5 @@ ClipboardChunk::send(synergy::IStream* stream, void* data)
         break;
     }
 
-    ProtocolUtil::writef(stream, kMsgDClipboard, id, sequence, mark, &dataChunk);
+    ProtocolUtil::writeMessage<synergy::protocol::DClipboard>(stream, id, sequence, mark, dataChunk);
 }
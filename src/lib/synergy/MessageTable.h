@@ -0,0 +1,159 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <cassert>
+#include <cstring>
+
+//! Protocol message dispatch table
+/*!
+Maps 4 byte message codes to handlers.  Codes are kept in an open
+addressed hash table so finding a message's handler doesn't depend on
+how many messages the protocol has or the order they were added in.
+*/
+template <class Handler>
+class MessageTable {
+public:
+    MessageTable();
+
+    //! @name manipulators
+    //@{
+
+    //! Add a handler
+    /*!
+    Makes \c handler handle messages with the 4 byte \c code, replacing
+    the handler it had, if any.
+    */
+    void                add(const char* code, const Handler& handler);
+
+    //@}
+    //! @name accessors
+    //@{
+
+    //! Find a handler
+    /*!
+    Returns the handler for messages with the 4 byte \c code or NULL if
+    there isn't one.
+    */
+    const Handler*      find(const UInt8* code) const;
+
+    //! Get the number of handlers
+    size_t              size() const { return m_count; }
+
+    //@}
+
+private:
+    struct Slot {
+        Slot() : m_code(0) { }
+
+        // 0 for an unused slot.  message codes are printable
+        // characters so no message has that code.
+        UInt32          m_code;
+        Handler         m_handler;
+    };
+
+    static UInt32       toCode(const void* code);
+    size_t              indexOf(UInt32 code) const;
+    void                grow();
+
+private:
+    std::vector<Slot>   m_slots;
+    UInt32              m_shift;
+    size_t              m_count;
+};
+
+template <class Handler>
+MessageTable<Handler>::MessageTable() :
+    m_slots(64),
+    m_shift(32 - 6),
+    m_count(0)
+{
+}
+
+template <class Handler>
+void
+MessageTable<Handler>::add(const char* code, const Handler& handler)
+{
+    // keep the table at most half full so probes stay short
+    if (2 * (m_count + 1) > m_slots.size()) {
+        grow();
+    }
+
+    UInt32 key = toCode(code);
+    assert(key != 0);
+
+    size_t mask = m_slots.size() - 1;
+    size_t i    = indexOf(key);
+    while (m_slots[i].m_code != 0 && m_slots[i].m_code != key) {
+        i = (i + 1) & mask;
+    }
+    if (m_slots[i].m_code == 0) {
+        m_slots[i].m_code = key;
+        ++m_count;
+    }
+    m_slots[i].m_handler = handler;
+}
+
+template <class Handler>
+const Handler*
+MessageTable<Handler>::find(const UInt8* code) const
+{
+    UInt32 key  = toCode(code);
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = indexOf(key); m_slots[i].m_code != 0; i = (i + 1) & mask) {
+        if (m_slots[i].m_code == key) {
+            return &m_slots[i].m_handler;
+        }
+    }
+    return NULL;
+}
+
+template <class Handler>
+UInt32
+MessageTable<Handler>::toCode(const void* code)
+{
+    UInt32 key;
+    std::memcpy(&key, code, sizeof(key));
+    return key;
+}
+
+template <class Handler>
+size_t
+MessageTable<Handler>::indexOf(UInt32 code) const
+{
+    // fibonacci hashing spreads codes that differ in one letter
+    return static_cast<size_t>((code * 2654435769U) >> m_shift);
+}
+
+template <class Handler>
+void
+MessageTable<Handler>::grow()
+{
+    std::vector<Slot> slots(2 * m_slots.size());
+    slots.swap(m_slots);
+    --m_shift;
+    m_count = 0;
+    for (const Slot& slot : slots) {
+        if (slot.m_code != 0) {
+            add(reinterpret_cast<const char*>(&slot.m_code), slot.m_handler);
+        }
+    }
+}
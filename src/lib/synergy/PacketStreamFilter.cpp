@@ -21,9 +21,14 @@
 #include "mt/Lock.h"
 #include "base/TMethodEventJob.h"
 
+#include <cassert>
 #include <cstring>
 #include <memory>
 
+// a batch is sent early when it gets this big, about the payload of
+// one ethernet frame
+static const UInt32 kMaxBatchSize = 1400;
+
 //
 // PacketStreamFilter
 //
@@ -32,7 +37,8 @@ PacketStreamFilter::PacketStreamFilter(IEventQueue* events, synergy::IStream* st
     StreamFilter(events, stream, adoptStream),
     m_size(0),
     m_inputShutdown(false),
-    m_events(events)
+    m_events(events),
+    m_batchDepth(0)
 {
     // do nothing
 }
@@ -48,6 +54,7 @@ PacketStreamFilter::close()
     Lock lock(&m_mutex);
     m_size = 0;
     m_buffer.pop(m_buffer.getSize());
+    m_batch.clear();
     StreamFilter::close();
 }
 
@@ -71,10 +78,7 @@ PacketStreamFilter::read(void* buffer, UInt32 n)
     }
 
     // read it
-    if (buffer != NULL) {
-        memcpy(buffer, m_buffer.peek(n), n);
-    }
-    m_buffer.pop(n);
+    m_buffer.read(buffer, n);
     m_size -= n;
 
     // get next packet's size if we've finished with this packet and
@@ -92,16 +96,75 @@ PacketStreamFilter::read(void* buffer, UInt32 n)
 void
 PacketStreamFilter::write(const void* buffer, UInt32 count)
 {
-    // write the length of the payload
-    UInt8 length[4];
-    length[0] = (UInt8)((count >> 24) & 0xff);
-    length[1] = (UInt8)((count >> 16) & 0xff);
-    length[2] = (UInt8)((count >>  8) & 0xff);
-    length[3] = (UInt8)( count        & 0xff);
-    getStream()->write(length, sizeof(length));
+    writeVector(&buffer, &count, 1);
+}
+
+void
+PacketStreamFilter::writeVector(const void* const* buffers,
+                const UInt32* sizes, int count)
+{
+    // the lock also keeps packets written by other threads whole and
+    // in order with the batch
+    Lock lock(&m_mutex);
+
+    if (m_batchDepth == 0) {
+        writePacket(buffers, sizes, count);
+        return;
+    }
+
+    UInt32 size = 0;
+    for (int i = 0; i < count; ++i) {
+        size += sizes[i];
+    }
+
+    // big writes, like clipboard chunks, aren't worth copying
+    if (size >= kMaxBatchSize) {
+        writeBatch();
+        writePacket(buffers, sizes, count);
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const UInt8* data = static_cast<const UInt8*>(buffers[i]);
+        m_batch.insert(m_batch.end(), data, data + sizes[i]);
+    }
+    if (m_batch.size() >= kMaxBatchSize) {
+        writeBatch();
+    }
+}
+
+void
+PacketStreamFilter::beginBatch()
+{
+    Lock lock(&m_mutex);
+    ++m_batchDepth;
+}
+
+void
+PacketStreamFilter::endBatch()
+{
+    Lock lock(&m_mutex);
+    assert(m_batchDepth > 0);
+    if (--m_batchDepth == 0) {
+        writeBatch();
+    }
+}
 
-    // write the payload
-    getStream()->write(buffer, count);
+void
+PacketStreamFilter::flush()
+{
+    {
+        Lock lock(&m_mutex);
+        writeBatch();
+    }
+    StreamFilter::flush();
+}
+
+bool
+PacketStreamFilter::hasPendingOutput() const
+{
+    Lock lock(&m_mutex);
+    return (!m_batch.empty() || StreamFilter::hasPendingOutput());
 }
 
 void
@@ -140,8 +203,7 @@ PacketStreamFilter::readPacketSize()
 
     if (m_size == 0 && m_buffer.getSize() >= 4) {
         UInt8 buffer[4];
-        memcpy(buffer, m_buffer.peek(sizeof(buffer)), sizeof(buffer));
-        m_buffer.pop(sizeof(buffer));
+        m_buffer.read(buffer, sizeof(buffer));
         m_size = ((UInt32)buffer[0] << 24) |
                  ((UInt32)buffer[1] << 16) |
                  ((UInt32)buffer[2] <<  8) |
@@ -149,6 +211,63 @@ PacketStreamFilter::readPacketSize()
     }
 }
 
+void
+PacketStreamFilter::writePacket(const void* const* buffers,
+                const UInt32* sizes, int count)
+{
+    // the payload is the concatenation of the buffers
+    UInt32 size = 0;
+    for (int i = 0; i < count; ++i) {
+        size += sizes[i];
+    }
+
+    // write the length of the payload followed by the payload in one
+    // call so the stream only has to take its lock and schedule the
+    // write once
+    UInt8 length[4];
+    length[0] = (UInt8)((size >> 24) & 0xff);
+    length[1] = (UInt8)((size >> 16) & 0xff);
+    length[2] = (UInt8)((size >>  8) & 0xff);
+    length[3] = (UInt8)( size        & 0xff);
+
+    if (count == 1) {
+        const void* packet[2]  = { length, buffers[0] };
+        UInt32 packetSizes[2] = { sizeof(length), sizes[0] };
+        getStream()->writeVector(packet, packetSizes, 2);
+    }
+    else {
+        std::vector<const void*> packet(buffers, buffers + count);
+        std::vector<UInt32> packetSizes(sizes, sizes + count);
+        packet.insert(packet.begin(), length);
+        packetSizes.insert(packetSizes.begin(), sizeof(length));
+        getStream()->writeVector(packet.data(), packetSizes.data(), count + 1);
+    }
+}
+
+void
+PacketStreamFilter::writeBatch()
+{
+    // note -- m_mutex must be locked on entry
+
+    if (m_batch.empty()) {
+        return;
+    }
+
+    // clear the batch before writing in case writing fails and
+    // the error handler writes again
+    std::vector<UInt8> batch;
+    batch.swap(m_batch);
+    const void* buffer = batch.data();
+    UInt32 size        = static_cast<UInt32>(batch.size());
+    writePacket(&buffer, &size, 1);
+
+    // keep the storage for the next batch
+    if (m_batch.empty()) {
+        batch.clear();
+        m_batch.swap(batch);
+    }
+}
+
 bool
 PacketStreamFilter::readMore()
 {
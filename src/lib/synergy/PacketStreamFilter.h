@@ -21,12 +21,15 @@
 #include "io/StreamFilter.h"
 #include "io/StreamBuffer.h"
 #include "mt/Mutex.h"
+#include "common/stdvector.h"
 
 class IEventQueue;
 
 //! Packetizing stream filter 
 /*!
-Filters a stream to read and write packets.
+Filters a stream to read and write packets.  Everything written while
+a batch is open goes out as one packet when the batch ends, so only
+use batches if the other end accepts several messages in a packet.
 */
 class PacketStreamFilter : public StreamFilter {
 public:
@@ -37,6 +40,12 @@ public:
     virtual void        close();
     virtual UInt32        read(void* buffer, UInt32 n);
     virtual void        write(const void* buffer, UInt32 n);
+    virtual void        writeVector(const void* const* buffers,
+                            const UInt32* sizes, int count);
+    virtual void        beginBatch();
+    virtual void        endBatch();
+    virtual void        flush();
+    virtual bool        hasPendingOutput() const;
     virtual void        shutdownInput();
     virtual bool        isReady() const;
     virtual UInt32        getSize() const;
@@ -50,10 +59,22 @@ private:
     void                readPacketSize();
     bool                readMore();
 
+    // write the packet header and payload to the stream in one call
+    void                writePacket(const void* const* buffers,
+                            const UInt32* sizes, int count);
+
+    // send what was written in the open batch as one packet
+    void                writeBatch();
+
 private:
     Mutex                m_mutex;
     UInt32                m_size;
     StreamBuffer        m_buffer;
     bool                m_inputShutdown;
     IEventQueue*        m_events;
+
+    // payload of the packet for the open batch.  like the input state
+    // these are guarded by m_mutex since any thread may write.
+    int                 m_batchDepth;
+    std::vector<UInt8>  m_batch;
 };
@@ -0,0 +1,708 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/String.h"
+#include "common/basic_types.h"
+#include "common/stdvector.h"
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace synergy { class IStream; }
+
+//
+// Typed protocol messages
+//
+// Each message in protocol_types.h has a struct here describing its
+// fields and how they're sent, so messages are encoded and decoded
+// without parsing a format string.  The encoding is the same as
+// ProtocolUtil::writef() with the message's format.
+//
+
+namespace synergy {
+namespace protocol {
+
+//! Read exactly \c size bytes
+/*!
+Reads \c size bytes from \c stream into \c buffer, throwing
+XIOEndOfStream if the stream ends first.
+*/
+void                    readFully(synergy::IStream* stream,
+                            void* buffer, UInt32 size);
+
+//! Read a varint
+/*!
+Reads an unsigned varint of at most \c maxSize bytes from \c stream,
+throwing XIOReadMismatch if it's longer and XIOEndOfStream if the
+stream ends first.
+*/
+UInt32                  readVarint(synergy::IStream* stream, UInt32 maxSize);
+
+//! An integer sent as \c Size bytes in network byte order, like \%Ni
+template <UInt32 Size>
+struct Int {
+    static_assert(Size == 1 || Size == 2 || Size == 4,
+                            "integers are 1, 2 or 4 bytes");
+
+    static const bool   kFixed = true;
+    static const UInt32 kSize  = Size;
+
+    template <typename T>
+    static UInt32       size(const T&) { return Size; }
+
+    template <typename T>
+    static UInt8*       encode(UInt8* out, const T& value)
+    {
+        const UInt32 v = static_cast<UInt32>(value);
+        for (UInt32 i = Size; i > 0; --i) {
+            *out++ = static_cast<UInt8>(v >> (8 * (i - 1)));
+        }
+        return out;
+    }
+
+    template <typename T>
+    static const UInt8* decode(const UInt8* in, T& value)
+    {
+        UInt32 v = 0;
+        for (UInt32 i = 0; i < Size; ++i) {
+            v = (v << 8) | *in++;
+        }
+
+        // sign extend short values read into wider signed integers
+        if (std::is_signed<T>::value && Size < 4 && (v >> (8 * Size - 1)) != 0) {
+            v |= ~((UInt32(1) << (8 * Size)) - 1);
+        }
+        value = static_cast<T>(v);
+        return in;
+    }
+
+    template <typename T>
+    static void         read(synergy::IStream* stream, T& value)
+    {
+        UInt8 buffer[Size];
+        readFully(stream, buffer, Size);
+        decode(buffer, value);
+    }
+};
+
+//! Bytes sent as a 4 byte length and the bytes, like \%s
+struct Bytes {
+    static const bool   kFixed = false;
+    static const UInt32 kSize  = 4;
+
+    static UInt32       size(const String& value)
+    {
+        return 4 + static_cast<UInt32>(value.size());
+    }
+
+    static UInt8*       encode(UInt8* out, const String& value)
+    {
+        out = Int<4>::encode(out, value.size());
+        return std::copy(value.begin(), value.end(), out);
+    }
+
+    static void         read(synergy::IStream* stream, String& value)
+    {
+        UInt32 size;
+        Int<4>::read(stream, size);
+        value.resize(size);
+        if (size != 0) {
+            readFully(stream, &value[0], size);
+        }
+    }
+};
+
+//! Integers sent as a 4 byte count and the integers, like \%NI
+template <UInt32 Size>
+struct IntList {
+    static const bool   kFixed = false;
+    static const UInt32 kSize  = 4;
+
+    template <typename T>
+    static UInt32       size(const std::vector<T>& value)
+    {
+        return 4 + Size * static_cast<UInt32>(value.size());
+    }
+
+    template <typename T>
+    static UInt8*       encode(UInt8* out, const std::vector<T>& value)
+    {
+        out = Int<4>::encode(out, value.size());
+        for (const T& v : value) {
+            out = Int<Size>::encode(out, v);
+        }
+        return out;
+    }
+
+    template <typename T>
+    static void         read(synergy::IStream* stream, std::vector<T>& value)
+    {
+        UInt32 count;
+        Int<4>::read(stream, count);
+
+        // read the whole list at once
+        std::vector<UInt8> buffer(static_cast<size_t>(count) * Size);
+        if (!buffer.empty()) {
+            readFully(stream, buffer.data(),
+                            static_cast<UInt32>(buffer.size()));
+        }
+        value.resize(count);
+        const UInt8* in = buffer.data();
+        for (T& v : value) {
+            in = Int<Size>::decode(in, v);
+        }
+    }
+};
+
+//! A signed integer sent as a zig-zag encoded varint
+/*!
+The value is mapped so small magnitudes of either sign are small
+unsigned numbers (0, -1, 1, -2 become 0, 1, 2, 3) and sent 7 bits per
+byte, least significant first, with the high bit set on every byte
+but the last.  Values from -64 to 63 take one byte.
+*/
+struct Varint {
+    static const bool   kFixed   = false;
+    static const UInt32 kSize    = 1;
+    static const UInt32 kMaxSize = 5;
+
+    static UInt32       size(SInt32 value)
+    {
+        UInt32 v = zigzag(value);
+        UInt32 n = 1;
+        while (v >= 0x80) {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+
+    static UInt8*       encode(UInt8* out, SInt32 value)
+    {
+        UInt32 v = zigzag(value);
+        while (v >= 0x80) {
+            *out++ = static_cast<UInt8>(v | 0x80);
+            v >>= 7;
+        }
+        *out++ = static_cast<UInt8>(v);
+        return out;
+    }
+
+    static void         read(synergy::IStream* stream, SInt32& value)
+    {
+        value = unzigzag(readVarint(stream, kMaxSize));
+    }
+
+    static UInt32       zigzag(SInt32 value)
+    {
+        return (static_cast<UInt32>(value) << 1) ^
+                            static_cast<UInt32>(value >> 31);
+    }
+
+    static SInt32       unzigzag(UInt32 v)
+    {
+        return static_cast<SInt32>((v >> 1) ^ (0U - (v & 1)));
+    }
+};
+
+//! The fields of a message
+/*!
+Describes how each of a message's fields is sent.  Messages whose
+fields are all fixed size are encoded into and decoded from a buffer
+on the stack whose size is known at compile time.
+*/
+template <typename... Fields>
+struct Layout {
+    //! True if every field has a fixed size
+    static const bool   kFixed = (true && ... && Fields::kFixed);
+
+    //! Bytes taken by the fields, or the least they take if not fixed
+    static const UInt32 kSize  = (0 + ... + Fields::kSize);
+
+    //! Number of fields
+    static const size_t kCount = sizeof...(Fields);
+
+    template <typename Tuple>
+    static UInt32       size(const Tuple& values)
+    {
+        return size(values, std::index_sequence_for<Fields...>());
+    }
+
+    template <typename Tuple>
+    static UInt8*       encode(UInt8* out, const Tuple& values)
+    {
+        return encode(out, values, std::index_sequence_for<Fields...>());
+    }
+
+    template <typename Tuple>
+    static void         read(synergy::IStream* stream, const Tuple& values)
+    {
+        read(stream, values, std::index_sequence_for<Fields...>());
+    }
+
+private:
+    template <typename Tuple, size_t... I>
+    static UInt32       size(const Tuple& values, std::index_sequence<I...>)
+    {
+        return (0 + ... + Fields::size(std::get<I>(values)));
+    }
+
+    template <typename Tuple, size_t... I>
+    static UInt8*       encode(UInt8* out, const Tuple& values,
+                            std::index_sequence<I...>)
+    {
+        ((out = Fields::encode(out, std::get<I>(values))), ...);
+        return out;
+    }
+
+    template <typename Tuple, size_t... I>
+    static void         read(synergy::IStream* stream, const Tuple& values,
+                            std::index_sequence<I...>)
+    {
+        if constexpr (kFixed) {
+            // one read for the whole message
+            UInt8 buffer[kSize + 1];
+            readFully(stream, buffer, kSize);
+            const UInt8* in = buffer;
+            ((in = Fields::decode(in, std::get<I>(values))), ...);
+            (void)in;
+        }
+        else {
+            (Fields::read(stream, std::get<I>(values)), ...);
+        }
+    }
+};
+
+//
+// messages.  see protocol_types.h for what each message means.  a
+// message's code is sent first, then its fields.
+//
+
+//! kMsgHello
+struct Hello {
+    static constexpr char kCode[] = "Synergy";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit Hello(SInt16 major = 0, SInt16 minor = 0) : m_major(major), m_minor(minor) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_major, self.m_minor); }
+
+    SInt16              m_major;
+    SInt16              m_minor;
+};
+
+//! kMsgHelloBack
+struct HelloBack {
+    static constexpr char kCode[] = "Synergy";
+    typedef Layout<Int<2>, Int<2>, Bytes> Fields;
+
+    explicit HelloBack(SInt16 major = 0, SInt16 minor = 0, const String& name = String()) :
+        m_major(major), m_minor(minor), m_name(name) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_major, self.m_minor, self.m_name); }
+
+    SInt16              m_major;
+    SInt16              m_minor;
+    String              m_name;
+};
+
+//! A message with no fields
+template <char A, char B, char C, char D>
+struct Empty {
+    static constexpr char kCode[] = { A, B, C, D, '\0' };
+    typedef Layout<> Fields;
+
+    template <class Self>
+    static auto         fields(Self&) { return std::tie(); }
+};
+
+typedef Empty<'C', 'N', 'O', 'P'> CNoop;            //!< kMsgCNoop
+typedef Empty<'C', 'B', 'Y', 'E'> CClose;           //!< kMsgCClose
+typedef Empty<'C', 'O', 'U', 'T'> CLeave;           //!< kMsgCLeave
+typedef Empty<'C', 'R', 'O', 'P'> CResetOptions;    //!< kMsgCResetOptions
+typedef Empty<'C', 'I', 'A', 'K'> CInfoAck;         //!< kMsgCInfoAck
+typedef Empty<'C', 'A', 'L', 'V'> CKeepAlive;       //!< kMsgCKeepAlive
+typedef Empty<'Q', 'I', 'N', 'F'> QInfo;            //!< kMsgQInfo
+typedef Empty<'E', 'B', 'S', 'Y'> EBusy;            //!< kMsgEBusy
+typedef Empty<'E', 'U', 'N', 'K'> EUnknown;         //!< kMsgEUnknown
+typedef Empty<'E', 'B', 'A', 'D'> EBad;             //!< kMsgEBad
+
+//! kMsgCEnter
+struct CEnter {
+    static constexpr char kCode[] = "CINN";
+    typedef Layout<Int<2>, Int<2>, Int<4>, Int<2>> Fields;
+
+    explicit CEnter(SInt16 x = 0, SInt16 y = 0, UInt32 seqNum = 0, UInt16 mask = 0) :
+        m_x(x), m_y(y), m_seqNum(seqNum), m_mask(mask) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_x, self.m_y, self.m_seqNum, self.m_mask); }
+
+    SInt16              m_x;
+    SInt16              m_y;
+    UInt32              m_seqNum;
+    UInt16              m_mask;
+};
+
+//! kMsgCClipboard
+struct CClipboard {
+    static constexpr char kCode[] = "CCLP";
+    typedef Layout<Int<1>, Int<4>> Fields;
+
+    explicit CClipboard(UInt8 id = 0, UInt32 seqNum = 0) : m_id(id), m_seqNum(seqNum) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_seqNum); }
+
+    UInt8               m_id;
+    UInt32              m_seqNum;
+};
+
+//! kMsgCScreenSaver
+struct CScreenSaver {
+    static constexpr char kCode[] = "CSEC";
+    typedef Layout<Int<1>> Fields;
+
+    explicit CScreenSaver(SInt8 on = 0) : m_on(on) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_on); }
+
+    SInt8               m_on;
+};
+
+//! kMsgDKeyDown
+struct DKeyDown {
+    static constexpr char kCode[] = "DKDN";
+    typedef Layout<Int<2>, Int<2>, Int<2>> Fields;
+
+    explicit DKeyDown(UInt16 id = 0, UInt16 mask = 0, UInt16 button = 0) :
+        m_id(id), m_mask(mask), m_button(button) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask, self.m_button); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+    UInt16              m_button;
+};
+
+//! kMsgDKeyDownLang
+struct DKeyDownLang {
+    static constexpr char kCode[] = "DKDL";
+    typedef Layout<Int<2>, Int<2>, Int<2>, Bytes> Fields;
+
+    explicit DKeyDownLang(UInt16 id = 0, UInt16 mask = 0, UInt16 button = 0,
+                const String& lang = String()) :
+        m_id(id), m_mask(mask), m_button(button), m_lang(lang) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask, self.m_button, self.m_lang); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+    UInt16              m_button;
+    String              m_lang;
+};
+
+//! kMsgDKeyDown1_0
+struct DKeyDown1_0 {
+    static constexpr char kCode[] = "DKDN";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit DKeyDown1_0(UInt16 id = 0, UInt16 mask = 0) : m_id(id), m_mask(mask) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+};
+
+//! kMsgDKeyRepeat
+struct DKeyRepeat {
+    static constexpr char kCode[] = "DKRP";
+    typedef Layout<Int<2>, Int<2>, Int<2>, Int<2>, Bytes> Fields;
+
+    explicit DKeyRepeat(UInt16 id = 0, UInt16 mask = 0, UInt16 count = 0,
+                UInt16 button = 0, const String& lang = String()) :
+        m_id(id), m_mask(mask), m_count(count), m_button(button), m_lang(lang) { }
+    template <class Self>
+    static auto         fields(Self& self)
+    {
+        return std::tie(self.m_id, self.m_mask, self.m_count, self.m_button, self.m_lang);
+    }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+    UInt16              m_count;
+    UInt16              m_button;
+    String              m_lang;
+};
+
+//! kMsgDKeyRepeat1_0
+struct DKeyRepeat1_0 {
+    static constexpr char kCode[] = "DKRP";
+    typedef Layout<Int<2>, Int<2>, Int<2>> Fields;
+
+    explicit DKeyRepeat1_0(UInt16 id = 0, UInt16 mask = 0, UInt16 count = 0) :
+        m_id(id), m_mask(mask), m_count(count) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask, self.m_count); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+    UInt16              m_count;
+};
+
+//! kMsgDKeyUp
+struct DKeyUp {
+    static constexpr char kCode[] = "DKUP";
+    typedef Layout<Int<2>, Int<2>, Int<2>> Fields;
+
+    explicit DKeyUp(UInt16 id = 0, UInt16 mask = 0, UInt16 button = 0) :
+        m_id(id), m_mask(mask), m_button(button) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask, self.m_button); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+    UInt16              m_button;
+};
+
+//! kMsgDKeyUp1_0
+struct DKeyUp1_0 {
+    static constexpr char kCode[] = "DKUP";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit DKeyUp1_0(UInt16 id = 0, UInt16 mask = 0) : m_id(id), m_mask(mask) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_mask); }
+
+    UInt16              m_id;
+    UInt16              m_mask;
+};
+
+//! kMsgDMouseDown
+struct DMouseDown {
+    static constexpr char kCode[] = "DMDN";
+    typedef Layout<Int<1>> Fields;
+
+    explicit DMouseDown(SInt8 id = 0) : m_id(id) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id); }
+
+    SInt8               m_id;
+};
+
+//! kMsgDMouseUp
+struct DMouseUp {
+    static constexpr char kCode[] = "DMUP";
+    typedef Layout<Int<1>> Fields;
+
+    explicit DMouseUp(SInt8 id = 0) : m_id(id) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id); }
+
+    SInt8               m_id;
+};
+
+//! kMsgDMouseMove
+struct DMouseMove {
+    static constexpr char kCode[] = "DMMV";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit DMouseMove(SInt16 x = 0, SInt16 y = 0) : m_x(x), m_y(y) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_x, self.m_y); }
+
+    SInt16              m_x;
+    SInt16              m_y;
+};
+
+//! kMsgDMouseRelMove
+struct DMouseRelMove {
+    static constexpr char kCode[] = "DMRM";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit DMouseRelMove(SInt16 dx = 0, SInt16 dy = 0) : m_dx(dx), m_dy(dy) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_dx, self.m_dy); }
+
+    SInt16              m_dx;
+    SInt16              m_dy;
+};
+
+//! kMsgDMouseDelta
+struct DMouseDelta {
+    static constexpr char kCode[] = "DMDT";
+    typedef Layout<Varint, Varint> Fields;
+
+    explicit DMouseDelta(SInt32 dx = 0, SInt32 dy = 0) : m_dx(dx), m_dy(dy) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_dx, self.m_dy); }
+
+    SInt32              m_dx;
+    SInt32              m_dy;
+};
+
+//! kMsgDMouseWheel
+struct DMouseWheel {
+    static constexpr char kCode[] = "DMWM";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit DMouseWheel(SInt16 xDelta = 0, SInt16 yDelta = 0) :
+        m_xDelta(xDelta), m_yDelta(yDelta) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_xDelta, self.m_yDelta); }
+
+    SInt16              m_xDelta;
+    SInt16              m_yDelta;
+};
+
+//! kMsgDMouseWheel1_0
+struct DMouseWheel1_0 {
+    static constexpr char kCode[] = "DMWM";
+    typedef Layout<Int<2>> Fields;
+
+    explicit DMouseWheel1_0(SInt16 yDelta = 0) : m_yDelta(yDelta) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_yDelta); }
+
+    SInt16              m_yDelta;
+};
+
+//! kMsgDClipboard
+struct DClipboard {
+    static constexpr char kCode[] = "DCLP";
+    typedef Layout<Int<1>, Int<4>, Int<1>, Bytes> Fields;
+
+    explicit DClipboard(UInt8 id = 0, UInt32 seqNum = 0, UInt8 mark = 0,
+                const String& data = String()) :
+        m_id(id), m_seqNum(seqNum), m_mark(mark), m_data(data) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_id, self.m_seqNum, self.m_mark, self.m_data); }
+
+    UInt8               m_id;
+    UInt32              m_seqNum;
+    UInt8               m_mark;
+    String              m_data;
+};
+
+//! kMsgDInfo
+struct DInfo {
+    static constexpr char kCode[] = "DINF";
+    typedef Layout<Int<2>, Int<2>, Int<2>, Int<2>, Int<2>, Int<2>, Int<2>> Fields;
+
+    explicit DInfo(SInt16 x = 0, SInt16 y = 0, SInt16 w = 0, SInt16 h = 0,
+                SInt16 zoneSize = 0, SInt16 mx = 0, SInt16 my = 0) :
+        m_x(x), m_y(y), m_w(w), m_h(h), m_zoneSize(zoneSize), m_mx(mx), m_my(my) { }
+    template <class Self>
+    static auto         fields(Self& self)
+    {
+        return std::tie(self.m_x, self.m_y, self.m_w, self.m_h,
+                            self.m_zoneSize, self.m_mx, self.m_my);
+    }
+
+    SInt16              m_x;
+    SInt16              m_y;
+    SInt16              m_w;
+    SInt16              m_h;
+    SInt16              m_zoneSize;
+    SInt16              m_mx;
+    SInt16              m_my;
+};
+
+//! kMsgDSetOptions
+struct DSetOptions {
+    static constexpr char kCode[] = "DSOP";
+    typedef Layout<IntList<4>> Fields;
+
+    explicit DSetOptions(const std::vector<UInt32>& options = std::vector<UInt32>()) :
+        m_options(options) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_options); }
+
+    std::vector<UInt32> m_options;
+};
+
+//! kMsgDFileTransfer
+struct DFileTransfer {
+    static constexpr char kCode[] = "DFTR";
+    typedef Layout<Int<1>, Bytes> Fields;
+
+    explicit DFileTransfer(UInt8 mark = 0, const String& data = String()) :
+        m_mark(mark), m_data(data) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_mark, self.m_data); }
+
+    UInt8               m_mark;
+    String              m_data;
+};
+
+//! kMsgDDragInfo
+struct DDragInfo {
+    static constexpr char kCode[] = "DDRG";
+    typedef Layout<Int<2>, Bytes> Fields;
+
+    explicit DDragInfo(UInt16 fileCount = 0, const String& data = String()) :
+        m_fileCount(fileCount), m_data(data) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_fileCount, self.m_data); }
+
+    UInt16              m_fileCount;
+    String              m_data;
+};
+
+//! kMsgDSecureInputNotification
+struct DSecureInputNotification {
+    static constexpr char kCode[] = "SECN";
+    typedef Layout<Bytes> Fields;
+
+    explicit DSecureInputNotification(const String& app = String()) : m_app(app) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_app); }
+
+    String              m_app;
+};
+
+//! kMsgDLanguageSynchronisation
+struct DLanguageSynchronisation {
+    static constexpr char kCode[] = "LSYN";
+    typedef Layout<Bytes> Fields;
+
+    explicit DLanguageSynchronisation(const String& languages = String()) :
+        m_languages(languages) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_languages); }
+
+    String              m_languages;
+};
+
+//! kMsgEIncompatible
+struct EIncompatible {
+    static constexpr char kCode[] = "EICV";
+    typedef Layout<Int<2>, Int<2>> Fields;
+
+    explicit EIncompatible(SInt16 major = 0, SInt16 minor = 0) : m_major(major), m_minor(minor) { }
+    template <class Self>
+    static auto         fields(Self& self) { return std::tie(self.m_major, self.m_minor); }
+
+    SInt16              m_major;
+    SInt16              m_minor;
+};
+
+} // namespace protocol
+} // namespace synergy
@@ -134,19 +134,13 @@ ProtocolUtil::vwritef(synergy::IStream* stream,
         return;
     }
 
-    // fill buffer
+    // fill buffer.  size is exact so it's allocated just once.
     std::vector<UInt8> Buffer;
+    Buffer.reserve(size);
     writef(Buffer, fmt, args);
 
-    try {
-        // write buffer
-        stream->write(Buffer.data(), size);
-        LOG((CLOG_DEBUG2 "wrote %d bytes", size));
-    }
-    catch (const XBase& exception) {
-        LOG((CLOG_DEBUG2 "Exception <%s> during wrote %d bytes into stream", exception.what(), size));
-        throw;
-    }
+    // write buffer
+    write(stream, Buffer.data(), size);
 }
 
 void
@@ -418,23 +412,21 @@ ProtocolUtil::eatLength(const char** pfmt)
 void
 ProtocolUtil::read(synergy::IStream* stream, void* vbuffer, UInt32 count)
 {
-    assert(stream != NULL);
-    assert(vbuffer != NULL);
-
-    UInt8* buffer = static_cast<UInt8*>(vbuffer);
-    while (count > 0) {
-        // read more
-        UInt32 n = stream->read(buffer, count);
+    synergy::protocol::readFully(stream, vbuffer, count);
+}
 
-        // bail if stream has hungup
-        if (n == 0) {
-            LOG((CLOG_DEBUG2 "unexpected disconnect in readf(), %d bytes left", count));
-            throw XIOEndOfStream();
-        }
+void
+ProtocolUtil::write(synergy::IStream* stream, const void* buffer, UInt32 size)
+{
+    assert(stream != NULL);
 
-        // prepare for next read
-        buffer += n;
-        count  -= n;
+    try {
+        stream->write(buffer, size);
+        LOG((CLOG_DEBUG2 "wrote %d bytes", size));
+    }
+    catch (const XBase& exception) {
+        LOG((CLOG_DEBUG2 "Exception <%s> during wrote %d bytes into stream", exception.what(), size));
+        throw;
     }
 }
 
@@ -551,6 +543,52 @@ void ProtocolUtil::readBytes(synergy::IStream * stream, UInt32 len, String* dest
 }
 
 
+//
+// synergy::protocol
+//
+
+void
+synergy::protocol::readFully(synergy::IStream* stream, void* vbuffer, UInt32 count)
+{
+    assert(stream != NULL);
+    assert(vbuffer != NULL || count == 0);
+
+    UInt8* buffer = static_cast<UInt8*>(vbuffer);
+    while (count > 0) {
+        // read more
+        UInt32 n = stream->read(buffer, count);
+
+        // bail if stream has hungup
+        if (n == 0) {
+            LOG((CLOG_DEBUG2 "unexpected disconnect in readf(), %d bytes left", count));
+            throw XIOEndOfStream();
+        }
+
+        // prepare for next read
+        buffer += n;
+        count  -= n;
+    }
+}
+
+UInt32
+synergy::protocol::readVarint(synergy::IStream* stream, UInt32 maxSize)
+{
+    // a well formed value has at most maxSize bytes.  anything longer
+    // means we've lost our place in the stream.
+    UInt32 v = 0;
+    for (UInt32 i = 0; i < maxSize; ++i) {
+        UInt8 byte;
+        readFully(stream, &byte, 1);
+        v |= static_cast<UInt32>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return v;
+        }
+    }
+    LOG((CLOG_DEBUG2 "readVarint: more than %d bytes", maxSize));
+    throw XIOReadMismatch();
+}
+
+
 //
 // XIOReadMismatch
 //
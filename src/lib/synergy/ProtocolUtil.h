@@ -18,9 +18,12 @@
 
 #pragma once
 
+#include "synergy/ProtocolMessage.h"
 #include "io/XIO.h"
 #include "base/EventTypes.h"
 
+#include <memory>
+#include <new>
 #include <stdarg.h>
 
 namespace synergy { class IStream; }
@@ -72,7 +75,54 @@ public:
     static bool           readf(synergy::IStream*,
                             const char* fmt, ...);
 
+    //! Write a message
+    /*!
+    Writes a message from ProtocolMessage.h to a stream with a single
+    write.  The bytes written are the same as writef() with the
+    message's format.  Messages with only fixed size fields are
+    encoded in a buffer on the stack.
+    */
+    template <class Message>
+    static void           writeMessage(synergy::IStream*,
+                            const Message&);
+
+    //! Write a message from values
+    /*!
+    Like writeMessage() but takes the values of the message's fields,
+    in order, so strings and lists aren't copied into a message.
+    */
+    template <class Message, typename... T>
+    static void           writeMessage(synergy::IStream*,
+                            const T&... values);
+
+    //! Read a message
+    /*!
+    Reads the fields of a message from ProtocolMessage.h, not including
+    its code, from a stream.  Messages with only fixed size fields are
+    read with a single read.  Returns true if the whole message was
+    read, false otherwise.
+    */
+    template <class Message>
+    static bool           readMessage(synergy::IStream*,
+                            Message&);
+
+    //! Read a message into values
+    /*!
+    Like readMessage() but reads the message's fields into \c values,
+    in order.
+    */
+    template <class Message, typename... T>
+    static bool           readMessage(synergy::IStream*,
+                            T&... values);
+
 private:
+    template <class Message, class Tuple>
+    static void           writeFields(synergy::IStream*, const Tuple&);
+    template <class Message, class Tuple>
+    static bool           readFields(synergy::IStream*, const Tuple&);
+    static void           write(synergy::IStream*,
+                            const void*, UInt32);
+
     static void           vwritef(synergy::IStream*,
                             const char* fmt, UInt32 size, va_list);
     static void           vreadf(synergy::IStream*,
@@ -103,6 +153,84 @@ private:
     static void           readBytes(synergy::IStream*, UInt32, String*);
 };
 
+template <class Message>
+void
+ProtocolUtil::writeMessage(synergy::IStream* stream, const Message& message)
+{
+    writeFields<Message>(stream, Message::fields(message));
+}
+
+template <class Message, typename... T>
+void
+ProtocolUtil::writeMessage(synergy::IStream* stream, const T&... values)
+{
+    static_assert(sizeof...(T) == Message::Fields::kCount,
+                            "wrong number of values for message");
+    writeFields<Message>(stream, std::tie(values...));
+}
+
+template <class Message>
+bool
+ProtocolUtil::readMessage(synergy::IStream* stream, Message& message)
+{
+    return readFields<Message>(stream, Message::fields(message));
+}
+
+template <class Message, typename... T>
+bool
+ProtocolUtil::readMessage(synergy::IStream* stream, T&... values)
+{
+    static_assert(sizeof...(T) == Message::Fields::kCount,
+                            "wrong number of values for message");
+    return readFields<Message>(stream, std::tie(values...));
+}
+
+template <class Message, class Tuple>
+void
+ProtocolUtil::writeFields(synergy::IStream* stream, const Tuple& values)
+{
+    typedef typename Message::Fields Fields;
+    const UInt32 codeSize = sizeof(Message::kCode) - 1;
+
+    if constexpr (Fields::kFixed) {
+        UInt8 buffer[codeSize + Fields::kSize];
+        UInt8* out = std::copy(Message::kCode, Message::kCode + codeSize, buffer);
+        Fields::encode(out, values);
+        write(stream, buffer, sizeof(buffer));
+    }
+    else {
+        // most messages with strings are small so only allocate for
+        // big ones, e.g. clipboard chunks
+        UInt8 small[256];
+        std::unique_ptr<UInt8[]> big;
+        const UInt32 size = codeSize + Fields::size(values);
+        UInt8* buffer     = small;
+        if (size > sizeof(small)) {
+            big.reset(new UInt8[size]);
+            buffer = big.get();
+        }
+        UInt8* out = std::copy(Message::kCode, Message::kCode + codeSize, buffer);
+        Fields::encode(out, values);
+        write(stream, buffer, size);
+    }
+}
+
+template <class Message, class Tuple>
+bool
+ProtocolUtil::readFields(synergy::IStream* stream, const Tuple& values)
+{
+    try {
+        Message::Fields::read(stream, values);
+        return true;
+    }
+    catch (XIO&) {
+        return false;
+    }
+    catch (const std::bad_alloc&) {
+        return false;
+    }
+}
+
 //! Mismatched read exception
 /*!
 Thrown by ProtocolUtil::readf() when the data being read does not
@@ -28,6 +28,7 @@
 #include "synergy/ServerTaskBarReceiver.h"
 #include "synergy/ServerArgs.h"
 #include "net/SocketMultiplexer.h"
+#include "net/SecureSocket.h"
 #include "net/TCPSocketFactory.h"
 #include "net/XSocket.h"
 #include "arch/Arch.h"
@@ -57,6 +58,7 @@
 #include "platform/OSXDragSimulator.h"
 #endif
 
+#include <memory>
 #include <iostream>
 #include <stdio.h>
 #include <fstream>
@@ -133,6 +135,8 @@ ServerApp::help()
         "Usage: %s"
         " [--address <address>]"
         " [--config <pathname>]"
+        " [--net-threads <count>]"
+        " [--listen-backlog <count>]"
         WINAPI_ARGS
         HELP_SYS_ARGS
         HELP_COMMON_ARGS
@@ -141,6 +145,10 @@ ServerApp::help()
         "\n"
         "  -a, --address <address>  listen for clients on the given address.\n"
         "  -c, --config <pathname>  use the named configuration file instead.\n"
+        "      --net-threads <count> service client connections on count threads.\n"
+        "                             the default is 1.\n"
+        "      --listen-backlog <count> queue up to count connecting clients.\n"
+        "                             the default is the system maximum.\n"
         HELP_COMMON_INFO_1
         WINAPI_INFO
         HELP_SYS_INFO
@@ -644,9 +652,11 @@ ServerApp::openClientListener(const NetworkAddress& address)
 {
     auto* listen = new ClientListener(
         address,
-        new TCPSocketFactory(m_events, getSocketMultiplexer()),
+        new TCPSocketFactory(m_events, getSocketMultiplexer(),
+                            getHandshakeMultiplexer(), args().m_enableKernelTls),
         m_events,
-        args().m_enableCrypto);
+        args().m_enableCrypto,
+        args().m_listenBacklog);
 
     m_events->adoptHandler(
         m_events->forClientListener().connected(), listen,
@@ -693,9 +703,19 @@ ServerApp::mainLoop()
 {
     // create socket multiplexer.  this must happen after daemonization
     // on unix because threads evaporate across a fork().
-    SocketMultiplexer multiplexer;
+    SocketMultiplexer multiplexer(args().m_netThreads);
     setSocketMultiplexer(&multiplexer);
 
+    // tls handshakes get their own multiplexer so they don't hold up
+    // connected sockets.  it's torn down with the socket multiplexer
+    // after the sockets are gone.
+    std::unique_ptr<SocketMultiplexer> handshakeMultiplexer;
+    if (args().m_enableCrypto) {
+        handshakeMultiplexer.reset(
+            new SocketMultiplexer(SecureSocket::kHandshakeThreads));
+    }
+    setHandshakeMultiplexer(handshakeMultiplexer.get());
+
     // if configuration has no screens then add this system
     // as the default
     if (args().m_config->begin() == args().m_config->end()) {
@@ -41,6 +41,8 @@ namespace lib {
             String               m_configFile    = "";       /// @brief Contains the path to the config file
             SerialKey            m_serial;                   /// @brief Contains the serial number and license info
             std::shared_ptr<Config>              m_config;  /// @brief Contains the Parsed Configuration settings
+            int                  m_netThreads    = 1;        /// @brief Number of threads servicing client sockets
+            int                  m_listenBacklog = 0;        /// @brief Connections left waiting to be accepted, 0 for the system maximum
 
             /// Private Functions
         private:
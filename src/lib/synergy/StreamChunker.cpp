@@ -17,11 +17,12 @@
 
 #include "synergy/StreamChunker.h"
 
+#include "mt/CondVar.h"
 #include "mt/Lock.h"
 #include "mt/Mutex.h"
 #include "synergy/FileChunk.h"
-#include "synergy/ClipboardChunk.h"
 #include "synergy/protocol_types.h"
+#include "arch/Arch.h"
 #include "base/EventTypes.h"
 #include "base/Event.h"
 #include "base/IEventQueue.h"
@@ -40,6 +41,19 @@ static const size_t g_chunkSize = 512 * 1024; //512kb
 bool StreamChunker::s_isChunkingFile = false;
 bool StreamChunker::s_interruptFile = false;
 Mutex* StreamChunker::s_interruptMutex = NULL;
+int StreamChunker::s_filePauses = 0;
+int StreamChunker::s_fileChunksQueued = 0;
+
+// a file send waits on this until it can queue another chunk or is
+// interrupted.  it's made on first use, after ARCH exists, and never
+// destroyed since the file thread may still be waiting on it at exit.
+static CondVarBase&
+getFileResumed()
+{
+    static Mutex* s_mutex         = new Mutex;
+    static CondVarBase* s_resumed = new CondVarBase(s_mutex);
+    return *s_resumed;
+}
 
 void
 StreamChunker::sendFile(
@@ -48,7 +62,11 @@ StreamChunker::sendFile(
                 void* eventTarget)
 {
     s_isChunkingFile = true;
-    
+    {
+        Lock lock(&getFileResumed());
+        s_fileChunksQueued = 0;
+    }
+
     std::fstream file(static_cast<char*>(filename), std::ios::in | std::ios::binary);
 
     if (!file.is_open()) {
@@ -63,7 +81,7 @@ StreamChunker::sendFile(
     String fileSize = synergy::string::sizeTypeToString(size);
     FileChunk* sizeMessage = FileChunk::start(fileSize);
 
-    events->addEvent(Event(events->forFile().fileChunkSending(), eventTarget, sizeMessage));
+    queueFileChunk(events, eventTarget, sizeMessage);
 
     // send chunk messages with a fixed chunk size
     size_t sentLength = 0;
@@ -71,6 +89,17 @@ StreamChunker::sendFile(
     file.seekg (0, std::ios::beg);
 
     while (true) {
+        // don't read ahead of the stream.  wait for the last chunk to be
+        // written and, if that congested the stream, for it to drain.
+        {
+            CondVarBase& resumed = getFileResumed();
+            Lock lock(&resumed);
+            while ((s_filePauses > 0 || s_fileChunksQueued > 0) &&
+                            !s_interruptFile) {
+                resumed.wait();
+            }
+        }
+
         if (s_interruptFile) {
             s_interruptFile = false;
             LOG((CLOG_DEBUG "file transmission interrupted"));
@@ -90,7 +119,7 @@ StreamChunker::sendFile(
         FileChunk* fileChunk = FileChunk::data(data, chunkSize);
         delete[] chunkData;
 
-        events->addEvent(Event(events->forFile().fileChunkSending(), eventTarget, fileChunk));
+        queueFileChunk(events, eventTarget, fileChunk);
 
         sentLength += chunkSize;
         file.seekg (sentLength, std::ios::beg);
@@ -103,7 +132,7 @@ StreamChunker::sendFile(
     // send last message
     FileChunk* end = FileChunk::end();
 
-    events->addEvent(Event(events->forFile().fileChunkSending(), eventTarget, end));
+    queueFileChunk(events, eventTarget, end);
 
     file.close();
     
@@ -111,56 +140,59 @@ StreamChunker::sendFile(
 }
 
 void
-StreamChunker::sendClipboard(
-                String& data,
-                size_t size,
-                ClipboardID id,
-                UInt32 sequence,
-                IEventQueue* events,
-                void* eventTarget)
+StreamChunker::queueFileChunk(IEventQueue* events, void* eventTarget,
+                FileChunk* chunk)
 {
-    // send first message (data size)
-    String dataSize = synergy::string::sizeTypeToString(size);
-    ClipboardChunk* sizeMessage = ClipboardChunk::start(id, sequence, dataSize);
-    
-    events->addEvent(Event(events->forClipboard().clipboardSending(), eventTarget, sizeMessage));
-
-    // send clipboard chunk with a fixed size
-    size_t sentLength = 0;
-    size_t chunkSize = g_chunkSize;
-    
-    while (true) {
-        events->addEvent(Event(events->forFile().keepAlive(), eventTarget));
-        
-        // make sure we don't read too much from the mock data.
-        if (sentLength + chunkSize > size) {
-            chunkSize = size - sentLength;
-        }
-
-        String chunk(data.substr(sentLength, chunkSize).c_str(), chunkSize);
-        ClipboardChunk* dataChunk = ClipboardChunk::data(id, sequence, chunk);
-        
-        events->addEvent(Event(events->forClipboard().clipboardSending(), eventTarget, dataChunk));
-
-        sentLength += chunkSize;
-        if (sentLength == size) {
-            break;
-        }
+    {
+        Lock lock(&getFileResumed());
+        ++s_fileChunksQueued;
     }
+    events->addEvent(Event(events->forFile().fileChunkSending(), eventTarget, chunk));
+}
 
-    // send last message
-    ClipboardChunk* end = ClipboardChunk::end(id, sequence);
-
-    events->addEvent(Event(events->forClipboard().clipboardSending(), eventTarget, end));
-    
-    LOG((CLOG_DEBUG "sent clipboard size=%d", sentLength));
+void
+StreamChunker::fileChunkSent()
+{
+    CondVarBase& resumed = getFileResumed();
+    Lock lock(&resumed);
+    if (s_fileChunksQueued > 0 && --s_fileChunksQueued == 0) {
+        resumed.broadcast();
+    }
 }
 
 void
 StreamChunker::interruptFile()
 {
     if (s_isChunkingFile) {
+        // wake the file send if it's paused
+        CondVarBase& resumed = getFileResumed();
+        Lock lock(&resumed);
         s_interruptFile = true;
+        resumed.broadcast();
         LOG((CLOG_INFO "previous dragged file has become invalid"));
     }
 }
+
+void
+StreamChunker::pauseFile()
+{
+    CondVarBase& resumed = getFileResumed();
+    Lock lock(&resumed);
+    ++s_filePauses;
+}
+
+void
+StreamChunker::resumeFile()
+{
+    CondVarBase& resumed = getFileResumed();
+    Lock lock(&resumed);
+    if (--s_filePauses == 0) {
+        resumed.broadcast();
+    }
+}
+
+size_t
+StreamChunker::getChunkSize()
+{
+    return g_chunkSize;
+}
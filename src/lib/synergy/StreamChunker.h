@@ -22,6 +22,7 @@
 
 class IEventQueue;
 class Mutex;
+class FileChunk;
 
 class StreamChunker {
 public:
@@ -29,17 +30,45 @@ public:
                             char* filename,
                             IEventQueue* events,
                             void* eventTarget);
-    static void            sendClipboard(
-                            String& data,
-                            size_t size,
-                            ClipboardID id,
-                            UInt32 sequence,
-                            IEventQueue* events,
-                            void* eventTarget);
     static void            interruptFile();
+
+    //! Report a file chunk written
+    /*!
+    Called by the handler of the file chunk sending event once it has
+    written the chunk.  \c sendFile() doesn't queue the next chunk until
+    then, so chunks don't pile up in the event queue ahead of the
+    stream.  The handler should call \c pauseFile() first if the stream
+    is congested.
+    */
+    static void            fileChunkSent();
+
+    //! Pause sending files
+    /*!
+    Stops \c sendFile() reading more chunks until a matching call to
+    \c resumeFile().  Used while a client isn't keeping up.  Calls nest.
+    */
+    static void            pauseFile();
+
+    //! Resume sending files
+    /*!
+    Undoes a call to \c pauseFile().
+    */
+    static void            resumeFile();
+
+    //! Get chunk size
+    /*!
+    Returns the largest amount of data sent in one chunk.
+    */
+    static size_t        getChunkSize();
     
+private:
+    static void            queueFileChunk(IEventQueue* events,
+                            void* eventTarget, FileChunk* chunk);
+
 private:
     static bool            s_isChunkingFile;
     static bool            s_interruptFile;
     static Mutex*        s_interruptMutex;
+    static int            s_filePauses;
+    static int            s_fileChunksQueued;
 };
@@ -70,6 +70,8 @@ static const OptionID    kOptionWin32KeepForeground        = OPTION_CODE("_KFW")
 static const OptionID    kOptionDisableLockToScreen    = OPTION_CODE("DLTS");
 static const OptionID    kOptionClipboardSharing            = OPTION_CODE("CLPS");
 static const OptionID   kOptionClipboardSharingSize     = OPTION_CODE("CLSZ");
+static const OptionID   kOptionInputBatchWindow         = OPTION_CODE("IBTW");
+static const OptionID   kOptionAbsoluteMotionInterval   = OPTION_CODE("AMIV");
 //@}
 
 //! @name Screen switch corner enumeration
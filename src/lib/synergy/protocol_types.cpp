@@ -40,6 +40,7 @@ const char* const               kMsgDMouseDown        = "DMDN%1i";
 const char* const               kMsgDMouseUp        = "DMUP%1i";
 const char* const               kMsgDMouseMove        = "DMMV%2i%2i";
 const char* const               kMsgDMouseRelMove    = "DMRM%2i%2i";
+const char* const               kMsgDMouseDelta        = "DMDT";
 const char* const               kMsgDMouseWheel        = "DMWM%2i%2i";
 const char* const               kMsgDMouseWheel1_0    = "DMWM%2i";
 const char* const               kMsgDClipboard        = "DCLP%1i%4i%1i%s";
@@ -31,9 +31,10 @@
 // 1.6:  adds clipboard streaming
 // 1.7   adds security input notifications
 // 1.8   adds language synchronization functionality
+// 1.9   allows several messages in one packet, adds compact mouse motion
 // NOTE: with new version, synergy minor version should increment
 static const SInt16        kProtocolMajorVersion = 1;
-static const SInt16        kProtocolMinorVersion = 8;
+static const SInt16        kProtocolMinorVersion = 9;
 
 // default contact port number
 static const UInt16        kDefaultPort = 24800;
@@ -94,6 +95,13 @@ enum EDataReceived {
 // except those for the greeting handshake.
 //
 
+//
+// messages are sent in packets: a 4 byte length and then that many
+// bytes.  until 1.9 every packet holds exactly one message.  from 1.9
+// the server may put several messages back to back in one packet and
+// the client parses them in order.
+//
+
 //
 // positions and sizes are signed 16 bit integers.
 //
@@ -231,6 +239,15 @@ extern const char* const       kMsgDMouseMove;
 // $1 = dx, $2 = dy.  dx,dy are motion deltas.
 extern const char* const       kMsgDMouseRelMove;
 
+// compact mouse moved:  primary -> secondary
+// $1 = dx, $2 = dy.  dx,dy are the change from the position in the
+// last kMsgDMouseMove, kMsgDMouseDelta or kMsgCEnter, each sent as a
+// zig-zag encoded varint (see synergy::protocol::Varint) rather than
+// a fixed size integer.  relative moves don't change that position.
+// the primary still sends an absolute kMsgDMouseMove every so often
+// and when a delta wouldn't be shorter.  added in 1.9.
+extern const char* const       kMsgDMouseDelta;
+
 // mouse scroll:  primary -> secondary
 // $1 = xDelta, $2 = yDelta.  the delta should be +120 for one tick forward
 // (away from the user) or right and -120 for one tick backward (toward
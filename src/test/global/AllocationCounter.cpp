@@ -0,0 +1,71 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test/global/AllocationCounter.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+// the count of the thread's counter, if it has one
+static thread_local int* s_count = nullptr;
+
+//
+// AllocationCounter
+//
+
+AllocationCounter::AllocationCounter() :
+    m_count(0)
+{
+    assert(s_count == nullptr);
+    s_count = &m_count;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+    s_count = nullptr;
+}
+
+//
+// replacements for the global allocation functions.  the array and
+// nothrow forms call these.
+//
+
+void*
+operator new(std::size_t size)
+{
+    if (s_count != nullptr) {
+        ++*s_count;
+    }
+    void* p = std::malloc(size != 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,41 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+//! Counts heap allocations
+/*!
+Counts the calls the creating thread makes to the global \c operator
+\c new while the counter exists.  Allocations made by other threads
+aren't counted.  Counters don't nest.
+*/
+class AllocationCounter {
+public:
+    AllocationCounter();
+    AllocationCounter(AllocationCounter const &) =delete;
+    AllocationCounter(AllocationCounter &&) =delete;
+    ~AllocationCounter();
+
+    AllocationCounter& operator=(AllocationCounter const &) =delete;
+    AllocationCounter& operator=(AllocationCounter &&) =delete;
+
+    //! Get the number of allocations counted so far
+    int                 getCount() const { return m_count; }
+
+private:
+    int                 m_count;
+};
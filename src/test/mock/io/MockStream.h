@@ -31,6 +31,9 @@ public:
     MOCK_METHOD(void, close, (), (override));
     MOCK_METHOD(UInt32, read, (void*, UInt32), (override));
     MOCK_METHOD(void, write, (const void*, UInt32), (override));
+    MOCK_METHOD(void, writeVector, (const void* const*, const UInt32*, int), (override));
+    MOCK_METHOD(void, beginBatch, (), (override));
+    MOCK_METHOD(void, endBatch, (), (override));
     MOCK_METHOD(void, flush, (), (override));
     MOCK_METHOD(void, shutdownInput, (), (override));
     MOCK_METHOD(void, shutdownOutput, (), (override));
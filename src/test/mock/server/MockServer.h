@@ -20,6 +20,7 @@
 #define TEST_ENV
 
 #include "server/Server.h"
+#include "mt/Thread.h"
 
 #include "test/global/gmock.h"
 
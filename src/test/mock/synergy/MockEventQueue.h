@@ -41,6 +41,7 @@ public:
     MOCK_METHOD(bool, dispatchEvent, (const Event&), (override));
     MOCK_METHOD(IEventJob*, getHandler, (Event::Type, void*), (const, override));
     MOCK_METHOD(void, deleteTimer, (EventQueueTimer*), (override));
+    MOCK_METHOD(void, rearmTimer, (EventQueueTimer*, double), (override));
     MOCK_METHOD(Event::Type, getRegisteredType, (const String&), (const, override));
     MOCK_METHOD(void*, getSystemTarget, (), (override));
     MOCK_METHOD(ClientEvents&, forClient, (), (override));
@@ -52,6 +53,7 @@ public:
     MOCK_METHOD(IDataSocketEvents&, forIDataSocket, (), (override));
     MOCK_METHOD(IListenSocketEvents&, forIListenSocket, (), (override));
     MOCK_METHOD(ISocketEvents&, forISocket, (), (override));
+    MOCK_METHOD(HostResolverEvents&, forHostResolver, (), (override));
     MOCK_METHOD(OSXScreenEvents&, forOSXScreen, (), (override));
     MOCK_METHOD(ClientListenerEvents&, forClientListener, (), (override));
     MOCK_METHOD(ClientProxyEvents&, forClientProxy, (), (override));
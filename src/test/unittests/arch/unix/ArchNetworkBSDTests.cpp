@@ -17,7 +17,9 @@
 
 #ifndef _WIN32
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <netinet/in.h>
+#include <unistd.h>
 #include <array>
 #include <memory>
 #include "lib/arch/unix/ArchNetworkBSD.h"
@@ -60,4 +62,73 @@ TEST(ArchNetworkBSDTests, isAnyAddr_IP6)
     EXPECT_FALSE(networkBSD.isAnyAddr(addr.get()));
 }
 
+#if HAVE_SYS_EPOLL_H
+
+TEST(ArchNetworkBSDTests, waitPollSet_reportsOnlyRegisteredEvents)
+{
+    ArchNetworkBSD networkBSD;
+    networkBSD.init();
+    ArchPollSet set = networkBSD.newPollSet();
+    ASSERT_NE(set, nullptr);
+
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ArchSocketImpl socket { fds[0], 1 };
+    int data = 0;
+
+    // a connected socket is writable but we only ask for readability
+    networkBSD.updatePollSet(set, &socket, IArchNetwork::kPOLLIN, &data);
+    std::array<IArchNetwork::PollSetEntry, 4> pe {};
+    EXPECT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 0);
+
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    ASSERT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 1);
+    EXPECT_EQ(pe[0].m_data, &data);
+    EXPECT_EQ(pe[0].m_revents, IArchNetwork::kPOLLIN);
+
+    // changing interest doesn't need the socket to be registered again
+    networkBSD.updatePollSet(set, &socket, IArchNetwork::kPOLLOUT, &data);
+    ASSERT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 1);
+    EXPECT_EQ(pe[0].m_revents, IArchNetwork::kPOLLOUT);
+
+    networkBSD.removeFromPollSet(set, &socket);
+    EXPECT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 0);
+
+    // removing twice is harmless
+    networkBSD.removeFromPollSet(set, &socket);
+
+    networkBSD.closePollSet(set);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(ArchNetworkBSDTests, waitPollSet_hungUpPeer_reportsReadable)
+{
+    ArchNetworkBSD networkBSD;
+    networkBSD.init();
+    ArchPollSet set = networkBSD.newPollSet();
+    ASSERT_NE(set, nullptr);
+
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ArchSocketImpl socket { fds[0], 1 };
+    int data = 0;
+
+    // the hang up is reported even though nothing was asked for so
+    // reading finds the end of the stream
+    networkBSD.updatePollSet(set, &socket, 0, &data);
+    std::array<IArchNetwork::PollSetEntry, 4> pe {};
+    EXPECT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 0);
+
+    close(fds[1]);
+    ASSERT_EQ(networkBSD.waitPollSet(set, pe.data(), pe.size(), 0), 1);
+    EXPECT_EQ(pe[0].m_data, &data);
+    EXPECT_NE(pe[0].m_revents & IArchNetwork::kPOLLIN, 0);
+
+    networkBSD.closePollSet(set);
+    close(fds[0]);
+}
+
+#endif // HAVE_SYS_EPOLL_H
+
 #endif // #ifdnef _WIN32
@@ -0,0 +1,81 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventBatch.h"
+
+#include "test/global/gtest.h"
+
+#include <vector>
+
+namespace {
+
+class TestMember : public EventBatch::IMember {
+public:
+    TestMember(int id, std::vector<int>& closed) : m_id(id), m_closed(closed) { }
+    ~TestMember() { EventBatch::leave(this); }
+
+    void batchClosed() override { m_closed.push_back(m_id); }
+
+private:
+    int m_id;
+    std::vector<int>& m_closed;
+};
+
+} // namespace
+
+TEST(EventBatchTests, join_noBatch_returnsFalse)
+{
+    std::vector<int> closed;
+    TestMember member(1, closed);
+
+    EXPECT_FALSE(EventBatch::isOpen());
+    EXPECT_FALSE(EventBatch::join(&member));
+}
+
+TEST(EventBatchTests, close_outermost_notifiesMembersOnceInOrder)
+{
+    std::vector<int> closed;
+    TestMember first(1, closed);
+    TestMember second(2, closed);
+    {
+        EventBatch outer;
+        EXPECT_TRUE(EventBatch::join(&first));
+        {
+            EventBatch inner;
+            EXPECT_TRUE(EventBatch::join(&second));
+            EXPECT_FALSE(EventBatch::join(&first));
+        }
+        EXPECT_TRUE(closed.empty());
+    }
+
+    ASSERT_EQ(2U, closed.size());
+    EXPECT_EQ(1, closed[0]);
+    EXPECT_EQ(2, closed[1]);
+}
+
+TEST(EventBatchTests, leave_memberIsNotNotified)
+{
+    std::vector<int> closed;
+    TestMember member(1, closed);
+    {
+        EventBatch batch;
+        EventBatch::join(&member);
+        EventBatch::leave(&member);
+    }
+
+    EXPECT_TRUE(closed.empty());
+}
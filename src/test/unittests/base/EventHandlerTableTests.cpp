@@ -0,0 +1,131 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventHandlerTable.h"
+#include "base/IEventJob.h"
+
+#include "test/global/gtest.h"
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace {
+
+class TestJob : public IEventJob {
+public:
+    void run(const Event&) override { }
+};
+
+char targets[64];
+
+} // namespace
+
+TEST(EventHandlerTableTests, find_added_returnsJob)
+{
+    EventHandlerTable table;
+    TestJob a, b;
+    EXPECT_EQ(table.add(1, &targets[0], &a), nullptr);
+    EXPECT_EQ(table.add(2, &targets[0], &b), nullptr);
+
+    EXPECT_EQ(table.find(1, &targets[0]), &a);
+    EXPECT_EQ(table.find(2, &targets[0]), &b);
+    EXPECT_EQ(table.find(1, &targets[1]), nullptr);
+    EXPECT_EQ(table.find(3, &targets[0]), nullptr);
+}
+
+TEST(EventHandlerTableTests, add_existing_returnsReplaced)
+{
+    EventHandlerTable table;
+    TestJob a, b;
+    table.add(1, NULL, &a);
+    EXPECT_EQ(table.add(1, NULL, &b), &a);
+    EXPECT_EQ(table.find(1, NULL), &b);
+}
+
+TEST(EventHandlerTableTests, removeAll_target_removesOnlyItsJobs)
+{
+    EventHandlerTable table;
+    TestJob a, b, c;
+    table.add(1, &targets[0], &a);
+    table.add(2, &targets[0], &b);
+    table.add(1, &targets[1], &c);
+
+    std::vector<IEventJob*> jobs;
+    table.removeAll(&targets[0], jobs);
+    EXPECT_EQ(jobs.size(), 2U);
+    EXPECT_EQ(table.find(1, &targets[0]), nullptr);
+    EXPECT_EQ(table.find(2, &targets[0]), nullptr);
+    EXPECT_EQ(table.find(1, &targets[1]), &c);
+}
+
+TEST(EventHandlerTableTests, addRemove_many_matchesMap)
+{
+    // enough entries to grow the table and make removal shift others
+    EventHandlerTable table;
+    std::map<std::pair<Event::Type, void*>, IEventJob*> expected;
+    std::vector<TestJob> jobs(64 * 16);
+    size_t next = 0;
+    for (Event::Type type = 0; type < 16; ++type) {
+        for (char& target : targets) {
+            table.add(type, &target, &jobs[next]);
+            expected[std::make_pair(type, static_cast<void*>(&target))] = &jobs[next];
+            ++next;
+        }
+    }
+    for (Event::Type type = 0; type < 16; type += 3) {
+        for (size_t i = 0; i < 64; i += 2) {
+            auto key = std::make_pair(type, static_cast<void*>(&targets[i]));
+            EXPECT_EQ(table.remove(type, &targets[i]), expected[key]);
+            expected.erase(key);
+        }
+    }
+
+    for (Event::Type type = 0; type < 16; ++type) {
+        for (char& target : targets) {
+            auto i = expected.find(std::make_pair(type, static_cast<void*>(&target)));
+            EXPECT_EQ(table.find(type, &target), i == expected.end() ? nullptr : i->second);
+        }
+    }
+}
+
+TEST(EventHandlerTableTests, find_whileChanging_findsUnchangedJobs)
+{
+    EventHandlerTable table;
+    TestJob stable, other;
+    table.add(1, &targets[0], &stable);
+
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        // grows the table and shifts entries about
+        for (int round = 0; round < 50; ++round) {
+            for (Event::Type type = 2; type < 400; ++type) {
+                table.add(type, &targets[type % 64], &other);
+            }
+            for (Event::Type type = 2; type < 400; ++type) {
+                table.remove(type, &targets[type % 64]);
+            }
+        }
+        done = true;
+    });
+
+    while (!done) {
+        ASSERT_EQ(table.find(1, &targets[0]), &stable);
+    }
+    writer.join();
+}
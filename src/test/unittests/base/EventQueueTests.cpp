@@ -0,0 +1,110 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventQueue.h"
+#include "base/SimpleEventQueueBuffer.h"
+
+#include "test/global/AllocationCounter.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+// counts the timer objects made and destroyed for the event queue
+class CountingEventQueueBuffer : public SimpleEventQueueBuffer {
+public:
+    CountingEventQueueBuffer(int* newTimers, int* deletedTimers) :
+        m_newTimers(newTimers),
+        m_deletedTimers(deletedTimers)
+    {
+    }
+
+    EventQueueTimer*    newTimer(double duration, bool oneShot) const override
+    {
+        ++*m_newTimers;
+        return SimpleEventQueueBuffer::newTimer(duration, oneShot);
+    }
+
+    void                deleteTimer(EventQueueTimer* timer) const override
+    {
+        ++*m_deletedTimers;
+        SimpleEventQueueBuffer::deleteTimer(timer);
+    }
+
+private:
+    int*                m_newTimers;
+    int*                m_deletedTimers;
+};
+
+} // namespace
+
+TEST(EventQueueTests, rearmTimer_perMessage_keepsTimer)
+{
+    // a heartbeat alarm that's reset for every message, next to the
+    // periodic keep alive timer, like ClientProxy1_3 has
+    int newTimers     = 0;
+    int deletedTimers = 0;
+    EventQueue events;
+    events.adoptBuffer(new CountingEventQueueBuffer(&newTimers, &deletedTimers));
+    EventQueueTimer* alarm     = events.newOneShotTimer(15.0, NULL);
+    EventQueueTimer* keepAlive = events.newTimer(3.0, NULL);
+
+    for (int i = 0; i < 1000; ++i) {
+        events.rearmTimer(alarm, 15.0);
+    }
+    EXPECT_EQ(newTimers, 2);
+    EXPECT_EQ(deletedTimers, 0);
+
+    events.deleteTimer(keepAlive);
+    events.deleteTimer(alarm);
+}
+
+TEST(EventQueueTests, rearmTimer_perMessage_allocatesNothing)
+{
+    EventQueue events;
+    EventQueueTimer* alarm     = events.newOneShotTimer(15.0, NULL);
+    EventQueueTimer* keepAlive = events.newTimer(3.0, NULL);
+    events.rearmTimer(alarm, 15.0);
+
+    AllocationCounter allocations;
+    for (int i = 0; i < 1000; ++i) {
+        events.rearmTimer(alarm, 15.0);
+    }
+    EXPECT_EQ(allocations.getCount(), 0);
+
+    events.deleteTimer(keepAlive);
+    events.deleteTimer(alarm);
+}
+
+TEST(EventQueueTests, rearmTimer_firedOneShot_firesAgain)
+{
+    EventQueue events;
+    EventQueueTimer* alarm = events.newOneShotTimer(0.01, NULL);
+
+    Event event;
+    ASSERT_TRUE(events.getEvent(event, 5.0));
+    EXPECT_EQ(event.getType(), Event::kTimer);
+
+    // a one-shot stays quiet until it's rearmed
+    EXPECT_FALSE(events.getEvent(event, 0.05));
+
+    events.rearmTimer(alarm, 0.01);
+    ASSERT_TRUE(events.getEvent(event, 5.0));
+    EXPECT_EQ(event.getType(), Event::kTimer);
+    EXPECT_EQ(static_cast<IEventQueue::TimerEvent*>(event.getData())->m_timer, alarm);
+
+    events.deleteTimer(alarm);
+}
@@ -0,0 +1,90 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/EventSlots.h"
+
+#include "test/global/gtest.h"
+
+#include <cstdlib>
+
+namespace {
+
+int target;
+
+Event
+makeEvent(Event::Type type)
+{
+    return Event(type, &target);
+}
+
+} // namespace
+
+TEST(EventSlotsTests, remove_added_returnsEvent)
+{
+    EventSlots slots;
+    UInt32 first  = slots.add(makeEvent(100));
+    UInt32 second = slots.add(makeEvent(101));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(slots.size(), 2U);
+
+    Event event;
+    EXPECT_TRUE(slots.remove(second, event));
+    EXPECT_EQ(event.getType(), 101U);
+    EXPECT_EQ(event.getTarget(), &target);
+    EXPECT_TRUE(slots.remove(first, event));
+    EXPECT_EQ(event.getType(), 100U);
+    EXPECT_EQ(slots.size(), 0U);
+}
+
+TEST(EventSlotsTests, remove_removedID_returnsFalse)
+{
+    EventSlots slots;
+    UInt32 id = slots.add(makeEvent(100));
+
+    Event event;
+    EXPECT_TRUE(slots.remove(id, event));
+    EXPECT_FALSE(slots.remove(id, event));
+    EXPECT_FALSE(slots.remove(EventSlots::kBadID, event));
+}
+
+TEST(EventSlotsTests, add_afterRemove_reusesSlotWithNewID)
+{
+    EventSlots slots;
+    UInt32 oldID = slots.add(makeEvent(100));
+    Event event;
+    slots.remove(oldID, event);
+
+    // the slot is reused but the old id doesn't find the new event
+    UInt32 newID = slots.add(makeEvent(101));
+    EXPECT_NE(newID, oldID);
+    EXPECT_FALSE(slots.remove(oldID, event));
+    EXPECT_TRUE(slots.remove(newID, event));
+    EXPECT_EQ(event.getType(), 101U);
+}
+
+TEST(EventSlotsTests, clear_events_removesAll)
+{
+    EventSlots slots;
+    UInt32 id = slots.add(makeEvent(100));
+    // data is freed, which leak checkers would notice if it weren't
+    slots.add(Event(101, &target, malloc(16)));
+    slots.clear();
+    EXPECT_EQ(slots.size(), 0U);
+
+    Event event;
+    EXPECT_FALSE(slots.remove(id, event));
+}
@@ -0,0 +1,159 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "base/TimerHeap.h"
+
+#include "test/global/gtest.h"
+
+namespace {
+
+// timers are opaque to the heap so any distinct pointers will do
+EventQueueTimer* const kTimerA = reinterpret_cast<EventQueueTimer*>(0x10);
+EventQueueTimer* const kTimerB = reinterpret_cast<EventQueueTimer*>(0x20);
+EventQueueTimer* const kTimerC = reinterpret_cast<EventQueueTimer*>(0x30);
+
+int targetA, targetB;
+
+} // namespace
+
+TEST(TimerHeapTests, popExpired_inDeadlineOrder)
+{
+    TimerHeap heap;
+    heap.add(kTimerA, &targetA, 2.0, true, 0.0);
+    heap.add(kTimerB, &targetB, 1.0, true, 0.0);
+    EXPECT_EQ(heap.getNextTimeout(0.0), 1.0);
+
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_FALSE(heap.popExpired(0.5, event, target));
+    EXPECT_TRUE(heap.popExpired(3.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerB);
+    EXPECT_EQ(target, &targetB);
+    EXPECT_TRUE(heap.popExpired(3.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerA);
+    EXPECT_FALSE(heap.popExpired(3.0, event, target));
+
+    // one-shots don't expire again but are kept until removed
+    EXPECT_EQ(heap.size(), 2U);
+    EXPECT_EQ(heap.getNextTimeout(3.0), -1.0);
+    EXPECT_TRUE(heap.remove(kTimerA));
+    EXPECT_EQ(heap.size(), 1U);
+}
+
+TEST(TimerHeapTests, popExpired_periodic_restartsAndCountsPeriods)
+{
+    TimerHeap heap;
+    heap.add(kTimerA, &targetA, 1.0, false, 0.0);
+
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_TRUE(heap.popExpired(2.5, event, target));
+    EXPECT_EQ(event.m_count, 2U);
+    EXPECT_EQ(heap.size(), 1U);
+    EXPECT_EQ(heap.getNextTimeout(2.5), 1.0);
+}
+
+TEST(TimerHeapTests, remove_timer_neverExpires)
+{
+    TimerHeap heap;
+    heap.add(kTimerA, &targetA, 1.0, true, 0.0);
+    heap.add(kTimerB, &targetB, 2.0, true, 0.0);
+    heap.add(kTimerC, &targetB, 3.0, true, 0.0);
+
+    // removing the next timer makes the one after it next
+    EXPECT_TRUE(heap.remove(kTimerA));
+    EXPECT_FALSE(heap.remove(kTimerA));
+    EXPECT_EQ(heap.getNextTimeout(0.0), 2.0);
+    EXPECT_TRUE(heap.remove(kTimerC));
+
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_TRUE(heap.popExpired(5.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerB);
+    EXPECT_FALSE(heap.popExpired(5.0, event, target));
+}
+
+TEST(TimerHeapTests, remove_manyReAdded_keepsOneTimer)
+{
+    // deleting and creating a timer over and over, like a heartbeat,
+    // mustn't leave the heap growing
+    TimerHeap heap;
+    heap.add(kTimerB, &targetB, 100.0, false, 0.0);
+    for (int i = 0; i < 1000; ++i) {
+        heap.add(kTimerA, &targetA, 10.0, true, i);
+        heap.remove(kTimerA);
+    }
+    heap.add(kTimerA, &targetA, 10.0, true, 1000.0);
+    EXPECT_EQ(heap.size(), 2U);
+    EXPECT_EQ(heap.getNextTimeout(1000.0), 0.0);
+
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_TRUE(heap.popExpired(1000.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerB);
+}
+
+TEST(TimerHeapTests, rearm_later_expiresAtNewDeadline)
+{
+    TimerHeap heap;
+    heap.add(kTimerA, &targetA, 1.0, true, 0.0);
+    heap.add(kTimerB, &targetB, 2.0, true, 0.0);
+    EXPECT_TRUE(heap.rearm(kTimerA, 2.0, 0.5));
+    EXPECT_EQ(heap.getNextTimeout(0.0), 2.0);
+
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_TRUE(heap.popExpired(2.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerB);
+    EXPECT_FALSE(heap.popExpired(2.0, event, target));
+    EXPECT_TRUE(heap.popExpired(2.5, event, target));
+    EXPECT_EQ(event.m_timer, kTimerA);
+    EXPECT_EQ(target, &targetA);
+}
+
+TEST(TimerHeapTests, rearm_earlier_expiresOnce)
+{
+    TimerHeap heap;
+    heap.add(kTimerA, &targetA, 10.0, false, 0.0);
+    EXPECT_TRUE(heap.rearm(kTimerA, 1.0, 0.0));
+    EXPECT_EQ(heap.getNextTimeout(0.0), 1.0);
+
+    // the entry for the old deadline doesn't expire the timer again
+    IEventQueue::TimerEvent event;
+    void* target;
+    EXPECT_TRUE(heap.popExpired(1.0, event, target));
+    EXPECT_EQ(event.m_count, 1U);
+    EXPECT_EQ(heap.getNextTimeout(1.0), 1.0);
+    EXPECT_TRUE(heap.popExpired(2.0, event, target));
+    EXPECT_EQ(event.m_count, 1U);
+}
+
+TEST(TimerHeapTests, rearm_expiredOneShot_expiresAgain)
+{
+    TimerHeap heap;
+    IEventQueue::TimerEvent event;
+    void* target;
+    heap.add(kTimerA, &targetA, 1.0, true, 0.0);
+    EXPECT_TRUE(heap.popExpired(1.0, event, target));
+    EXPECT_FALSE(heap.popExpired(5.0, event, target));
+
+    EXPECT_TRUE(heap.rearm(kTimerA, 1.0, 5.0));
+    EXPECT_FALSE(heap.rearm(kTimerB, 1.0, 5.0));
+    EXPECT_EQ(heap.getNextTimeout(5.0), 1.0);
+    EXPECT_TRUE(heap.popExpired(6.0, event, target));
+    EXPECT_EQ(event.m_timer, kTimerA);
+}
@@ -0,0 +1,119 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "io/StreamBuffer.h"
+
+#include "test/global/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+std::vector<UInt8>
+makeData(UInt32 size)
+{
+    std::vector<UInt8> data(size);
+    for (UInt32 i = 0; i < size; ++i) {
+        data[i] = static_cast<UInt8>(i * 7);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST(StreamBufferTests, peek_spanningChunks_returnsContiguousData)
+{
+    StreamBuffer buffer;
+    std::vector<UInt8> data = makeData(100000);
+    buffer.write(&data[0], 40000);
+    buffer.write(&data[40000], 60000);
+    buffer.pop(10);
+
+    const void* peeked = buffer.peek(90000);
+
+    EXPECT_EQ(0, memcmp(peeked, &data[10], 90000));
+    EXPECT_EQ(99990U, buffer.getSize());
+}
+
+TEST(StreamBufferTests, pop_afterPeek_keepsRemainingData)
+{
+    StreamBuffer buffer;
+    std::vector<UInt8> data = makeData(50000);
+    buffer.write(&data[0], 50000);
+
+    buffer.peek(30000);
+    buffer.pop(30000);
+
+    ASSERT_EQ(20000U, buffer.getSize());
+    EXPECT_EQ(0, memcmp(buffer.peek(20000), &data[30000], 20000));
+}
+
+TEST(StreamBufferTests, reserve_commit_appendsData)
+{
+    StreamBuffer buffer;
+    std::vector<UInt8> data = makeData(50000);
+    buffer.write(&data[0], 100);
+
+    StreamBuffer::Segment segments[8];
+    int n = buffer.reserve(49900, segments, 8);
+    UInt32 copied = 0;
+    for (int i = 0; i < n && copied < 49900; ++i) {
+        UInt32 count = std::min(segments[i].m_size, 49900 - copied);
+        memcpy(segments[i].m_data, &data[100 + copied], count);
+        copied += count;
+    }
+    ASSERT_EQ(49900U, copied);
+    buffer.commit(49900);
+
+    ASSERT_EQ(50000U, buffer.getSize());
+    EXPECT_EQ(0, memcmp(buffer.peek(50000), &data[0], 50000));
+}
+
+TEST(StreamBufferTests, getSegments_describesDataInOrder)
+{
+    StreamBuffer buffer;
+    std::vector<UInt8> data = makeData(50000);
+    buffer.write(&data[0], 50000);
+    buffer.pop(5);
+
+    StreamBuffer::Segment segments[8];
+    int n = buffer.getSegments(segments, 8);
+
+    std::vector<UInt8> joined;
+    for (int i = 0; i < n; ++i) {
+        joined.insert(joined.end(), segments[i].m_data,
+                        segments[i].m_data + segments[i].m_size);
+    }
+    ASSERT_EQ(49995U, joined.size());
+    EXPECT_EQ(0, memcmp(&joined[0], &data[5], 49995));
+}
+
+TEST(StreamBufferTests, pop_all_emptiesBuffer)
+{
+    StreamBuffer buffer;
+    std::vector<UInt8> data = makeData(50000);
+    buffer.write(&data[0], 50000);
+
+    buffer.pop(50000);
+    buffer.write(&data[0], 3);
+
+    StreamBuffer::Segment segments[8];
+    ASSERT_EQ(1, buffer.getSegments(segments, 8));
+    EXPECT_EQ(3U, segments[0].m_size);
+}
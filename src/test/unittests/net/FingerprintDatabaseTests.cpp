@@ -0,0 +1,104 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/FingerprintDatabase.h"
+
+#include "test/global/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+const char kFingerprint[] =
+    "0A:1B:2C:3D:4E:5F:60:71:82:93:A4:B5:C6:D7:E8:F9:"
+    "00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF";
+
+const char kOtherFingerprint[] =
+    "FF:EE:DD:CC:BB:AA:99:88:77:66:55:44:33:22:11:00:"
+    "F9:E8:D7:C6:B5:A4:93:82:71:60:5F:4E:3D:2C:1B:0A";
+
+const char kFilename[] = "FingerprintDatabaseTests.txt";
+
+void
+writeFile(const char* contents)
+{
+    std::ofstream file(kFilename, std::ios::trunc);
+    file << contents;
+}
+
+FingerprintDatabase::Digest
+digest(const char* text)
+{
+    FingerprintDatabase::Digest result;
+    EXPECT_TRUE(FingerprintDatabase::parse(text, result));
+    return result;
+}
+
+} // namespace
+
+TEST(FingerprintDatabaseTests, parse_withColons_parsesDigest)
+{
+    FingerprintDatabase::Digest result;
+
+    EXPECT_TRUE(FingerprintDatabase::parse(kFingerprint, result));
+    EXPECT_EQ(result[0], 0x0A);
+    EXPECT_EQ(result[1], 0x1B);
+    EXPECT_EQ(result[31], 0xFF);
+}
+
+TEST(FingerprintDatabaseTests, parse_lowerCaseWithoutColons_parsesDigest)
+{
+    FingerprintDatabase::Digest result;
+
+    EXPECT_TRUE(FingerprintDatabase::parse(
+        "0a1b2c3d4e5f60718293a4b5c6d7e8f900112233445566778899aabbccddeeff\r",
+        result));
+    EXPECT_TRUE(result == digest(kFingerprint));
+}
+
+TEST(FingerprintDatabaseTests, parse_notSha256_fails)
+{
+    FingerprintDatabase::Digest result;
+
+    // a sha-1 fingerprint
+    EXPECT_FALSE(FingerprintDatabase::parse(
+        "0A:1B:2C:3D:4E:5F:60:71:82:93:A4:B5:C6:D7:E8:F9:00:11:22:33", result));
+    EXPECT_FALSE(FingerprintDatabase::parse("", result));
+    EXPECT_FALSE(FingerprintDatabase::parse("not a fingerprint", result));
+}
+
+TEST(FingerprintDatabaseTests, isTrusted_fileChanges_reloads)
+{
+    writeFile((String(kFingerprint) + "\n").c_str());
+    FingerprintDatabase database(kFilename);
+
+    EXPECT_TRUE(database.isTrusted(digest(kFingerprint)));
+    EXPECT_FALSE(database.isTrusted(digest(kOtherFingerprint)));
+
+    writeFile((String(kFingerprint) + "\n" + kOtherFingerprint + "\n").c_str());
+
+    EXPECT_TRUE(database.isTrusted(digest(kOtherFingerprint)));
+
+    writeFile("");
+
+    EXPECT_FALSE(database.isTrusted(digest(kFingerprint)));
+
+    std::remove(kFilename);
+
+    EXPECT_FALSE(database.isTrusted(digest(kOtherFingerprint)));
+}
@@ -0,0 +1,117 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "net/HostResolver.h"
+#include "net/NetworkAddress.h"
+#include "net/XSocket.h"
+#include "base/TMethodEventJob.h"
+#include "arch/Arch.h"
+#include "test/global/TestEventQueue.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+class HostResolverTests : public ::testing::Test {
+protected:
+    void TearDown() override
+    {
+        if (m_resolver != nullptr) {
+            m_events.removeHandler(m_events.forHostResolver().resolved(),
+                                m_resolver->getEventTarget());
+            delete m_resolver;
+        }
+    }
+
+    void createResolver(double ttl, double negativeTtl)
+    {
+        m_resolver = new HostResolver(&m_events, ttl, negativeTtl);
+        m_events.adoptHandler(m_events.forHostResolver().resolved(),
+                            m_resolver->getEventTarget(),
+                            new TMethodEventJob<HostResolverTests>(this,
+                                &HostResolverTests::handleResolved));
+    }
+
+    // runs the event loop until the resolver finishes a lookup
+    void waitForResolved()
+    {
+        m_events.initQuitTimeout(5);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+    }
+
+    void handleResolved(const Event&, void*)
+    {
+        ++m_resolved;
+        m_events.raiseQuitEvent();
+    }
+
+    TestEventQueue m_events;
+    HostResolver* m_resolver = nullptr;
+    int m_resolved = 0;
+};
+
+} // namespace
+
+TEST_F(HostResolverTests, resolve_notCached_resolvesInBackground)
+{
+    createResolver(300.0, 5.0);
+    NetworkAddress address("127.0.0.1", 24800);
+
+    EXPECT_EQ(m_resolver->resolve(address), 0);
+    EXPECT_FALSE(address.isValid());
+
+    waitForResolved();
+    ASSERT_EQ(m_resolved, 1);
+    EXPECT_EQ(m_resolver->resolve(address), 1);
+    ASSERT_TRUE(address.isValid());
+    EXPECT_EQ(ARCH->addrToString(address.getAddress()), "127.0.0.1");
+    EXPECT_EQ(ARCH->getAddrPort(address.getAddress()), 24800);
+}
+
+TEST_F(HostResolverTests, resolve_expired_usesLastKnownAddressWhileRefreshing)
+{
+    createResolver(0.0, 0.0);
+    NetworkAddress address("127.0.0.1", 24800);
+    m_resolver->resolve(address);
+    waitForResolved();
+
+    // the entry expired immediately but is still used
+    EXPECT_EQ(m_resolver->resolve(address), 1);
+    EXPECT_TRUE(address.isValid());
+    waitForResolved();
+    EXPECT_EQ(m_resolved, 2);
+}
+
+TEST_F(HostResolverTests, resolve_failedLookup_throwsUntilNegativeTtlExpires)
+{
+    createResolver(300.0, 300.0);
+    NetworkAddress address("synergy-test.invalid", 24800);
+    m_resolver->resolve(address);
+    waitForResolved();
+    ASSERT_EQ(m_resolved, 1);
+
+    EXPECT_THROW(m_resolver->resolve(address), XSocketAddress);
+}
+
+TEST_F(HostResolverTests, resolve_wildcard_resolvesImmediately)
+{
+    createResolver(300.0, 5.0);
+    NetworkAddress address("", 24800);
+
+    EXPECT_EQ(m_resolver->resolve(address), 1);
+    EXPECT_TRUE(address.isValid());
+}
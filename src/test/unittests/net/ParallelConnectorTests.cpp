@@ -0,0 +1,163 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "net/ParallelConnector.h"
+#include "net/IDataSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/TCPSocketFactory.h"
+#include "base/TMethodEventJob.h"
+#include "arch/Arch.h"
+#include "test/global/TestEventQueue.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+class ParallelConnectorTests : public ::testing::Test {
+protected:
+    void TearDown() override
+    {
+        for (int fd : m_fds) {
+            close(fd);
+        }
+    }
+
+    // returns the port of a new loopback listener.  a blackholed
+    // listener has a full accept queue so its connections never finish.
+    int listener(bool blackhole)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        EXPECT_EQ(::bind(fd, reinterpret_cast<sockaddr*>(&addr), size), 0);
+        EXPECT_EQ(getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size), 0);
+        EXPECT_EQ(listen(fd, 0), 0);
+        m_fds.push_back(fd);
+
+        if (blackhole) {
+            int filler = socket(AF_INET, SOCK_STREAM, 0);
+            EXPECT_EQ(::connect(filler, reinterpret_cast<sockaddr*>(&addr), size), 0);
+            m_fds.push_back(filler);
+        }
+        return ntohs(addr.sin_port);
+    }
+
+    // returns a loopback port with nothing listening on it
+    int closedPort()
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        EXPECT_EQ(::bind(fd, reinterpret_cast<sockaddr*>(&addr), size), 0);
+        EXPECT_EQ(getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size), 0);
+        close(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    NetworkAddress address(int port)
+    {
+        NetworkAddress result("127.0.0.1", port);
+        result.resolve();
+        return result;
+    }
+
+    // connects to addresses and runs the event loop until the connector
+    // is done
+    void connect(ParallelConnector& connector,
+                const std::vector<NetworkAddress>& addresses)
+    {
+        m_events.adoptHandler(Event::kUnknown, connector.getEventTarget(),
+                            new TMethodEventJob<ParallelConnectorTests>(this,
+                                &ParallelConnectorTests::handleEvent));
+        connector.connect(addresses);
+        m_events.initQuitTimeout(5);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+        m_events.removeHandler(Event::kUnknown, connector.getEventTarget());
+    }
+
+    void handleEvent(const Event& event, void*)
+    {
+        m_type = event.getType();
+        if (m_type == m_events.forIDataSocket().connectionFailed()) {
+            delete static_cast<IDataSocket::ConnectionFailedInfo*>(event.getData());
+        }
+        m_events.raiseQuitEvent();
+    }
+
+    TestEventQueue m_events;
+    SocketMultiplexer m_multiplexer;
+    TCPSocketFactory m_factory { &m_events, &m_multiplexer };
+    std::vector<int> m_fds;
+    Event::Type m_type = Event::kUnknown;
+};
+
+} // namespace
+
+TEST_F(ParallelConnectorTests, connect_firstAddressBlackholed_connectsToNext)
+{
+    int blackhole = listener(true);
+    int good      = listener(false);
+    ParallelConnector connector(&m_events, &m_factory, false, 0.1);
+
+    double start = ARCH->time();
+    connect(connector, { address(blackhole), address(good) });
+
+    EXPECT_EQ(m_type, m_events.forIDataSocket().connected());
+    EXPECT_LT(ARCH->time() - start, 1.0);
+    EXPECT_EQ(connector.getAddress().getPort(), good);
+    IDataSocket* socket = connector.takeSocket();
+    EXPECT_NE(socket, nullptr);
+    EXPECT_EQ(connector.takeSocket(), nullptr);
+    delete socket;
+}
+
+TEST_F(ParallelConnectorTests, connect_firstAddressAnswers_keepsFirst)
+{
+    int first  = listener(false);
+    int second = listener(false);
+    ParallelConnector connector(&m_events, &m_factory, false, 0.5);
+
+    connect(connector, { address(first), address(second) });
+
+    EXPECT_EQ(m_type, m_events.forIDataSocket().connected());
+    EXPECT_EQ(connector.getAddress().getPort(), first);
+    delete connector.takeSocket();
+}
+
+TEST_F(ParallelConnectorTests, connect_allRefused_failsWithoutWaitingForDelay)
+{
+    ParallelConnector connector(&m_events, &m_factory, false, 10.0);
+
+    double start = ARCH->time();
+    connect(connector, { address(closedPort()), address(closedPort()) });
+
+    EXPECT_EQ(m_type, m_events.forIDataSocket().connectionFailed());
+    EXPECT_LT(ARCH->time() - start, 2.0);
+    EXPECT_EQ(connector.takeSocket(), nullptr);
+}
+
+#endif // _WIN32
@@ -0,0 +1,515 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include "net/SecureSocket.h"
+#include "net/TCPSocketFactory.h"
+#include "net/IListenSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "net/NetworkAddress.h"
+#include "synergy/ArgParser.h"
+#include "synergy/ArgsBase.h"
+#include "base/TMethodEventJob.h"
+#include "arch/Arch.h"
+#include "test/global/TestEventQueue.h"
+#include "test/global/gtest.h"
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// a port nothing is listening on
+int
+getFreePort()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+    ::bind(fd, reinterpret_cast<sockaddr*>(&addr), size);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size);
+    close(fd);
+    return ntohs(addr.sin_port);
+}
+
+// writes a self signed certificate and trusts it, like the gui does on
+// first run.  it's made once since the server context for a certificate
+// file is cached.
+const String&
+getProfileDirectory()
+{
+    static String s_directory;
+    if (!s_directory.empty()) {
+        return s_directory;
+    }
+
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "SecureSocketTests";
+    std::filesystem::create_directories(directory / "SSL" / "Fingerprints");
+
+    EVP_PKEY* key = NULL;
+    EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+    EVP_PKEY_keygen_init(context);
+    EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048);
+    EVP_PKEY_keygen(context, &key);
+    EVP_PKEY_CTX_free(context);
+
+    X509* cert = X509_new();
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 60 * 60);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char*>("Synergy"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+
+    FILE* file = fopen((directory / "SSL" / "Synergy.pem").c_str(), "w");
+    PEM_write_PrivateKey(file, key, NULL, NULL, 0, NULL, NULL);
+    PEM_write_X509(file, cert);
+    fclose(file);
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int size = 0;
+    X509_digest(cert, EVP_sha256(), digest, &size);
+    std::ofstream trusted(directory / "SSL" / "Fingerprints" / "TrustedServers.txt");
+    for (unsigned int i = 0; i < size; ++i) {
+        char hex[4];
+        snprintf(hex, sizeof(hex), (i == 0) ? "%02X" : ":%02X", digest[i]);
+        trusted << hex;
+    }
+    trusted << "\n";
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+
+    s_directory = directory.string();
+    return s_directory;
+}
+
+// a tls server on a blocking socket that only reads once it's resumed,
+// so a client's writes back up until then.  it reads \c expected bytes
+// and counts the application data records they came in.
+class PausedTlsServer {
+public:
+    explicit PausedTlsServer(size_t expected)
+    {
+        m_listen = socket(AF_INET, SOCK_STREAM, 0);
+
+        // accepted sockets get a small receive window
+        int size = 4096;
+        setsockopt(m_listen, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+        sockaddr_in addr = {};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addrSize = sizeof(addr);
+        ::bind(m_listen, reinterpret_cast<sockaddr*>(&addr), addrSize);
+        listen(m_listen, 1);
+        getsockname(m_listen, reinterpret_cast<sockaddr*>(&addr), &addrSize);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread([this, expected] { run(expected); });
+    }
+
+    ~PausedTlsServer()
+    {
+        resume();
+        m_thread.join();
+        close(m_listen);
+    }
+
+    void resume() { m_resumed = true; }
+
+    int getPort() const { return m_port; }
+
+    // the rest are only valid once done
+    bool isDone() const { return m_done; }
+    const std::vector<UInt8>& getReceived() const { return m_received; }
+    size_t getRecords() const { return m_records; }
+    size_t getLargestRecord() const { return m_largestRecord; }
+
+private:
+    void run(size_t expected)
+    {
+        // give up if the client doesn't connect or stops sending
+        pollfd listen = { m_listen, POLLIN, 0 };
+        int fd = (poll(&listen, 1, 10000) == 1) ? accept(m_listen, NULL, NULL) : -1;
+        if (fd < 0) {
+            m_done = true;
+            return;
+        }
+        timeval timeout = { 10, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        String certificate = getProfileDirectory() + "/SSL/Synergy.pem";
+        SSL_CTX* context = SSL_CTX_new(TLS_server_method());
+        SSL_CTX_use_certificate_file(context, certificate.c_str(), SSL_FILETYPE_PEM);
+        SSL_CTX_use_PrivateKey_file(context, certificate.c_str(), SSL_FILETYPE_PEM);
+        SSL* ssl = SSL_new(context);
+        SSL_set_fd(ssl, fd);
+        SSL_set_msg_callback(ssl, &PausedTlsServer::onMessage);
+        SSL_set_msg_callback_arg(ssl, this);
+
+        if (SSL_accept(ssl) == 1) {
+            while (!m_resumed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            UInt8 buffer[4096];
+            while (m_received.size() < expected) {
+                int n = SSL_read(ssl, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    break;
+                }
+                m_received.insert(m_received.end(), buffer, buffer + n);
+            }
+        }
+
+        SSL_free(ssl);
+        SSL_CTX_free(context);
+        close(fd);
+        m_done = true;
+    }
+
+    static void onMessage(int write, int, int type, const void* buffer,
+                            size_t size, SSL* ssl, void* arg)
+    {
+        // the header of each record read after the handshake
+        auto header = static_cast<const UInt8*>(buffer);
+        if (write || type != SSL3_RT_HEADER || size < 5 ||
+            header[0] != SSL3_RT_APPLICATION_DATA || !SSL_is_init_finished(ssl)) {
+            return;
+        }
+        auto self = static_cast<PausedTlsServer*>(arg);
+        size_t length = (static_cast<size_t>(header[3]) << 8) | header[4];
+        ++self->m_records;
+        self->m_largestRecord = std::max(self->m_largestRecord, length);
+    }
+
+    int m_listen = -1;
+    int m_port = 0;
+    std::thread m_thread;
+    std::atomic<bool> m_resumed { false };
+    std::atomic<bool> m_done { false };
+    std::vector<UInt8> m_received;
+    size_t m_records = 0;
+    size_t m_largestRecord = 0;
+};
+
+class SecureSocketTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_profileDirectory = ARCH->getProfileDirectory();
+        ARCH->setProfileDirectory(getProfileDirectory());
+        m_parser.setArgsBase(m_args);
+
+        setData(64 * 1024);
+    }
+
+    // sets the data the client writes once it's connected
+    void setData(size_t size)
+    {
+        m_data.resize(size);
+        for (size_t i = 0; i < m_data.size(); ++i) {
+            m_data[i] = static_cast<UInt8>(i * 7 + (i >> 11));
+        }
+    }
+
+    void TearDown() override
+    {
+        if (m_client != NULL) {
+            m_events.removeHandler(Event::kUnknown, m_client->getEventTarget());
+        }
+        if (m_server != NULL) {
+            m_events.removeHandler(Event::kUnknown, m_server->getEventTarget());
+        }
+        if (m_listen != NULL) {
+            m_events.removeHandler(Event::kUnknown, m_listen->getEventTarget());
+        }
+        delete m_client;
+        delete m_server;
+        delete m_listen;
+        ARCH->setProfileDirectory(m_profileDirectory);
+    }
+
+    // connects a secure client to a secure server made by \c factory
+    // and runs the event loop until the server has echoed m_data
+    void echo(const TCPSocketFactory& factory)
+    {
+        m_listen = factory.createListen(true);
+        m_address = NetworkAddress("127.0.0.1", getFreePort());
+        m_address.resolve();
+        m_listen->bind(m_address);
+        m_events.adoptHandler(Event::kUnknown, m_listen->getEventTarget(),
+                            new TMethodEventJob<SecureSocketTests>(this,
+                                &SecureSocketTests::handleListenEvent));
+
+        echoAgain(factory);
+    }
+
+    // connects a new secure client to the server of the last \c echo()
+    // and runs the event loop until the server has echoed m_data
+    void echoAgain(const TCPSocketFactory& factory)
+    {
+        if (m_client != NULL) {
+            m_events.removeHandler(Event::kUnknown, m_client->getEventTarget());
+            delete m_client;
+        }
+        if (m_server != NULL) {
+            m_events.removeHandler(Event::kUnknown, m_server->getEventTarget());
+            delete m_server;
+            m_server = NULL;
+        }
+        m_echoed.clear();
+
+        m_client = factory.create(true);
+        m_events.adoptHandler(Event::kUnknown, m_client->getEventTarget(),
+                            new TMethodEventJob<SecureSocketTests>(this,
+                                &SecureSocketTests::handleClientEvent));
+        m_client->connect(m_address);
+
+        m_events.initQuitTimeout(10);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+    }
+
+    // connects a secure client made by \c factory to \c server, which
+    // isn't a socket of ours
+    void connect(const TCPSocketFactory& factory, const PausedTlsServer& server)
+    {
+        NetworkAddress address("127.0.0.1", server.getPort());
+        address.resolve();
+        m_client = factory.create(true);
+        m_events.adoptHandler(Event::kUnknown, m_client->getEventTarget(),
+                            new TMethodEventJob<SecureSocketTests>(this,
+                                &SecureSocketTests::handleClientEvent));
+        m_client->connect(address);
+    }
+
+    // runs the event loop until \c done returns true
+    void runUntil(const std::function<bool()>& done)
+    {
+        m_runUntil = done;
+        EventQueueTimer* timer = m_events.newTimer(0.01, NULL);
+        m_events.adoptHandler(Event::kTimer, timer,
+                            new TMethodEventJob<SecureSocketTests>(this,
+                                &SecureSocketTests::handleRunUntilTimer));
+        m_events.initQuitTimeout(20);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+        m_events.removeHandler(Event::kTimer, timer);
+        m_events.deleteTimer(timer);
+    }
+
+    void handleRunUntilTimer(const Event&, void*)
+    {
+        if (m_runUntil()) {
+            m_events.raiseQuitEvent();
+        }
+    }
+
+    void handleListenEvent(const Event& event, void*)
+    {
+        if (event.getType() != m_events.forIListenSocket().connecting()) {
+            return;
+        }
+
+        // the listen socket waits for the next connection once accept
+        // runs out of them
+        IDataSocket* socket;
+        while ((socket = m_listen->accept()) != NULL) {
+            if (m_server != NULL) {
+                delete socket;
+                continue;
+            }
+            m_server = socket;
+            m_events.adoptHandler(Event::kUnknown, m_server->getEventTarget(),
+                                new TMethodEventJob<SecureSocketTests>(this,
+                                    &SecureSocketTests::handleServerEvent));
+        }
+    }
+
+    void handleServerEvent(const Event& event, void*)
+    {
+        if (event.getType() == m_events.forIStream().inputReady()) {
+            UInt8 buffer[4096];
+            UInt32 n;
+            while ((n = m_server->read(buffer, sizeof(buffer))) > 0) {
+                m_server->write(buffer, n);
+            }
+        }
+    }
+
+    void handleClientEvent(const Event& event, void*)
+    {
+        if (event.getType() == m_events.forIDataSocket().secureConnected()) {
+            m_connected = true;
+            m_client->write(m_data.data(), static_cast<UInt32>(m_data.size()));
+        }
+        else if (event.getType() == m_events.forIStream().inputReady()) {
+            UInt8 buffer[4096];
+            UInt32 n;
+            while ((n = m_client->read(buffer, sizeof(buffer))) > 0) {
+                m_echoed.insert(m_echoed.end(), buffer, buffer + n);
+            }
+            if (m_echoed.size() >= m_data.size()) {
+                m_events.raiseQuitEvent();
+            }
+        }
+    }
+
+    TestEventQueue m_events;
+    SocketMultiplexer m_multiplexer;
+    SocketMultiplexer m_handshakeMultiplexer { SecureSocket::kHandshakeThreads };
+    lib::synergy::ArgsBase m_args;
+    ArgParser m_parser { NULL };
+    String m_profileDirectory;
+    NetworkAddress m_address;
+    IListenSocket* m_listen = NULL;
+    IDataSocket* m_server = NULL;
+    IDataSocket* m_client = NULL;
+    std::vector<UInt8> m_data;
+    std::vector<UInt8> m_echoed;
+    bool m_connected = false;
+    std::function<bool()> m_runUntil;
+};
+
+} // namespace
+
+TEST_F(SecureSocketTests, echo_handshakeOnSocketMultiplexer_echoesData)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer);
+
+    echo(factory);
+
+    EXPECT_TRUE(m_echoed == m_data);
+}
+
+TEST_F(SecureSocketTests, echo_handshakeMultiplexer_handsSocketsBack)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer, &m_handshakeMultiplexer);
+
+    echo(factory);
+
+    // the data went over the socket multiplexer so the handshake jobs
+    // are done.  they drop their sockets after handing them back.
+    EXPECT_TRUE(m_echoed == m_data);
+    for (int i = 0; i < 100 && m_handshakeMultiplexer.getAssignedSockets() > 0; ++i) {
+        ARCH->sleep(0.01);
+    }
+    EXPECT_EQ(m_handshakeMultiplexer.getAssignedSockets(), 0);
+}
+
+TEST_F(SecureSocketTests, echo_kernelTlsOff_opensslEncrypts)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer, NULL, false);
+
+    echo(factory);
+
+    EXPECT_TRUE(m_echoed == m_data);
+    EXPECT_FALSE(dynamic_cast<SecureSocket*>(m_client)->isKernelTls());
+    EXPECT_FALSE(dynamic_cast<SecureSocket*>(m_server)->isKernelTls());
+}
+
+TEST_F(SecureSocketTests, echo_kernelTlsOn_echoesData)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer, NULL, true);
+
+    echo(factory);
+
+    // where the kernel and openssl support it the writes skip openssl,
+    // otherwise the sockets quietly fall back to it.  either way the
+    // data must arrive intact.
+    EXPECT_TRUE(m_echoed == m_data);
+}
+
+TEST_F(SecureSocketTests, echo_reconnect_resumesSession)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer);
+
+    echo(factory);
+    EXPECT_TRUE(m_echoed == m_data);
+
+    // both ends keep their contexts, and the client its session
+    echoAgain(factory);
+
+    EXPECT_TRUE(m_echoed == m_data);
+    EXPECT_TRUE(dynamic_cast<SecureSocket*>(m_client)->isSessionResumed());
+    EXPECT_TRUE(dynamic_cast<SecureSocket*>(m_server)->isSessionResumed());
+}
+
+TEST_F(SecureSocketTests, write_largerThanRecord_splitAcrossRecords)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer);
+    setData(100000);
+    PausedTlsServer server(m_data.size());
+    server.resume();
+
+    connect(factory, server);
+    runUntil([&server] { return server.isDone(); });
+
+    // openssl limits records to 16KB of data plus its overhead
+    EXPECT_TRUE(server.getReceived() == m_data);
+    EXPECT_GE(server.getRecords(), (m_data.size() + 16383) / 16384);
+    EXPECT_LE(server.getLargestRecord(), 16384U + 256U);
+}
+
+TEST_F(SecureSocketTests, write_peerNotReading_retriedUntilSent)
+{
+    TCPSocketFactory factory(&m_events, &m_multiplexer);
+
+    // more than the socket buffers hold so the write has to be retried
+    setData(16 * 1024 * 1024);
+    PausedTlsServer server(m_data.size());
+
+    connect(factory, server);
+    int ticks = 0;
+    runUntil([this, &ticks] { return m_connected && ++ticks >= 50; });
+    EXPECT_TRUE(m_client->hasPendingOutput());
+
+    server.resume();
+    runUntil([&server] { return server.isDone(); });
+
+    EXPECT_TRUE(server.getReceived() == m_data);
+    EXPECT_FALSE(m_client->hasPendingOutput());
+}
+
+#endif // _WIN32
@@ -0,0 +1,252 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include "net/SocketMultiplexer.h"
+#include "net/ISocketMultiplexerJob.h"
+#include "arch/Arch.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+class TestSocketJob : public ISocketMultiplexerJob {
+public:
+    TestSocketJob(ArchSocket socket, bool readable, bool once,
+                  std::atomic<int>& runs, double duration = 0.0) :
+        m_socket(ARCH->copySocket(socket)),
+        m_readable(readable),
+        m_once(once),
+        m_runs(runs),
+        m_duration(duration) { }
+    ~TestSocketJob() { ARCH->closeSocket(m_socket); }
+
+    ISocketMultiplexerJob* run(bool readable, bool, bool) override
+    {
+        if (readable) {
+            // consume the data so the socket isn't readable again
+            char buffer[16];
+            ARCH->readSocket(m_socket, buffer, sizeof(buffer));
+            ++m_runs;
+            if (m_duration > 0.0) {
+                ARCH->sleep(m_duration);
+                ++m_runs;
+            }
+        }
+        return m_once ? nullptr : this;
+    }
+    ArchSocket getSocket() const override { return m_socket; }
+    bool isReadable() const override { return m_readable; }
+    bool isWritable() const override { return false; }
+
+private:
+    ArchSocket m_socket;
+    bool m_readable;
+    bool m_once;
+    std::atomic<int>& m_runs;
+    double m_duration;
+};
+
+class SocketMultiplexerTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        m_socket = new ArchSocketImpl { fds[0], 1 };
+        m_peer = fds[1];
+    }
+
+    void TearDown() override
+    {
+        ARCH->closeSocket(m_socket);
+        close(m_peer);
+    }
+
+    void send() { ASSERT_EQ(write(m_peer, "x", 1), 1); }
+
+    bool waitForRuns(int expected)
+    {
+        for (int i = 0; i < 500 && m_runs < expected; ++i) {
+            ARCH->sleep(0.01);
+        }
+        return m_runs == expected;
+    }
+
+    // key used for the socket, never dereferenced by the multiplexer
+    ISocket* key() { return reinterpret_cast<ISocket*>(this); }
+
+    ArchSocket m_socket = nullptr;
+    int m_peer = -1;
+    std::atomic<int> m_runs { 0 };
+};
+
+} // namespace
+
+TEST_F(SocketMultiplexerTests, addSocket_runsJobWhenReadable)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+
+    send();
+    EXPECT_TRUE(waitForRuns(1));
+    send();
+    EXPECT_TRUE(waitForRuns(2));
+
+    multiplexer.removeSocket(key());
+}
+
+TEST_F(SocketMultiplexerTests, addSocket_replacedJobChangesInterest)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, false, false, m_runs));
+    send();
+    ARCH->sleep(0.1);
+    EXPECT_EQ(m_runs, 0);
+
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+    EXPECT_TRUE(waitForRuns(1));
+
+    multiplexer.removeSocket(key());
+}
+
+TEST_F(SocketMultiplexerTests, removeSocket_jobIsNotRun)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+    multiplexer.removeSocket(key());
+
+    send();
+    ARCH->sleep(0.1);
+    EXPECT_EQ(m_runs, 0);
+}
+
+TEST_F(SocketMultiplexerTests, run_returningNullRemovesJob)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, true, m_runs));
+
+    send();
+    EXPECT_TRUE(waitForRuns(1));
+    send();
+    ARCH->sleep(0.1);
+    EXPECT_EQ(m_runs, 1);
+
+    // the socket can be added again after its job removed itself
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, true, m_runs));
+    EXPECT_TRUE(waitForRuns(2));
+}
+
+TEST_F(SocketMultiplexerTests, addSocket_manyChangesAtOnce_lastJobRuns)
+{
+    // queue more changes than the reactor has pooled nodes for
+    SocketMultiplexer multiplexer;
+    for (int i = 0; i < 300; ++i) {
+        multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+        multiplexer.removeSocket(key());
+    }
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+
+    send();
+    EXPECT_TRUE(waitForRuns(1));
+
+    multiplexer.removeSocket(key());
+}
+
+TEST_F(SocketMultiplexerTests, run_returningNullReleasesAssignment)
+{
+    SocketMultiplexer multiplexer(2);
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, true, m_runs));
+    EXPECT_EQ(multiplexer.getAssignedSockets(), 1U);
+
+    send();
+    ASSERT_TRUE(waitForRuns(1));
+    for (int i = 0; i < 500 && multiplexer.getAssignedSockets() != 0; ++i) {
+        ARCH->sleep(0.01);
+    }
+    EXPECT_EQ(multiplexer.getAssignedSockets(), 0U);
+
+    // and it's assigned again when it gets a new job
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+    EXPECT_EQ(multiplexer.getAssignedSockets(), 1U);
+    send();
+    EXPECT_TRUE(waitForRuns(2));
+    multiplexer.removeSocket(key());
+    EXPECT_EQ(multiplexer.getAssignedSockets(), 0U);
+}
+
+TEST_F(SocketMultiplexerTests, removeSocket_waitsForRunningJob)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs, 0.2));
+
+    // the job counts once on entry and once when it's done
+    send();
+    ASSERT_TRUE(waitForRuns(1));
+    multiplexer.removeSocket(key());
+    EXPECT_EQ(m_runs, 2);
+}
+
+TEST_F(SocketMultiplexerTests, addSocket_doesNotWaitForRunningJob)
+{
+    SocketMultiplexer multiplexer;
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs, 0.5));
+
+    send();
+    ASSERT_TRUE(waitForRuns(1));
+    double start = ARCH->time();
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs));
+    EXPECT_LT(ARCH->time() - start, 0.25);
+
+    multiplexer.removeSocket(key());
+    EXPECT_EQ(m_runs, 2);
+}
+
+TEST_F(SocketMultiplexerTests, addSocket_slowJobDoesNotDelayOtherThreads)
+{
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ArchSocket other = new ArchSocketImpl { fds[0], 1 };
+    ISocket* otherKey = reinterpret_cast<ISocket*>(&other);
+    std::atomic<int> otherRuns { 0 };
+
+    // the least loaded assignment puts the sockets on different threads
+    SocketMultiplexer multiplexer(2);
+    EXPECT_EQ(multiplexer.getThreads(), 2);
+    multiplexer.addSocket(key(), new TestSocketJob(m_socket, true, false, m_runs, 0.5));
+    multiplexer.addSocket(otherKey, new TestSocketJob(other, true, false, otherRuns));
+
+    send();
+    ASSERT_TRUE(waitForRuns(1));
+    double start = ARCH->time();
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    while (otherRuns == 0 && ARCH->time() - start < 5.0) {
+        ARCH->sleep(0.01);
+    }
+    EXPECT_LT(ARCH->time() - start, 0.25);
+
+    multiplexer.removeSocket(otherKey);
+    multiplexer.removeSocket(key());
+    EXPECT_EQ(m_runs, 2);
+    ARCH->closeSocket(other);
+    close(fds[1]);
+}
+
+#endif // _WIN32
@@ -0,0 +1,184 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <vector>
+#include "net/TCPSocket.h"
+#include "net/SocketMultiplexer.h"
+#include "base/EventBatch.h"
+#include "base/TMethodEventJob.h"
+#include "arch/Arch.h"
+#include "arch/unix/ArchNetworkBSD.h"
+#include "test/global/TestEventQueue.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+class TCPSocketTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        // TCP_NODELAY needs a real TCP connection
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(listener, 0);
+        sockaddr_in addr = {};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&addr), size), 0);
+        ASSERT_EQ(getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &size), 0);
+        ASSERT_EQ(listen(listener, 1), 0);
+        m_peer = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(::connect(m_peer, reinterpret_cast<sockaddr*>(&addr), size), 0);
+        int fd = accept(listener, nullptr, nullptr);
+        close(listener);
+        ASSERT_GE(fd, 0);
+
+        m_socket = new TCPSocket(&m_events, &m_multiplexer,
+                            new ArchSocketImpl { fd, 1 });
+        m_events.adoptHandler(Event::kUnknown, m_socket->getEventTarget(),
+                            new TMethodEventJob<TCPSocketTests>(this,
+                                &TCPSocketTests::handleEvent));
+    }
+
+    void TearDown() override
+    {
+        m_events.removeHandler(Event::kUnknown, m_socket->getEventTarget());
+        delete m_socket;
+        close(m_peer);
+    }
+
+    // runs the event loop until the socket sends an event of type \c type
+    void waitForEvent(Event::Type type)
+    {
+        m_quitType = type;
+        m_events.initQuitTimeout(5);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+    }
+
+    // writes \c data from inside the event loop and waits for an event
+    // of type \c type.  events the socket thread sends before the loop
+    // starts can overtake ones sent from this thread.
+    void writeInLoop(const std::vector<UInt8>& data, Event::Type type)
+    {
+        m_loopWrite = &data;
+        m_events.addEvent(Event(m_events.registerTypeOnce(m_writeType, "write"),
+                            m_socket->getEventTarget()));
+        waitForEvent(type);
+    }
+
+    void handleEvent(const Event& event, void*)
+    {
+        if (event.getType() == m_writeType) {
+            m_socket->write(m_loopWrite->data(),
+                            static_cast<UInt32>(m_loopWrite->size()));
+            return;
+        }
+        m_types.push_back(event.getType());
+        if (event.getType() == m_quitType) {
+            m_events.raiseQuitEvent();
+        }
+    }
+
+    TestEventQueue m_events;
+    SocketMultiplexer m_multiplexer;
+    TCPSocket* m_socket = nullptr;
+    int m_peer = -1;
+    Event::Type m_quitType = Event::kUnknown;
+    Event::Type m_writeType = Event::kUnknown;
+    const std::vector<UInt8>* m_loopWrite = nullptr;
+    std::vector<Event::Type> m_types;
+};
+
+int s_writes = 0;
+
+ssize_t
+countingWritev(int fd, const struct iovec* iov, int count)
+{
+    ++s_writes;
+    return writev(fd, iov, count);
+}
+
+} // namespace
+
+TEST_F(TCPSocketTests, write_pastHighWater_congestsUntilDrained)
+{
+    m_socket->setOutputLimits(1024, 4096, 0);
+    std::vector<UInt8> data(8192);
+
+    writeInLoop(data, m_events.forIStream().outputDrained());
+
+    ASSERT_GE(m_types.size(), 2);
+    EXPECT_EQ(m_types[0], m_events.forIStream().outputCongested());
+    EXPECT_EQ(m_types[1], m_events.forIStream().outputDrained());
+    EXPECT_FALSE(m_socket->isCongested());
+}
+
+TEST_F(TCPSocketTests, write_pastHardLimit_outputError)
+{
+    m_socket->setOutputLimits(1024, 4096, 16384);
+    std::vector<UInt8> data(32768);
+
+    m_socket->write(data.data(), static_cast<UInt32>(data.size()));
+    waitForEvent(m_events.forIStream().outputError());
+
+    // nothing was sent to the consumer
+    char buffer[16];
+    EXPECT_EQ(recv(m_peer, buffer, sizeof(buffer), MSG_DONTWAIT), -1);
+}
+
+TEST_F(TCPSocketTests, write_pendingUntilFlushed)
+{
+    EXPECT_FALSE(m_socket->hasPendingOutput());
+
+    // the batch keeps the write from going out before it's checked
+    m_socket->beginBatch();
+    m_socket->write("DMMV\0\1\0\2", 8);
+    EXPECT_TRUE(m_socket->hasPendingOutput());
+    m_socket->endBatch();
+
+    waitForEvent(m_events.forIStream().outputFlushed());
+    EXPECT_FALSE(m_socket->hasPendingOutput());
+}
+
+TEST_F(TCPSocketTests, write_burstInEventBatch_sentTogether)
+{
+    s_writes = 0;
+    ArchNetworkBSD::s_connectors.writev_impl = countingWritev;
+
+    // like a handler sending several messages for one event
+    {
+        EventBatch batch;
+        for (int i = 0; i < 10; ++i) {
+            m_socket->write("DMMV\0\1\0\2", 8);
+        }
+        EXPECT_TRUE(m_socket->hasPendingOutput());
+    }
+    waitForEvent(m_events.forIStream().outputFlushed());
+    ArchNetworkBSD::s_connectors.writev_impl = writev;
+
+    EXPECT_EQ(s_writes, 1);
+    char buffer[128];
+    EXPECT_EQ(recv(m_peer, buffer, sizeof(buffer), 0), 80);
+}
+
+#endif // _WIN32
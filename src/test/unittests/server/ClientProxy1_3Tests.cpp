@@ -0,0 +1,57 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_3.h"
+#include "base/EventQueue.h"
+#include "test/mock/io/MockStream.h"
+#include "test/global/AllocationCounter.h"
+#include "test/global/gtest.h"
+
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+// a proxy that lets the test reset the heartbeat like a message does
+class HeartbeatClientProxy : public ClientProxy1_3 {
+public:
+    HeartbeatClientProxy(synergy::IStream* stream, IEventQueue* events) :
+        ClientProxy1_3("client", stream, events) { }
+
+    using ClientProxy1_3::addHeartbeatTimer;
+    using ClientProxy1_3::resetHeartbeatTimer;
+};
+
+} // namespace
+
+TEST(ClientProxy1_3Tests, resetHeartbeatTimer_perMessage_allocatesNothing)
+{
+    EventQueue events;
+    NiceMock<MockStream>* stream = new NiceMock<MockStream>;
+    ON_CALL(*stream, getEventTarget()).WillByDefault(Return(stream));
+    HeartbeatClientProxy proxy(stream, &events);
+
+    // the handshake starts the heartbeat and keep alive timers
+    proxy.addHeartbeatTimer();
+    proxy.resetHeartbeatTimer();
+
+    AllocationCounter allocations;
+    for (int i = 0; i < 1000; ++i) {
+        proxy.resetHeartbeatTimer();
+    }
+    EXPECT_EQ(allocations.getCount(), 0);
+}
@@ -0,0 +1,195 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server/ClientProxy1_9.h"
+#include "synergy/AppUtil.h"
+#include "synergy/option_types.h"
+#include "test/mock/io/MockStream.h"
+#include "test/mock/server/MockServer.h"
+#include "test/global/TestEventQueue.h"
+#include "test/global/gtest.h"
+
+#include <string>
+#include <vector>
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::InSequence;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+// the proxy asks the app for the local keyboard languages
+class TestAppUtil : public AppUtil {
+public:
+    int                 run(int, char**) override { return 0; }
+    void                startNode() override { }
+    std::vector<String> getKeyboardLayoutList() override { return {}; }
+    String              getCurrentLanguageCode() override { return ""; }
+    void                showNotification(const String&, const String&) const override { }
+};
+
+// a proxy whose stream keeps the code of each message written
+class ClientProxy1_9Tests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_stream = new NiceMock<MockStream>;
+        ON_CALL(*m_stream, getEventTarget()).WillByDefault(Return(m_stream));
+        ON_CALL(*m_stream, write(_, _)).WillByDefault(Invoke(
+            [this](const void* buffer, UInt32 n) {
+                m_codes.push_back(std::string(static_cast<const char*>(buffer),
+                                    std::min<UInt32>(n, 4)));
+            }));
+
+        // the proxy adopts the stream
+        m_proxy = new ClientProxy1_9("client", m_stream, &m_server, &m_events);
+    }
+
+    void TearDown() override
+    {
+        delete m_proxy;
+    }
+
+    void setOption(OptionID id, SInt32 value)
+    {
+        OptionsList options;
+        options.push_back(id);
+        options.push_back(static_cast<UInt32>(value));
+        m_proxy->setOptions(options);
+    }
+
+    // runs the event loop until the stream's batch ends
+    void runUntilBatchEnds()
+    {
+        m_events.initQuitTimeout(5);
+        m_events.loop();
+        m_events.cleanupQuitTimeout();
+    }
+
+    TestAppUtil m_appUtil;
+    TestEventQueue m_events;
+    MockServer m_server;
+    NiceMock<MockStream>* m_stream = NULL;
+    ClientProxy1_9* m_proxy = NULL;
+    std::vector<std::string> m_codes;
+};
+
+} // namespace
+
+TEST_F(ClientProxy1_9Tests, input_queuedTogether_sentInOneBatch)
+{
+    {
+        InSequence sequence;
+        EXPECT_CALL(*m_stream, beginBatch()).Times(1);
+        EXPECT_CALL(*m_stream, write(_, _)).Times(3);
+        EXPECT_CALL(*m_stream, endBatch()).WillOnce(Invoke(
+            [this] { m_events.raiseQuitEvent(); }));
+    }
+
+    m_proxy->mouseDown(kButtonLeft);
+    m_proxy->mouseMove(10, 20);
+    m_proxy->mouseUp(kButtonLeft);
+    runUntilBatchEnds();
+}
+
+TEST_F(ClientProxy1_9Tests, input_afterBatchEnds_opensNewBatch)
+{
+    EXPECT_CALL(*m_stream, beginBatch()).Times(2);
+    EXPECT_CALL(*m_stream, endBatch()).Times(2).WillRepeatedly(Invoke(
+        [this] { m_events.raiseQuitEvent(); }));
+
+    m_proxy->mouseDown(kButtonLeft);
+    runUntilBatchEnds();
+    m_proxy->mouseUp(kButtonLeft);
+    runUntilBatchEnds();
+}
+
+TEST_F(ClientProxy1_9Tests, input_negativeBatchWindow_notBatched)
+{
+    EXPECT_CALL(*m_stream, beginBatch()).Times(0);
+    EXPECT_CALL(*m_stream, endBatch()).Times(0);
+
+    setOption(kOptionInputBatchWindow, -1);
+    m_codes.clear();
+    m_proxy->mouseDown(kButtonLeft);
+    m_proxy->mouseUp(kButtonLeft);
+
+    EXPECT_EQ(m_codes.size(), 2U);
+}
+
+TEST_F(ClientProxy1_9Tests, mouseMove_smallDeltas_sentAsDeltas)
+{
+    setOption(kOptionInputBatchWindow, -1);
+    m_proxy->enter(100, 100, 1, 0, false);
+    m_codes.clear();
+
+    m_proxy->mouseMove(101, 99);
+    m_proxy->mouseMove(150, 40);
+
+    std::vector<std::string> expected = { "DMDT", "DMDT" };
+    EXPECT_EQ(m_codes, expected);
+}
+
+TEST_F(ClientProxy1_9Tests, mouseMove_deltasOfFourBytes_sentAbsolute)
+{
+    setOption(kOptionInputBatchWindow, -1);
+    m_proxy->enter(100, 100, 1, 0, false);
+    m_codes.clear();
+
+    // 2 bytes each
+    m_proxy->mouseMove(5100, 5100);
+    // 3 bytes and 1 byte
+    m_proxy->mouseMove(25100, 5100);
+    // 2 bytes and 1 byte
+    m_proxy->mouseMove(20100, 5100);
+
+    std::vector<std::string> expected = { "DMMV", "DMMV", "DMDT" };
+    EXPECT_EQ(m_codes, expected);
+}
+
+TEST_F(ClientProxy1_9Tests, mouseMove_absoluteMotionInterval_absoluteAfterDeltas)
+{
+    setOption(kOptionInputBatchWindow, -1);
+    setOption(kOptionAbsoluteMotionInterval, 2);
+    m_proxy->enter(100, 100, 1, 0, false);
+    m_codes.clear();
+
+    for (SInt32 i = 1; i <= 6; ++i) {
+        m_proxy->mouseMove(100 + i, 100);
+    }
+
+    std::vector<std::string> expected = {
+        "DMDT", "DMDT", "DMMV", "DMDT", "DMDT", "DMMV"
+    };
+    EXPECT_EQ(m_codes, expected);
+}
+
+TEST_F(ClientProxy1_9Tests, mouseMove_zeroAbsoluteMotionInterval_onlyAbsolute)
+{
+    setOption(kOptionInputBatchWindow, -1);
+    setOption(kOptionAbsoluteMotionInterval, 0);
+    m_proxy->enter(100, 100, 1, 0, false);
+    m_codes.clear();
+
+    m_proxy->mouseMove(101, 100);
+    m_proxy->mouseMove(102, 100);
+
+    std::vector<std::string> expected = { "DMMV", "DMMV" };
+    EXPECT_EQ(m_codes, expected);
+}
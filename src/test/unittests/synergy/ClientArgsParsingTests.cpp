@@ -100,6 +100,20 @@ TEST(ClientArgsParsingTests, parseClientArgs_setCommonArgs)
     EXPECT_TRUE(clientArgs.m_preventSleep);
 }
 
+TEST(ClientArgsParsingTests, parseClientArgs_enableKernelTls)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(client_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(client_stubCheckUnexpectedArgs));
+    lib::synergy::ClientArgs clientArgs;
+    const int argc = 2;
+    const char* kKernelTlsCmd[argc] = { "stub", "--enable-ktls" };
+
+    argParser.parseClientArgs(clientArgs, argc, kKernelTlsCmd);
+
+    EXPECT_TRUE(clientArgs.m_enableKernelTls);
+}
+
 TEST(ClientArgsParsingTests, parseClientArgs_addressArg_setSynergyAddress)
 {
     NiceMock<MockArgParser> argParser;
@@ -0,0 +1,81 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/MessageTable.h"
+#include "synergy/protocol_types.h"
+#include "test/global/gtest.h"
+
+namespace {
+
+const UInt8*
+code(const char* message)
+{
+    return reinterpret_cast<const UInt8*>(message);
+}
+
+} // namespace
+
+TEST(MessageTableTests, find_added_returnsHandler)
+{
+    MessageTable<int> table;
+    table.add(kMsgDMouseMove, 1);
+    table.add(kMsgDMouseRelMove, 2);
+
+    ASSERT_NE(table.find(code(kMsgDMouseMove)), nullptr);
+    EXPECT_EQ(*table.find(code(kMsgDMouseMove)), 1);
+    EXPECT_EQ(*table.find(code(kMsgDMouseRelMove)), 2);
+}
+
+TEST(MessageTableTests, find_notAdded_returnsNull)
+{
+    MessageTable<int> table;
+    EXPECT_EQ(table.find(code(kMsgDMouseMove)), nullptr);
+
+    table.add(kMsgDMouseMove, 1);
+    EXPECT_EQ(table.find(code(kMsgDMouseUp)), nullptr);
+    EXPECT_EQ(table.find(code("XXXX")), nullptr);
+}
+
+TEST(MessageTableTests, add_sameCode_replacesHandler)
+{
+    MessageTable<int> table;
+    table.add(kMsgCKeepAlive, 1);
+    table.add(kMsgCKeepAlive, 2);
+
+    EXPECT_EQ(table.size(), 1U);
+    EXPECT_EQ(*table.find(code(kMsgCKeepAlive)), 2);
+}
+
+TEST(MessageTableTests, add_manyCodes_findsAll)
+{
+    // more than fit in the initial table
+    MessageTable<int> table;
+    char message[5] = "Dxxx";
+    for (int i = 0; i < 200; ++i) {
+        message[1] = static_cast<char>('A' + i % 26);
+        message[2] = static_cast<char>('a' + i / 26);
+        table.add(message, i);
+    }
+
+    EXPECT_EQ(table.size(), 200U);
+    for (int i = 0; i < 200; ++i) {
+        message[1] = static_cast<char>('A' + i % 26);
+        message[2] = static_cast<char>('a' + i / 26);
+        ASSERT_NE(table.find(code(message)), nullptr);
+        EXPECT_EQ(*table.find(code(message)), i);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/PacketStreamFilter.h"
+#include "test/mock/io/MockStream.h"
+#include "test/global/TestEventQueue.h"
+
+#include "test/global/gtest.h"
+
+#include <string>
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+
+namespace {
+
+std::string
+joinBuffers(const void* const* buffers, const UInt32* sizes, int count)
+{
+    std::string result;
+    for (int i = 0; i < count; ++i) {
+        result.append(static_cast<const char*>(buffers[i]), sizes[i]);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(PacketStreamFilterTests, write_sendsHeaderAndPayloadInOneCall)
+{
+    TestEventQueue events;
+    NiceMock<MockStream> stream;
+    PacketStreamFilter filter(&events, &stream, false);
+    std::string written;
+
+    EXPECT_CALL(stream, write(_, _)).Times(0);
+    EXPECT_CALL(stream, writeVector(_, _, _)).WillOnce(Invoke(
+        [&written](const void* const* buffers, const UInt32* sizes, int count) {
+            written = joinBuffers(buffers, sizes, count);
+        }));
+
+    filter.write("CNOP", 4);
+
+    EXPECT_EQ(std::string("\0\0\0\4CNOP", 8), written);
+}
+
+TEST(PacketStreamFilterTests, writeVector_framesBuffersAsOnePacket)
+{
+    TestEventQueue events;
+    NiceMock<MockStream> stream;
+    PacketStreamFilter filter(&events, &stream, false);
+    std::string written;
+
+    EXPECT_CALL(stream, writeVector(_, _, _)).WillOnce(Invoke(
+        [&written](const void* const* buffers, const UInt32* sizes, int count) {
+            written = joinBuffers(buffers, sizes, count);
+        }));
+
+    const void* buffers[] = { "DMMV", "\1\2\3\4" };
+    UInt32 sizes[] = { 4, 4 };
+    filter.writeVector(buffers, sizes, 2);
+
+    EXPECT_EQ(std::string("\0\0\0\x08" "DMMV\1\2\3\4", 12), written);
+}
+
+TEST(PacketStreamFilterTests, endBatch_sendsWritesAsOnePacket)
+{
+    TestEventQueue events;
+    NiceMock<MockStream> stream;
+    PacketStreamFilter filter(&events, &stream, false);
+    std::string written;
+
+    EXPECT_CALL(stream, writeVector(_, _, _)).WillOnce(Invoke(
+        [&written](const void* const* buffers, const UInt32* sizes, int count) {
+            written = joinBuffers(buffers, sizes, count);
+        }));
+
+    filter.beginBatch();
+    filter.beginBatch();
+    filter.write("DMMV\1\2\3\4", 8);
+    filter.endBatch();
+    filter.write("DMDN\1", 5);
+    EXPECT_TRUE(written.empty());
+    filter.endBatch();
+
+    EXPECT_EQ(std::string("\0\0\0\x0d" "DMMV\1\2\3\4" "DMDN\1", 17), written);
+}
+
+TEST(PacketStreamFilterTests, flush_inBatch_sendsWrites)
+{
+    TestEventQueue events;
+    NiceMock<MockStream> stream;
+    PacketStreamFilter filter(&events, &stream, false);
+    std::string written;
+
+    EXPECT_CALL(stream, writeVector(_, _, _)).WillOnce(Invoke(
+        [&written](const void* const* buffers, const UInt32* sizes, int count) {
+            written = joinBuffers(buffers, sizes, count);
+        }));
+    EXPECT_CALL(stream, flush());
+
+    filter.beginBatch();
+    filter.write("CBYE", 4);
+    filter.flush();
+
+    EXPECT_EQ(std::string("\0\0\0\4CBYE", 8), written);
+    filter.endBatch();
+}
+
+TEST(PacketStreamFilterTests, hasPendingOutput_batchNotSent_true)
+{
+    TestEventQueue events;
+    NiceMock<MockStream> stream;
+    PacketStreamFilter filter(&events, &stream, false);
+
+    filter.beginBatch();
+    EXPECT_FALSE(filter.hasPendingOutput());
+
+    filter.write("DMMV\1\2\3\4", 8);
+    EXPECT_TRUE(filter.hasPendingOutput());
+
+    filter.endBatch();
+    EXPECT_FALSE(filter.hasPendingOutput());
+}
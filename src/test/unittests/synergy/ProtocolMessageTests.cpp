@@ -0,0 +1,240 @@
+/*
+ * synergy -- mouse and keyboard sharing utility
+ * Copyright (C) 2014-2020 Symless Ltd.
+ *
+ * This package is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * found in the file LICENSE that should have accompanied this file.
+ *
+ * This package is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "synergy/ProtocolUtil.h"
+#include "synergy/ProtocolMessage.h"
+#include "synergy/protocol_types.h"
+#include "test/mock/io/MockStream.h"
+#include "test/global/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+
+namespace protocol = synergy::protocol;
+
+namespace {
+
+// a stream that keeps what's written and reads it back
+class ProtocolMessageTests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        ON_CALL(m_stream, write(_, _)).WillByDefault(Invoke(
+            [this](const void* buffer, UInt32 n) {
+                auto bytes = static_cast<const UInt8*>(buffer);
+                m_written.push_back(std::vector<UInt8>(bytes, bytes + n));
+            }));
+        ON_CALL(m_stream, read(_, _)).WillByDefault(Invoke(
+            [this](void* buffer, UInt32 n) {
+                ++m_reads;
+                n = std::min(n, static_cast<UInt32>(m_input.size() - m_readOffset));
+                std::memcpy(buffer, m_input.data() + m_readOffset, n);
+                m_readOffset += n;
+                return n;
+            }));
+    }
+
+    // returns the bytes of the last write and forgets the writes
+    std::vector<UInt8> takeWritten()
+    {
+        std::vector<UInt8> result;
+        if (!m_written.empty()) {
+            result = m_written.back();
+        }
+        m_written.clear();
+        return result;
+    }
+
+    // makes the stream read \c bytes, skipping the message code
+    void setInput(const std::vector<UInt8>& bytes, size_t codeSize = 4)
+    {
+        m_input.assign(bytes.begin() + codeSize, bytes.end());
+        m_readOffset = 0;
+        m_reads      = 0;
+    }
+
+    NiceMock<MockStream> m_stream;
+    std::vector<std::vector<UInt8>> m_written;
+    std::vector<UInt8> m_input;
+    size_t m_readOffset = 0;
+    int m_reads = 0;
+};
+
+} // namespace
+
+TEST_F(ProtocolMessageTests, writeMessage_fixedSize_sameAsWritef)
+{
+    ProtocolUtil::writef(&m_stream, kMsgCEnter, -2, 300, 0x01020304, 0x8001);
+    auto expected = takeWritten();
+
+    ProtocolUtil::writeMessage(&m_stream, protocol::CEnter(-2, 300, 0x01020304, 0x8001));
+
+    EXPECT_EQ(m_written.size(), 1U);
+    EXPECT_EQ(takeWritten(), expected);
+
+    ProtocolUtil::writef(&m_stream, kMsgDMouseMove, -1, 1080);
+    expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::DMouseMove(-1, 1080));
+    EXPECT_EQ(takeWritten(), expected);
+
+    ProtocolUtil::writef(&m_stream, kMsgHello, 1, 8);
+    expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::Hello(1, 8));
+    EXPECT_EQ(takeWritten(), expected);
+
+    ProtocolUtil::writef(&m_stream, kMsgCKeepAlive);
+    expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::CKeepAlive());
+    EXPECT_EQ(takeWritten(), expected);
+}
+
+TEST_F(ProtocolMessageTests, writeMessage_variableSize_sameAsWritef)
+{
+    String lang = "en";
+    ProtocolUtil::writef(&m_stream, kMsgDKeyRepeat, 0x61, 0x2, 3, 38, &lang);
+    auto expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::DKeyRepeat(0x61, 0x2, 3, 38, lang));
+    EXPECT_EQ(takeWritten(), expected);
+
+    std::vector<UInt32> options = { 1, 0xfffffffe, 3 };
+    ProtocolUtil::writef(&m_stream, kMsgDSetOptions, &options);
+    expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::DSetOptions(options));
+    EXPECT_EQ(takeWritten(), expected);
+
+    // bigger than the stack buffer
+    String data(1000, 'x');
+    ProtocolUtil::writef(&m_stream, kMsgDClipboard, 1, 7, 2, &data);
+    expected = takeWritten();
+    ProtocolUtil::writeMessage(&m_stream, protocol::DClipboard(1, 7, 2, data));
+    EXPECT_EQ(takeWritten(), expected);
+}
+
+TEST_F(ProtocolMessageTests, readMessage_fixedSize_readsOnce)
+{
+    ProtocolUtil::writef(&m_stream, kMsgCEnter, -2, 300, 0x01020304, 0x8001);
+    setInput(takeWritten());
+
+    protocol::CEnter message;
+    EXPECT_TRUE(ProtocolUtil::readMessage(&m_stream, message));
+
+    EXPECT_EQ(m_reads, 1);
+    EXPECT_EQ(message.m_x, -2);
+    EXPECT_EQ(message.m_y, 300);
+    EXPECT_EQ(message.m_seqNum, 0x01020304U);
+    EXPECT_EQ(message.m_mask, 0x8001);
+}
+
+TEST_F(ProtocolMessageTests, readMessage_variableSize_readsFields)
+{
+    String lang = "fr";
+    ProtocolUtil::writef(&m_stream, kMsgDKeyDownLang, 0x61, 0x2, 38, &lang);
+    setInput(takeWritten());
+
+    protocol::DKeyDownLang message;
+    EXPECT_TRUE(ProtocolUtil::readMessage(&m_stream, message));
+
+    EXPECT_EQ(message.m_id, 0x61);
+    EXPECT_EQ(message.m_mask, 0x2);
+    EXPECT_EQ(message.m_button, 38);
+    EXPECT_EQ(message.m_lang, "fr");
+
+    std::vector<UInt32> options = { 1, 0xfffffffe, 3 };
+    ProtocolUtil::writef(&m_stream, kMsgDSetOptions, &options);
+    setInput(takeWritten());
+
+    protocol::DSetOptions setOptions;
+    EXPECT_TRUE(ProtocolUtil::readMessage(&m_stream, setOptions));
+    EXPECT_EQ(setOptions.m_options, options);
+}
+
+TEST_F(ProtocolMessageTests, readMessage_truncated_fails)
+{
+    ProtocolUtil::writef(&m_stream, kMsgDMouseMove, 10, 20);
+    auto bytes = takeWritten();
+    bytes.pop_back();
+    setInput(bytes);
+
+    protocol::DMouseMove message;
+    EXPECT_FALSE(ProtocolUtil::readMessage(&m_stream, message));
+}
+
+TEST_F(ProtocolMessageTests, readWriteMessage_values_roundTrip)
+{
+    SInt32 x = -5;
+    SInt32 y = 768;
+    ProtocolUtil::writef(&m_stream, kMsgDMouseMove, x, y);
+    auto expected = takeWritten();
+    ProtocolUtil::writeMessage<protocol::DMouseMove>(&m_stream, x, y);
+    auto written = takeWritten();
+    EXPECT_EQ(written, expected);
+
+    setInput(written);
+    SInt32 readX = 0;
+    SInt32 readY = 0;
+    EXPECT_TRUE(ProtocolUtil::readMessage<protocol::DMouseMove>(&m_stream, readX, readY));
+    EXPECT_EQ(readX, x);
+    EXPECT_EQ(readY, y);
+}
+
+TEST_F(ProtocolMessageTests, writeMessage_mouseDelta_zigZagVarints)
+{
+    // a one pixel move takes a byte per axis
+    ProtocolUtil::writeMessage<protocol::DMouseDelta>(&m_stream, -1, 1);
+    std::vector<UInt8> expected = { 'D', 'M', 'D', 'T', 0x01, 0x02 };
+    EXPECT_EQ(takeWritten(), expected);
+
+    ProtocolUtil::writeMessage<protocol::DMouseDelta>(&m_stream, 64, -65);
+    expected = { 'D', 'M', 'D', 'T', 0x80, 0x01, 0x81, 0x01 };
+    EXPECT_EQ(takeWritten(), expected);
+}
+
+TEST_F(ProtocolMessageTests, readWriteMessage_mouseDelta_roundTrip)
+{
+    // pair each value with one from the other end rather than negating
+    // it, since the minimum can't be negated
+    const SInt32 values[] = { 0, -1, 63, -64, 64, 8191, -8192, 40000, -2147483647 - 1, 2147483647 };
+    const size_t count = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < count; ++i) {
+        const SInt32 dx = values[i];
+        const SInt32 dy = values[count - 1 - i];
+        ProtocolUtil::writeMessage<protocol::DMouseDelta>(&m_stream, dx, dy);
+        auto written = takeWritten();
+        EXPECT_EQ(written.size(), 4 + protocol::Varint::size(dx) + protocol::Varint::size(dy));
+
+        setInput(written);
+        protocol::DMouseDelta message;
+        EXPECT_TRUE(ProtocolUtil::readMessage(&m_stream, message));
+        EXPECT_EQ(message.m_dx, dx);
+        EXPECT_EQ(message.m_dy, dy);
+    }
+}
+
+TEST_F(ProtocolMessageTests, readMessage_overlongVarint_fails)
+{
+    // the continuation bit is still set after the most bytes a value
+    // can take
+    setInput({ 'D', 'M', 'D', 'T', 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00 });
+
+    protocol::DMouseDelta message;
+    EXPECT_FALSE(ProtocolUtil::readMessage(&m_stream, message));
+    EXPECT_EQ(m_readOffset, static_cast<size_t>(protocol::Varint::kMaxSize));
+}
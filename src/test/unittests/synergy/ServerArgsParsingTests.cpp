@@ -89,6 +89,32 @@ TEST(ServerArgsParsingTests, parseServerArgs_checkSerialKeyParams)
     EXPECT_EQ(serial, serverArgs.m_serial.toString());
 }
 
+TEST(ServerArgsParsingTests, parseServerArgs_netThreadsArg_setNetThreads)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+    lib::synergy::ServerArgs serverArgs;
+    const int argc = 3;
+    std::array<const char*, argc> kNetThreadsCmd = { "stub", "--net-threads", "4" };
+
+    EXPECT_TRUE(argParser.parseServerArgs(serverArgs, argc, kNetThreadsCmd.data()));
+    EXPECT_EQ(4, serverArgs.m_netThreads);
+}
+
+TEST(ServerArgsParsingTests, parseServerArgs_listenBacklogArg_setListenBacklog)
+{
+    NiceMock<MockArgParser> argParser;
+    ON_CALL(argParser, parseGenericArgs(_, _, _)).WillByDefault(Invoke(server_stubParseGenericArgs));
+    ON_CALL(argParser, checkUnexpectedArgs()).WillByDefault(Invoke(server_stubCheckUnexpectedArgs));
+    lib::synergy::ServerArgs serverArgs;
+    const int argc = 3;
+    std::array<const char*, argc> kListenBacklogCmd = { "stub", "--listen-backlog", "256" };
+
+    EXPECT_TRUE(argParser.parseServerArgs(serverArgs, argc, kListenBacklogCmd.data()));
+    EXPECT_EQ(256, serverArgs.m_listenBacklog);
+}
+
 TEST(ServerArgsParsingTests, parseServerArgs_checkUnexpectedParams)
 {
     NiceMock<MockArgParser> argParser;